@@ -19,6 +19,22 @@ LOCAL_SRC_FILES := \
 	$(SRC_PATH)/Property.cpp \
 	$(SRC_PATH)/TileLayer.cpp \
 	$(SRC_PATH)/Tileset.cpp \
+	$(SRC_PATH)/MapWriter.cpp \
+	$(SRC_PATH)/JsonMap.cpp \
+	$(SRC_PATH)/MapInfo.cpp \
+	$(SRC_PATH)/ZipArchiveProvider.cpp \
+	$(SRC_PATH)/AssetProvider.cpp \
+	$(SRC_PATH)/IncrementalLoader.cpp \
+	$(SRC_PATH)/AsyncLoad.cpp \
+	$(SRC_PATH)/TemplateCache.cpp \
+	$(SRC_PATH)/TilesetCache.cpp \
+	$(SRC_PATH)/BinaryMap.cpp \
+	$(SRC_PATH)/MapReader.cpp \
+	$(SRC_PATH)/Executor.cpp \
+	$(SRC_PATH)/ThreadPool.cpp \
+	$(SRC_PATH)/CSV.cpp \
+	$(SRC_PATH)/Base64.cpp \
+	$(SRC_PATH)/MappedFile.cpp \
 	$(SRC_PATH)/detail/pugixml.cpp \
 
 LOCAL_LDLIBS :=
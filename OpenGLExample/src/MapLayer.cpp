@@ -115,11 +115,11 @@ void MapLayer::createSubsets(const tmx::Map& map, std::size_t layerIdx)
             for(auto x = 0u; x < mapSize.x; ++x)
             {
                 auto idx = y * mapSize.x + x;
-                if(idx < tileIDs.size() && tileIDs[idx].ID >= ts.getFirstGID()
-                    && tileIDs[idx].ID < (ts.getFirstGID() + ts.getTileCount()))
+                if(idx < tileIDs.size() && tileIDs[idx].getID() >= ts.getFirstGID()
+                    && tileIDs[idx].getID() < (ts.getFirstGID() + ts.getTileCount()))
                 {
-                    pixelData.push_back(static_cast<std::uint16_t>((tileIDs[idx].ID - ts.getFirstGID()) + 1)); //red channel - making sure to index relative to the tileset
-                    pixelData.push_back(static_cast<std::uint16_t>(tileIDs[idx].flipFlags)); //green channel - tile flips are performed on the shader
+                    pixelData.push_back(static_cast<std::uint16_t>((tileIDs[idx].getID() - ts.getFirstGID()) + 1)); //red channel - making sure to index relative to the tileset
+                    pixelData.push_back(static_cast<std::uint16_t>(tileIDs[idx].getFlipFlags())); //green channel - tile flips are performed on the shader
                     tsUsed = true;
                 }
                 else
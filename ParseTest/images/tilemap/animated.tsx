@@ -0,0 +1,10 @@
+<?xml version="1.0" encoding="UTF-8"?>
+<tileset version="1.10" tiledversion="1.10.2" name="animated" tilewidth="32" tileheight="32" tilecount="24" columns="6">
+ <image source="tileset02.png" width="192" height="128"/>
+ <tile id="0">
+  <animation>
+   <frame tileid="1" duration="100"/>
+   <frame tileid="2" duration="200"/>
+  </animation>
+ </tile>
+</tileset>
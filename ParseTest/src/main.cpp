@@ -25,16 +25,38 @@ and must not be misrepresented as being the original software.
 source distribution.
 *********************************************************************/
 
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/BinaryMap.hpp>
 #include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/IncrementalLoader.hpp>
+#include <tmxlite/JsonMap.hpp>
 #include <tmxlite/Map.hpp>
+#include <tmxlite/MapInfo.hpp>
+#include <tmxlite/MapReader.hpp>
+#include <tmxlite/MappedFile.hpp>
+#include <tmxlite/ThreadPool.hpp>
 #include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/ObjectTypes.hpp>
 #include <tmxlite/LayerGroup.hpp>
 #include <tmxlite/TileLayer.hpp>
+#include <tmxlite/TemplateCache.hpp>
 #include <tmxlite/Tileset.hpp>
+#include <tmxlite/TilesetCache.hpp>
+#include <tmxlite/ZipArchiveProvider.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <array>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <type_traits>
 
 namespace
 {
@@ -223,6 +245,1227 @@ struct RevertWindowsPathHandling
     }
 };
 
+//compares the tile layers of two maps, including those in groups and chunks
+bool sameTileData(const std::vector<tmx::Layer::Ptr>& a, const std::vector<tmx::Layer::Ptr>& b)
+{
+    const auto sameTiles = [](const std::vector<tmx::TileLayer::Tile>& x, const std::vector<tmx::TileLayer::Tile>& y)
+    {
+        return std::equal(x.begin(), x.end(), y.begin(), y.end(),
+            [](const tmx::TileLayer::Tile& t, const tmx::TileLayer::Tile& u) { return t.getID() == u.getID() && t.getFlipFlags() == u.getFlipFlags(); });
+    };
+
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+
+    for (auto i = 0u; i < a.size(); ++i)
+    {
+        if (a[i]->getType() != b[i]->getType()
+            || a[i]->getName() != b[i]->getName())
+        {
+            return false;
+        }
+
+        if (a[i]->getType() == tmx::Layer::Type::Group)
+        {
+            if (!sameTileData(a[i]->getLayerAs<tmx::LayerGroup>().getLayers(), b[i]->getLayerAs<tmx::LayerGroup>().getLayers()))
+            {
+                return false;
+            }
+        }
+        else if (a[i]->getType() == tmx::Layer::Type::Tile)
+        {
+            const auto& layerA = a[i]->getLayerAs<tmx::TileLayer>();
+            const auto& layerB = b[i]->getLayerAs<tmx::TileLayer>();
+            if (!sameTiles(layerA.getTiles(), layerB.getTiles())
+                || layerA.getChunks().size() != layerB.getChunks().size())
+            {
+                return false;
+            }
+
+            for (auto j = 0u; j < layerA.getChunks().size(); ++j)
+            {
+                const auto& chunkA = layerA.getChunks()[j];
+                const auto& chunkB = layerB.getChunks()[j];
+                if (chunkA.position.x != chunkB.position.x || chunkA.position.y != chunkB.position.y
+                    || chunkA.size.x != chunkB.size.x || chunkA.size.y != chunkB.size.y
+                    || !sameTiles(chunkA.tiles, chunkB.tiles))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void testMappedFile()
+{
+    tmx::MappedFile file;
+    CHECK_EQ(file.open("maps/missing.tmx"), false);
+    CHECK_EQ(file.isOpen(), false);
+    CHECK_EQ(file.open("maps"), false);
+
+    //empty files can't be mapped
+    std::ofstream("empty.tmx").close();
+    CHECK_EQ(file.open("empty.tmx"), false);
+    CHECK_EQ(file.data() == nullptr, true);
+    tmx::Map emptyMap;
+    CHECK_EQ(emptyMap.load("empty.tmx"), false);
+    std::remove("empty.tmx");
+
+    std::string contents;
+    CHECK_EQ(tmx::readFileIntoString("maps/platform.tmx", &contents), true);
+    CHECK_EQ(file.open("maps/platform.tmx"), true);
+    CHECK_EQ(file.size(), contents.size());
+    CHECK_EQ(std::equal(contents.begin(), contents.end(), file.data()), true);
+
+    //the mapping is copy on write, so changes never reach the file
+    file.data()[0] = '#';
+    tmx::MappedFile movedFile(std::move(file));
+    CHECK_EQ(file.isOpen(), false);
+    CHECK_EQ(movedFile.data()[0], '#');
+    movedFile.close();
+    CHECK_EQ(movedFile.isOpen(), false);
+    CHECK_EQ(movedFile.open("maps/platform.tmx"), true);
+    CHECK_EQ(movedFile.data()[0], contents[0]);
+
+    //maps loaded from a mapped file match those parsed from a string
+    tmx::Map mappedMap;
+    CHECK_EQ(mappedMap.load("maps/platform.tmx"), true);
+    tmx::Map stringMap;
+    CHECK_EQ(stringMap.loadFromString(contents, "maps"), true);
+    CHECK_EQ(sameTileData(mappedMap.getLayers(), stringMap.getLayers()), true);
+    CHECK_EQ(mappedMap.getTilesets().size(), stringMap.getTilesets().size());
+    CHECK_EQ(mappedMap.getTilesets()[0].getImagePath(), stringMap.getTilesets()[0].getImagePath());
+    CHECK_EQ(mappedMap.getProperties().size(), stringMap.getProperties().size());
+}
+
+void testBufferLoad()
+{
+    tmx::Map fileMap;
+    CHECK_EQ(fileMap.load("maps/platform.tmx"), true);
+
+    std::string contents;
+    CHECK_EQ(tmx::readFileIntoString("maps/platform.tmx", &contents), true);
+
+    //buffers are parsed in place, and need not be null terminated
+    std::vector<char> buffer(contents.begin(), contents.end());
+    tmx::Map bufferMap;
+    CHECK_EQ(bufferMap.loadFromBuffer(buffer.data(), buffer.size(), "maps"), true);
+    CHECK_EQ(sameTileData(bufferMap.getLayers(), fileMap.getLayers()), true);
+    CHECK_EQ(bufferMap.getTilesets().size(), fileMap.getTilesets().size());
+    CHECK_EQ(bufferMap.getProperties().size(), fileMap.getProperties().size());
+
+    //the external tile set is found relative to the working directory
+    CHECK_EQ(bufferMap.getTilesets()[0].getName(), fileMap.getTilesets()[0].getName());
+    CHECK_EQ(bufferMap.getTilesets()[0].getImagePath(), fileMap.getTilesets()[0].getImagePath());
+    CHECK_EQ(bufferMap.getTilesets()[0].getTiles().size(), fileMap.getTilesets()[0].getTiles().size());
+    CHECK_EQ(bufferMap.getTilesets()[1].getImagePath(), fileMap.getTilesets()[1].getImagePath());
+
+    tmx::Map movedStringMap;
+    CHECK_EQ(movedStringMap.loadFromString(std::string(contents), "maps"), true);
+    CHECK_EQ(sameTileData(movedStringMap.getLayers(), fileMap.getLayers()), true);
+    CHECK_EQ(movedStringMap.getTilesets()[0].getImagePath(), fileMap.getTilesets()[0].getImagePath());
+
+    std::vector<char> brokenBuffer(contents.begin(), contents.begin() + contents.size() / 2);
+    tmx::Map brokenMap;
+    CHECK_EQ(brokenMap.loadFromBuffer(brokenBuffer.data(), brokenBuffer.size(), "maps"), false);
+
+    std::string tilesetContents;
+    CHECK_EQ(tmx::readFileIntoString("images/tilemap/platform.tsx", &tilesetContents), true);
+    tmx::Tileset tileset("images/tilemap");
+    CHECK_EQ(tileset.loadWithoutMapFromString(std::move(tilesetContents)), true);
+    CHECK_EQ(tileset.getName(), fileMap.getTilesets()[0].getName());
+    CHECK_EQ(tileset.getImagePath(), fileMap.getTilesets()[0].getImagePath());
+
+    std::string types = R"(<?xml version="1.0" encoding="UTF-8"?>
+<objecttypes>
+ <objecttype name="Enemy" color="#ff0000">
+  <property name="health" type="int" default="10"/>
+ </objecttype>
+</objecttypes>)";
+    std::vector<char> typesBuffer(types.begin(), types.end());
+    tmx::ObjectTypes bufferTypes;
+    CHECK_EQ(bufferTypes.loadFromBuffer(typesBuffer.data(), typesBuffer.size(), "maps"), true);
+    tmx::ObjectTypes stringTypes;
+    CHECK_EQ(stringTypes.loadFromString(std::move(types), "maps"), true);
+    CHECK_EQ(bufferTypes.getTypes().size(), 1u);
+    CHECK_EQ(stringTypes.getTypes().size(), 1u);
+    CHECK_EQ(bufferTypes.getTypes()[0].name, "Enemy");
+    CHECK_EQ(bufferTypes.getTypes()[0].properties.size(), 1u);
+    CHECK_EQ(bufferTypes.getTypes()[0].properties[0].getIntValue(), stringTypes.getTypes()[0].properties[0].getIntValue());
+}
+
+void testParallelLoad()
+{
+    tmx::Map serialMap;
+    CHECK_EQ(serialMap.load("maps/platform.tmx"), true);
+
+    //executors may be shared between maps
+    tmx::ThreadPool threadPool(4);
+    tmx::Map parallelMap;
+    parallelMap.setExecutor(&threadPool);
+    CHECK_EQ(parallelMap.load("maps/platform.tmx"), true);
+
+    tmx::Map ownPoolMap;
+    ownPoolMap.setThreadCount(4);
+    CHECK_EQ(ownPoolMap.getThreadCount(), 4u);
+    ownPoolMap.setExecutor(&threadPool);
+    CHECK_EQ(ownPoolMap.getThreadCount(), 1u);
+
+    //layers and tilesets should be in document order regardless of when they finished loading
+    CHECK_EQ(parallelMap.getTilesets().size(), serialMap.getTilesets().size());
+    CHECK_EQ(parallelMap.getLayers().size(), serialMap.getLayers().size());
+    for (auto i = 0u; i < std::min(parallelMap.getLayers().size(), serialMap.getLayers().size()); ++i)
+    {
+        const auto& layer = parallelMap.getLayers()[i];
+        CHECK_EQ(layer->getName(), serialMap.getLayers()[i]->getName());
+
+        if (layer->getType() == tmx::Layer::Type::Tile)
+        {
+            CHECK_EQ(layer->getLayerAs<tmx::TileLayer>().getTiles().size(), serialMap.getLayers()[i]->getLayerAs<tmx::TileLayer>().getTiles().size());
+        }
+    }
+
+    //infinite maps with enough chunks are decoded in batches on the executor
+    const std::vector<std::string> payloads =
+    {
+        "eJxjZGBgYBzFo3gUj0gMAAYeAQE=", "eJxjYmBgYBrFo3gUj0gMAAg8AgE=",
+        "eJxjZmBgYB7Fo3gUj0gMAApaAwE=", "eJxjYWBgYBnFo3gUj0gMAAx4BAE=",
+        "eJxjZWBgYB3Fo3gUj0gMAA6WBQE="
+    };
+    std::string base64Layer;
+    std::string csvLayer;
+    for (auto i = 0; i < 300; ++i)
+    {
+        const auto position = "x=\"" + std::to_string((i % 20) * 16 - 160) + "\" y=\"" + std::to_string((i / 20) * 16 - 64) + "\"";
+        base64Layer += "<chunk " + position + " width=\"16\" height=\"16\">" + payloads[i % payloads.size()] + "</chunk>";
+
+        csvLayer += "<chunk " + position + " width=\"16\" height=\"16\">";
+        for (auto j = 0; j < 256; ++j)
+        {
+            csvLayer += std::to_string((i + j) % 25) + (j == 255 ? "" : ",");
+        }
+        csvLayer += "</chunk>";
+    }
+    const std::string document = R"(<map version="1.10" orientation="orthogonal" renderorder="right-down" width="32" height="32" tilewidth="32" tileheight="32" infinite="1">
+ <tileset firstgid="1" name="tileset02" tilewidth="32" tileheight="32" tilecount="24" columns="6">
+  <image source="../images/tilemap/tileset02.png" width="192" height="128"/>
+ </tileset>
+ <layer id="1" name="Ground" width="32" height="32"><data encoding="base64" compression="zlib">)" + base64Layer + R"(</data></layer>
+ <layer id="2" name="Detail" width="32" height="32"><data encoding="csv">)" + csvLayer + R"(</data></layer>
+</map>)";
+
+    tmx::Map serialInfiniteMap;
+    CHECK_EQ(serialInfiniteMap.loadFromString(document, "maps"), true);
+    tmx::Map parallelInfiniteMap;
+    parallelInfiniteMap.setExecutor(&threadPool);
+    CHECK_EQ(parallelInfiniteMap.loadFromString(document, "maps"), true);
+
+    CHECK_EQ(parallelInfiniteMap.getLayers().size(), 2u);
+    for (const auto& layer : parallelInfiniteMap.getLayers())
+    {
+        const auto& chunks = layer->getLayerAs<tmx::TileLayer>().getChunks();
+        CHECK_EQ(chunks.size(), 300u);
+        CHECK_EQ(chunks.back().position.x, 144);
+        CHECK_EQ(chunks.back().position.y, 160);
+    }
+    CHECK_EQ(sameTileData(parallelInfiniteMap.getLayers(), serialInfiniteMap.getLayers()), true);
+
+    tmx::Map serialFileMap;
+    CHECK_EQ(serialFileMap.load("maps/infinite.tmx"), true);
+    tmx::Map parallelFileMap;
+    parallelFileMap.setExecutor(&threadPool);
+    CHECK_EQ(parallelFileMap.load("maps/infinite.tmx"), true);
+    CHECK_EQ(sameTileData(parallelFileMap.getLayers(), serialFileMap.getLayers()), true);
+}
+
+void testLazyDecoding()
+{
+    tmx::Map eagerMap;
+    CHECK_EQ(eagerMap.load("maps/platform.tmx"), true);
+
+    tmx::Map lazyMap;
+    lazyMap.setLazyDecoding(true);
+    CHECK_EQ(lazyMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(lazyMap.getLayers().size(), eagerMap.getLayers().size());
+    CHECK_EQ(lazyMap.getLayers()[0]->getType() == tmx::Layer::Type::Group, true);
+
+    const auto& eagerLayers = eagerMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers();
+    const auto& lazyLayers = lazyMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers();
+    CHECK_EQ(lazyLayers.size(), eagerLayers.size());
+    CHECK_EQ(lazyLayers[0]->getLayerAs<tmx::TileLayer>().isDecoded(), false);
+
+    //the first access decodes a single layer, decodeAll() takes care of the rest
+    const auto& tiles = lazyLayers[0]->getLayerAs<tmx::TileLayer>().getTiles();
+    CHECK_EQ(lazyLayers[0]->getLayerAs<tmx::TileLayer>().isDecoded(), true);
+    CHECK_EQ(lazyLayers[1]->getLayerAs<tmx::TileLayer>().isDecoded(), false);
+    CHECK_EQ(tiles.size(), eagerLayers[0]->getLayerAs<tmx::TileLayer>().getTiles().size());
+
+    //copies of a layer take their undecoded data with them
+    auto copiedLayer = lazyLayers[1]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(copiedLayer.isDecoded(), false);
+    CHECK_EQ(copiedLayer.getName(), lazyLayers[1]->getName());
+    const auto& copiedTiles = copiedLayer.getTiles();
+    const auto& eagerCopiedTiles = eagerLayers[1]->getLayerAs<tmx::TileLayer>().getTiles();
+    CHECK_EQ(std::equal(eagerCopiedTiles.begin(), eagerCopiedTiles.end(), copiedTiles.begin(), copiedTiles.end(),
+        [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getID() == b.getID() && a.getFlipFlags() == b.getFlipFlags(); }), true);
+    CHECK_EQ(lazyLayers[1]->getLayerAs<tmx::TileLayer>().isDecoded(), false);
+
+    CHECK_EQ(std::is_nothrow_move_constructible<tmx::TileLayer>::value, true);
+    CHECK_EQ(std::is_nothrow_move_assignable<tmx::TileLayer>::value, true);
+    auto movedLayer = std::move(copiedLayer);
+    CHECK_EQ(movedLayer.getTiles().size(), eagerCopiedTiles.size());
+    CHECK_EQ(movedLayer.getName(), lazyLayers[1]->getName());
+    CHECK_EQ(copiedLayer.getTiles().empty(), true);
+    copiedLayer = lazyLayers[1]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(copiedLayer.getTiles().size(), eagerCopiedTiles.size());
+
+    lazyMap.decodeAll();
+    for (auto i = 0u; i < std::min(lazyLayers.size(), eagerLayers.size()); ++i)
+    {
+        if (lazyLayers[i]->getType() == tmx::Layer::Type::Tile)
+        {
+            const auto& lazyLayer = lazyLayers[i]->getLayerAs<tmx::TileLayer>();
+            CHECK_EQ(lazyLayer.isDecoded(), true);
+
+            const auto& eagerTiles = eagerLayers[i]->getLayerAs<tmx::TileLayer>().getTiles();
+            CHECK_EQ(std::equal(eagerTiles.begin(), eagerTiles.end(), lazyLayer.getTiles().begin(), lazyLayer.getTiles().end(),
+                [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getID() == b.getID() && a.getFlipFlags() == b.getFlipFlags(); }), true);
+        }
+    }
+}
+
+void testMapReader()
+{
+    struct CountingHandler final : public tmx::MapReader::Handler
+    {
+        std::size_t tilesets = 0;
+        std::size_t layers = 0;
+        std::size_t openLayers = 0;
+        std::size_t tiles = 0;
+        std::size_t objects = 0;
+        std::size_t stopAfter = 0;
+
+        bool onTileset(const tmx::Tileset&) override { tilesets++; return true; }
+        bool onLayerBegin(const tmx::Layer&) override { layers++; openLayers++; return layers != stopAfter; }
+        bool onTileRow(const tmx::TileLayer&, std::uint32_t, const tmx::TileLayer::Tile*, std::size_t count) override { tiles += count; return true; }
+        bool onObject(const tmx::Object&) override { objects++; return true; }
+        bool onLayerEnd(const tmx::Layer&) override { openLayers--; return true; }
+    };
+
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    CountingHandler handler;
+    CHECK_EQ(tmx::MapReader().read("maps/platform.tmx", handler), true);
+    CHECK_EQ(handler.tilesets, map.getTilesets().size());
+    CHECK_EQ(handler.openLayers, 0u);
+
+    //the group and its three tile layers, the object group and the image layer
+    CHECK_EQ(handler.layers, 6u);
+    CHECK_EQ(handler.tiles, 3u * 200u * 40u);
+    CHECK_EQ(handler.objects, map.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects().size());
+
+    //returning false from the handler stops reading, which isn't an error
+    CountingHandler stoppingHandler;
+    stoppingHandler.stopAfter = 2;
+    CHECK_EQ(tmx::MapReader().read("maps/platform.tmx", stoppingHandler), true);
+    CHECK_EQ(stoppingHandler.layers, 2u);
+    CHECK_EQ(stoppingHandler.tiles, 0u);
+}
+
+void testBinaryMap()
+{
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    std::vector<char> data;
+    tmx::BinaryMap::write(map, data);
+    CHECK_EQ(tmx::BinaryMap::isBinaryMap(data.data(), data.size()), true);
+
+    tmx::Map binaryMap;
+    CHECK_EQ(tmx::BinaryMap::read(binaryMap, data.data(), data.size(), "maps"), true);
+    CHECK_EQ(binaryMap.getWorkingDirectory(), "maps");
+    CHECK_EQ(binaryMap.getTileCount().x, map.getTileCount().x);
+    CHECK_EQ(binaryMap.getProperties().size(), map.getProperties().size());
+    CHECK_EQ(binaryMap.getTilesets().size(), map.getTilesets().size());
+    CHECK_EQ(binaryMap.getTilesets()[0].getImagePath(), map.getTilesets()[0].getImagePath());
+    CHECK_EQ(binaryMap.getAnimatedTiles().size(), map.getAnimatedTiles().size());
+    CHECK_EQ(binaryMap.getLayers().size(), map.getLayers().size());
+
+    const auto& tiles = map.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles();
+    const auto& binaryTiles = binaryMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles();
+    CHECK_EQ(std::equal(tiles.begin(), tiles.end(), binaryTiles.begin(), binaryTiles.end(),
+        [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getID() == b.getID() && a.getFlipFlags() == b.getFlipFlags(); }), true);
+
+    const auto& objects = map.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    const auto& binaryObjects = binaryMap.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    CHECK_EQ(binaryObjects.size(), objects.size());
+    CHECK_EQ(binaryObjects[1].getName(), objects[1].getName());
+    CHECK_EQ(binaryObjects[1].getProperties().size(), objects[1].getProperties().size());
+
+    //writing the loaded map should produce exactly the same data
+    std::vector<char> rewritten;
+    tmx::BinaryMap::write(binaryMap, rewritten);
+    CHECK_EQ(rewritten == data, true);
+
+    //corrupt data fails the checksum
+    data[data.size() / 2] ^= 1;
+    tmx::Map corruptMap;
+    CHECK_EQ(tmx::BinaryMap::read(corruptMap, data.data(), data.size(), "maps"), false);
+
+    //Map::load() recognises binary files
+    CHECK_EQ(tmx::BinaryMap::write(map, "binarytest.tmxb"), true);
+    tmx::Map loadedMap;
+    CHECK_EQ(loadedMap.load("binarytest.tmxb"), true);
+    CHECK_EQ(loadedMap.getLayers().size(), map.getLayers().size());
+    std::remove("binarytest.tmxb");
+}
+
+void testMapCache()
+{
+    tmx::Map map;
+    map.setCacheDirectory("mapcache");
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+    CHECK_EQ(map.getDependencies().size(), 1u);
+    CHECK_EQ(map.getDependencies()[0], "images/tilemap/platform.tsx");
+
+    //entries are named after the hash of the map file and its working directory
+    std::string contents;
+    CHECK_EQ(tmx::readFileIntoString("maps/platform.tmx", &contents), true);
+    std::string workingDir("maps/");
+    std::stringstream ss;
+    ss << "mapcache/" << std::hex << std::setw(16) << std::setfill('0')
+        << tmx::hashData(contents.data(), contents.size(), tmx::hashData(workingDir.data(), workingDir.size(), tmx::BinaryMap::FormatVersion))
+        << ".tmxc";
+    auto entryPath = ss.str();
+    CHECK_EQ(std::ifstream(entryPath).is_open(), true);
+
+    //a second load comes from the cache and matches the parsed map
+    tmx::Map cachedMap;
+    cachedMap.setCacheDirectory("mapcache");
+    CHECK_EQ(cachedMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(cachedMap.getDependencies() == map.getDependencies(), true);
+    CHECK_EQ(cachedMap.getWorkingDirectory(), map.getWorkingDirectory());
+
+    std::vector<char> data;
+    std::vector<char> cachedData;
+    tmx::BinaryMap::write(map, data);
+    tmx::BinaryMap::write(cachedMap, cachedData);
+    CHECK_EQ(cachedData == data, true);
+
+    //a corrupt entry is ignored and replaced
+    {
+        std::ofstream file(entryPath, std::ios::binary | std::ios::trunc);
+        file << "TMXC garbage";
+    }
+    CHECK_EQ(cachedMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(cachedMap.getLayers().size(), map.getLayers().size());
+    CHECK_EQ(cachedMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(cachedMap.getLayers().size(), map.getLayers().size());
+
+    std::remove(entryPath.c_str());
+    std::remove("mapcache");
+}
+
+void testTilesetCache()
+{
+    tmx::TilesetCache cache;
+
+    tmx::Map map;
+    map.setTilesetCache(&cache);
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+    CHECK_EQ(cache.size(), 1u);
+
+    tmx::Map otherMap;
+    otherMap.setTilesetCache(&cache);
+    CHECK_EQ(otherMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(cache.size(), 1u);
+
+    //both maps share the same tile data
+    const auto& tileset = map.getTilesets()[0];
+    const auto& otherTileset = otherMap.getTilesets()[0];
+    CHECK_EQ(&tileset.getTiles() == &otherTileset.getTiles(), true);
+    CHECK_EQ(otherTileset.getFirstGID(), tileset.getFirstGID());
+
+    //which matches loading without the cache
+    tmx::Map uncachedMap;
+    CHECK_EQ(uncachedMap.load("maps/platform.tmx"), true);
+    const auto& uncachedTileset = uncachedMap.getTilesets()[0];
+    CHECK_EQ(tileset.getName(), uncachedTileset.getName());
+    CHECK_EQ(tileset.getImagePath(), uncachedTileset.getImagePath());
+    CHECK_EQ(tileset.getTiles().size(), uncachedTileset.getTiles().size());
+
+    //maps keep their tile sets when the cache is cleared
+    cache.clear();
+    CHECK_EQ(cache.size(), 0u);
+    CHECK_EQ(tileset.getTiles().size(), uncachedTileset.getTiles().size());
+
+    //animation frames are stored with local IDs in the shared tile set,
+    //and made global with the first GID of each map which uses it
+    const auto checkFrames = [](const tmx::Map& m, std::uint32_t gid, std::uint32_t first, std::uint32_t second)
+    {
+        const auto& animTiles = m.getAnimatedTiles();
+        CHECK_EQ(animTiles.count(gid), 1u);
+        if (animTiles.count(gid))
+        {
+            const auto& frames = animTiles.at(gid).animation.frames;
+            CHECK_EQ(frames.size(), 2u);
+            CHECK_EQ(frames[0].tileID, first);
+            CHECK_EQ(frames[1].tileID, second);
+        }
+    };
+
+    for (auto* animCache : { static_cast<tmx::TilesetCache*>(nullptr), &cache })
+    {
+        tmx::Map animMap;
+        animMap.setTilesetCache(animCache);
+        CHECK_EQ(animMap.load("maps/animated.tmx"), true);
+        CHECK_EQ(animMap.getTilesets().size(), 2u);
+        CHECK_EQ(animMap.getTilesets()[1].getFirstGID(), 5u);
+        CHECK_EQ(animMap.getTilesets()[1].getTiles()[0].animation.frames[0].tileID, 1u);
+        CHECK_EQ(animMap.getAnimatedTiles().size(), 2u);
+        checkFrames(animMap, 4, 1, 2);
+        checkFrames(animMap, 5, 6, 7);
+
+        //another map using the same tile set at a different first GID
+        tmx::Map otherAnimMap;
+        otherAnimMap.setTilesetCache(animCache);
+        CHECK_EQ(otherAnimMap.loadFromString(R"(<map version="1.10" orientation="orthogonal" renderorder="right-down" width="1" height="1" tilewidth="32" tileheight="32" infinite="0">
+ <tileset firstgid="1" source="../images/tilemap/animated.tsx"/>
+</map>)", "maps"), true);
+        checkFrames(otherAnimMap, 1, 2, 3);
+        checkFrames(animMap, 5, 6, 7);
+        if (animCache)
+        {
+            CHECK_EQ(&otherAnimMap.getTilesets()[0].getTiles() == &animMap.getTilesets()[1].getTiles(), true);
+        }
+
+        //frames are written with their local IDs
+        std::string document;
+        CHECK_EQ(animMap.saveToString(document, "maps"), true);
+        tmx::Map savedMap;
+        CHECK_EQ(savedMap.loadFromString(document, "maps"), true);
+        checkFrames(savedMap, 4, 1, 2);
+        checkFrames(savedMap, 5, 6, 7);
+
+        std::vector<char> data;
+        tmx::BinaryMap::write(animMap, data);
+        tmx::Map binaryMap;
+        CHECK_EQ(tmx::BinaryMap::read(binaryMap, data.data(), data.size(), "maps"), true);
+        checkFrames(binaryMap, 4, 1, 2);
+        checkFrames(binaryMap, 5, 6, 7);
+    }
+}
+
+void testTemplateCache()
+{
+    tmx::Map uncachedMap;
+    CHECK_EQ(uncachedMap.load("maps/templatetest.tmx"), true);
+
+    tmx::TemplateCache cache;
+    tmx::Map map;
+    map.setTemplateCache(&cache);
+    CHECK_EQ(map.load("maps/templatetest.tmx"), true);
+    CHECK_EQ(cache.size(), 1u);
+
+    tmx::Map otherMap;
+    otherMap.setTemplateCache(&cache);
+    CHECK_EQ(otherMap.load("maps/templatetest.tmx"), true);
+    CHECK_EQ(cache.size(), 1u);
+
+    for (const auto* m : { &uncachedMap, &map, &otherMap })
+    {
+        CHECK_EQ(m->getTemplateObjects().size(), 1u);
+        CHECK_EQ(m->getTemplateTilesets().size(), 1u);
+        CHECK_EQ(m->getDependencies().size(), 2u);
+
+        const auto& objects = m->getLayers()[0]->getLayerAs<tmx::ObjectGroup>().getObjects();
+        CHECK_EQ(objects.size(), 2u);
+        CHECK_EQ(objects[0].getName(), "spawn");
+        CHECK_EQ(objects[1].getName(), "boss");
+        CHECK_EQ(objects[1].getTileID(), 2u);
+        CHECK_EQ(objects[1].getTilesetName(), "../images/tilemap/platform.tsx");
+        CHECK_EQ(objects[1].getProperties().size(), 1u);
+        CHECK_EQ(m->getTemplateTilesets().at(objects[1].getTilesetName()).getName(), "platform");
+    }
+
+    //the maps share the template tile set loaded by the cache
+    CHECK_EQ(&map.getTemplateTilesets().begin()->second.getTiles() == &otherMap.getTemplateTilesets().begin()->second.getTiles(), true);
+
+    cache.clear();
+    CHECK_EQ(cache.size(), 0u);
+
+    //templated collision objects in a tile set large enough to be parsed
+    //in batches on the executor, while other layers use the same template
+    std::string document = R"(<map version="1.10" orientation="orthogonal" renderorder="right-down" width="2" height="2" tilewidth="16" tileheight="16" infinite="0">
+ <tileset firstgid="1" name="collision" tilewidth="16" tileheight="16" tilecount="512" columns="32">
+  <image source="../images/tilemap/tileset02.png" width="512" height="256"/>)";
+    for (auto i = 0; i < 512; ++i)
+    {
+        document += "<tile id=\"" + std::to_string(i) + "\"><objectgroup><object id=\"1\" template=\"spawn.tx\" x=\"1\" y=\"2\"/></objectgroup></tile>";
+    }
+    document += "</tileset>";
+    for (auto i = 0; i < 8; ++i)
+    {
+        document += "<objectgroup id=\"" + std::to_string(i + 1) + "\"><object id=\"1\" template=\"spawn.tx\" x=\"4\" y=\"4\"/></objectgroup>";
+    }
+    document += "</map>";
+
+    tmx::ThreadPool pool(4);
+    tmx::TemplateCache sharedCache;
+    for (auto i = 0; i < 2; ++i)
+    {
+        tmx::Map parallelMap;
+        parallelMap.setExecutor(&pool);
+        parallelMap.setTemplateCache(i == 0 ? nullptr : &sharedCache);
+        CHECK_EQ(parallelMap.loadFromString(document, "maps"), true);
+        CHECK_EQ(parallelMap.getTemplateObjects().size(), 1u);
+        CHECK_EQ(parallelMap.getTemplateTilesets().size(), 1u);
+
+        const auto& tiles = parallelMap.getTilesets()[0].getTiles();
+        CHECK_EQ(tiles.size(), 512u);
+        CHECK_EQ(std::all_of(tiles.begin(), tiles.end(), [](const tmx::Tileset::Tile& tile)
+            {
+                const auto& objects = tile.objectGroup.getObjects();
+                return objects.size() == 1 && objects[0].getName() == "spawn" && objects[0].getProperties().size() == 1;
+            }), true);
+        CHECK_EQ(parallelMap.getLayers().size(), 8u);
+        CHECK_EQ(parallelMap.getLayers()[7]->getLayerAs<tmx::ObjectGroup>().getObjects()[0].getName(), "spawn");
+    }
+}
+
+void testAsyncLoad()
+{
+    tmx::AsyncLoad invalid;
+    CHECK_EQ(invalid.isValid(), false);
+    CHECK_EQ(invalid.get(), false);
+
+    tmx::AsyncLoad::Progress lastProgress;
+    tmx::Map map;
+    auto handle = map.loadAsync("maps/platform.tmx", [&lastProgress](const tmx::AsyncLoad::Progress& progress) { lastProgress = progress; });
+    CHECK_EQ(handle.isValid(), true);
+    CHECK_EQ(handle.get(), true);
+    CHECK_EQ(handle.isReady(), true);
+    CHECK_EQ(map.getLayers().size(), 3u);
+    CHECK_EQ(lastProgress.totalLayers, 6u);
+    CHECK_EQ(lastProgress.layersLoaded, lastProgress.totalLayers);
+    CHECK_EQ(lastProgress.bytesParsed, lastProgress.totalBytes);
+    CHECK_EQ(handle.getProgress().layersLoaded, lastProgress.layersLoaded);
+
+    //the first progress report waits until the load has been cancelled
+    std::promise<void> cancelled;
+    auto cancelledFuture = cancelled.get_future().share();
+    tmx::Map cancelledMap;
+    auto cancelledHandle = cancelledMap.loadAsync("maps/platform.tmx", [cancelledFuture](const tmx::AsyncLoad::Progress&) { cancelledFuture.wait(); });
+    cancelledHandle.cancel();
+    cancelled.set_value();
+    CHECK_EQ(cancelledHandle.isCancelled(), true);
+    CHECK_EQ(cancelledHandle.get(), false);
+    CHECK_EQ(cancelledMap.getLayers().empty(), true);
+    CHECK_EQ(cancelledHandle.getProgress().layersLoaded, 0u);
+}
+
+void testIncrementalLoader()
+{
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    //the smallest budget parses a single element per step
+    tmx::IncrementalLoader loader("maps/platform.tmx");
+    CHECK_EQ(loader.getStatus() == tmx::IncrementalLoader::Status::InProgress, true);
+
+    auto steps = 0;
+    while (loader.step(std::size_t(1)) == tmx::IncrementalLoader::Status::InProgress)
+    {
+        steps++;
+    }
+    CHECK_EQ(loader.getStatus() == tmx::IncrementalLoader::Status::Done, true);
+    CHECK_EQ(steps > 6, true);
+
+    const auto& loadedMap = loader.getMap();
+    CHECK_EQ(loadedMap.getTileCount().x, map.getTileCount().x);
+    CHECK_EQ(loadedMap.getTilesets().size(), map.getTilesets().size());
+    CHECK_EQ(loadedMap.getProperties().size(), map.getProperties().size());
+    CHECK_EQ(loadedMap.getAnimatedTiles().size(), map.getAnimatedTiles().size());
+    CHECK_EQ(loadedMap.getLayers().size(), map.getLayers().size());
+
+    const auto& group = loadedMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>();
+    CHECK_EQ(group.getLayers().size(), 3u);
+    CHECK_EQ(group.getProperties().size(), map.getLayers()[0]->getProperties().size());
+    CHECK_EQ(group.getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles().size(),
+        map.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles().size());
+
+    //a time budget large enough for the whole map finishes in one step
+    tmx::IncrementalLoader timedLoader("maps/platform.tmx");
+    CHECK_EQ(timedLoader.step(std::chrono::seconds(10)) == tmx::IncrementalLoader::Status::Done, true);
+    CHECK_EQ(timedLoader.getMap().getLayers().size(), map.getLayers().size());
+
+    tmx::IncrementalLoader missingLoader("maps/missing.tmx");
+    CHECK_EQ(missingLoader.step(std::chrono::milliseconds(2)) == tmx::IncrementalLoader::Status::Failed, true);
+}
+
+//serves files from memory, as if they had been unpacked from an archive.
+//paths must start with "archive/", so nothing can be read from disk directly
+class ArchiveProvider final : public tmx::AssetProvider
+{
+public:
+    bool open(const std::string& path, tmx::AssetBuffer& buffer) override
+    {
+        const std::string prefix("archive/");
+        if (path.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+
+        auto result = m_files.find(path);
+        if (result == m_files.end())
+        {
+            std::string contents;
+            if (!tmx::readFileIntoString(path.substr(prefix.size()), &contents))
+            {
+                return false;
+            }
+            result = m_files.insert(std::make_pair(path, std::move(contents))).first;
+        }
+
+        buffer.setBorrowed(result->second.data(), result->second.size());
+        openCount++;
+        return true;
+    }
+
+    std::size_t openCount = 0;
+
+private:
+    std::map<std::string, std::string> m_files;
+};
+
+void testAssetProvider()
+{
+    tmx::Map diskMap;
+    CHECK_EQ(diskMap.load("maps/templatetest.tmx"), true);
+
+    ArchiveProvider provider;
+    tmx::Map map;
+    CHECK_EQ(map.load("archive/maps/templatetest.tmx"), false);
+
+    map.setAssetProvider(&provider);
+    CHECK_EQ(map.load("archive/maps/templatetest.tmx"), true);
+    CHECK_EQ(provider.openCount > 1u, true);
+    CHECK_EQ(map.getTemplateObjects().size(), diskMap.getTemplateObjects().size());
+    CHECK_EQ(map.getTemplateTilesets().size(), diskMap.getTemplateTilesets().size());
+    CHECK_EQ(map.getLayers()[0]->getLayerAs<tmx::ObjectGroup>().getObjects()[1].getTileID(), 2u);
+
+    //borrowed buffers are copied before being parsed, so loading twice gives the same result
+    CHECK_EQ(map.load("archive/maps/templatetest.tmx"), true);
+    CHECK_EQ(map.getTemplateObjects().size(), diskMap.getTemplateObjects().size());
+
+    //external tile sets are read through the map's provider
+    tmx::Map platformMap;
+    platformMap.setAssetProvider(&provider);
+    CHECK_EQ(platformMap.load("archive/maps/platform.tmx"), true);
+    CHECK_EQ(platformMap.getTilesets().size(), 2u);
+    CHECK_EQ(platformMap.getTilesets()[0].getAssetProvider() == &provider, true);
+    CHECK_EQ(platformMap.getTilesets()[0].getTiles().empty(), false);
+
+    //files are never cached if the provider can't tell when they change
+    tmx::TilesetCache cache;
+    platformMap.setTilesetCache(&cache);
+    CHECK_EQ(platformMap.load("archive/maps/platform.tmx"), true);
+    CHECK_EQ(cache.size(), 0u);
+    CHECK_EQ(platformMap.getTilesets()[0].getTiles().empty(), false);
+
+    tmx::IncrementalLoader loader("archive/maps/platform.tmx");
+    loader.getMap().setAssetProvider(&provider);
+    CHECK_EQ(loader.step(std::chrono::seconds(10)) == tmx::IncrementalLoader::Status::Done, true);
+    CHECK_EQ(loader.getMap().getLayers().size(), platformMap.getLayers().size());
+
+    CHECK_EQ(map.load("archive/maps/missing.tmx"), false);
+}
+
+void testZipArchive()
+{
+    tmx::ZipArchiveProvider archive;
+    CHECK_EQ(archive.openArchive("maps/platform.tmx"), false);
+    CHECK_EQ(archive.isArchiveOpen(), false);
+
+    CHECK_EQ(archive.openArchive("maps/archive.zip"), true);
+    CHECK_EQ(archive.getFileCount(), 4u);
+    CHECK_EQ(archive.contains("maps/platform.tmx"), true);
+    CHECK_EQ(archive.contains("./maps/../maps/spawn.tx"), true);
+    CHECK_EQ(archive.contains("maps/"), false);
+    CHECK_EQ(archive.contains("maps/missing.tmx"), false);
+
+    tmx::Map diskMap;
+    CHECK_EQ(diskMap.load("maps/platform.tmx"), true);
+
+    //platform.tmx is deflated and its external tile set is stored
+    tmx::TilesetCache cache;
+    tmx::Map map;
+    map.setAssetProvider(&archive);
+    map.setTilesetCache(&cache);
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+    CHECK_EQ(map.getLayers().size(), diskMap.getLayers().size());
+    CHECK_EQ(map.getTilesets().size(), diskMap.getTilesets().size());
+    CHECK_EQ(map.getTilesets()[0].getName(), diskMap.getTilesets()[0].getName());
+    CHECK_EQ(map.getTilesets()[0].getTiles().size(), diskMap.getTilesets()[0].getTiles().size());
+    CHECK_EQ(map.getProperties().size(), diskMap.getProperties().size());
+    CHECK_EQ(cache.size(), 1u);
+
+    tmx::Map templateMap;
+    templateMap.setAssetProvider(&archive);
+    CHECK_EQ(templateMap.load("maps/templatetest.tmx"), true);
+    CHECK_EQ(templateMap.getTemplateObjects().size(), 1u);
+    CHECK_EQ(templateMap.getTemplateTilesets().size(), 1u);
+    CHECK_EQ(templateMap.getLayers()[0]->getLayerAs<tmx::ObjectGroup>().getObjects()[1].getTileID(), 2u);
+
+    //archives can also be read from memory
+    std::string contents;
+    CHECK_EQ(tmx::readFileIntoString("maps/archive.zip", &contents), true);
+
+    tmx::ZipArchiveProvider memoryArchive;
+    CHECK_EQ(memoryArchive.openArchive(contents.data(), contents.size()), true);
+    CHECK_EQ(memoryArchive.getFileCount(), 4u);
+
+    tmx::Map memoryMap;
+    memoryMap.setAssetProvider(&memoryArchive);
+    CHECK_EQ(memoryMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(memoryMap.getTilesets().size(), diskMap.getTilesets().size());
+
+    //a truncated zip64 archive, too short to hold the zip64 record its
+    //locator points to, which happens to find the record's signature
+    const unsigned char truncated[] =
+    {
+        'P', 'K', 6, 7, 0, 0, 0, 0, 38, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+        'P', 'K', 5, 6, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 'P', 'K', 6, 6
+    };
+    tmx::ZipArchiveProvider truncatedArchive;
+    CHECK_EQ(truncatedArchive.openArchive(reinterpret_cast<const char*>(truncated), sizeof(truncated)), false);
+    CHECK_EQ(truncatedArchive.isArchiveOpen(), false);
+
+    //stored files remain valid after the archive is closed
+    tmx::AssetBuffer buffer;
+    CHECK_EQ(archive.open("images/tilemap/platform.tsx", buffer), true);
+    archive.closeArchive();
+    CHECK_EQ(archive.getFileCount(), 0u);
+    CHECK_EQ(std::string(buffer.data(), 5), "<?xml");
+    CHECK_EQ(map.load("maps/platform.tmx"), false);
+}
+
+void testLayerFilter()
+{
+    //keep only the object group and the group's "Middle" layer
+    std::vector<tmx::Map::LayerInfo> seen;
+    std::mutex mutex;
+    auto filter = [&](const tmx::Map::LayerInfo& info)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.push_back(info);
+        return info.type == tmx::Layer::Type::Object
+            || info.type == tmx::Layer::Type::Group
+            || (info.groupPath == "TestGroup" && info.name == "Middle");
+    };
+
+    tmx::Map map;
+    map.setLayerFilter(filter);
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+    CHECK_EQ(seen.size(), 6u);
+    CHECK_EQ(map.getLayers().size(), 2u);
+    CHECK_EQ(map.getLayers()[0]->getName(), "TestGroup");
+    CHECK_EQ(map.getLayers()[1]->getName(), "Objects");
+    CHECK_EQ(map.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects().empty(), false);
+
+    const auto& group = map.getLayers()[0]->getLayerAs<tmx::LayerGroup>();
+    CHECK_EQ(group.getLayers().size(), 1u);
+    CHECK_EQ(group.getLayers()[0]->getName(), "Middle");
+    CHECK_EQ(group.getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles().empty(), false);
+    CHECK_EQ(group.getProperties().empty(), false);
+
+    const auto far = std::find_if(seen.begin(), seen.end(), [](const tmx::Map::LayerInfo& info) { return info.name == "Far"; });
+    CHECK_EQ(far != seen.end(), true);
+    CHECK_EQ(far->className, "TestLayerClass");
+    CHECK_EQ(far->type == tmx::Layer::Type::Tile, true);
+
+    //rejecting a group skips everything in it
+    seen.clear();
+    tmx::Map threadedMap;
+    threadedMap.setThreadCount(4);
+    threadedMap.setLayerFilter([&](const tmx::Map::LayerInfo& info) { filter(info); return info.type != tmx::Layer::Type::Group; });
+    CHECK_EQ(threadedMap.load("maps/platform.tmx"), true);
+    CHECK_EQ(seen.size(), 3u);
+    CHECK_EQ(threadedMap.getLayers().size(), 2u);
+    CHECK_EQ(threadedMap.getLayers()[0]->getName(), "Objects");
+
+    //the same layers are loaded incrementally and from binary maps
+    tmx::IncrementalLoader loader("maps/platform.tmx");
+    loader.getMap().setLayerFilter(filter);
+    while (loader.step(std::size_t(1)) == tmx::IncrementalLoader::Status::InProgress) {}
+    CHECK_EQ(loader.getStatus() == tmx::IncrementalLoader::Status::Done, true);
+    CHECK_EQ(loader.getMap().getLayers().size(), 2u);
+    CHECK_EQ(loader.getMap().getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers().size(), 1u);
+
+    tmx::Map fullMap;
+    CHECK_EQ(fullMap.load("maps/platform.tmx"), true);
+    std::vector<char> binary;
+    tmx::BinaryMap::write(fullMap, binary);
+
+    tmx::Map binaryMap;
+    binaryMap.setLayerFilter(filter);
+    CHECK_EQ(tmx::BinaryMap::read(binaryMap, binary.data(), binary.size(), "maps"), true);
+    CHECK_EQ(binaryMap.getLayers().size(), 2u);
+    CHECK_EQ(binaryMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers().size(), 1u);
+    CHECK_EQ(binaryMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers()[0]->getName(), "Middle");
+}
+
+void testRegionOfInterest()
+{
+    tmx::Map fullMap;
+    CHECK_EQ(fullMap.load("maps/infinite.tmx"), true);
+    const auto& fullLayer = fullMap.getLayers()[0]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(fullLayer.getChunks().size(), 5u);
+    CHECK_EQ(fullLayer.getPendingChunkCount(), 0u);
+
+    //the region touches the chunks at 0,0 and 0,-16 only
+    tmx::Map map;
+    map.setRegionsOfInterest({ tmx::IntRect(0, -1, 8, 2) });
+    CHECK_EQ(map.load("maps/infinite.tmx"), true);
+
+    auto& layer = map.getLayers()[0]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(layer.getChunks().size(), 2u);
+    CHECK_EQ(layer.getPendingChunkCount(), 3u);
+    CHECK_EQ(layer.getChunks()[0].position.x, 0);
+    CHECK_EQ(layer.getChunks()[0].position.y, -16);
+    CHECK_EQ(layer.getChunks()[0].tiles[0].getID(), 2u);
+    CHECK_EQ(layer.getChunks()[1].position.y, 0);
+    CHECK_EQ(layer.getChunks()[1].tiles[0].getID(), 4u);
+
+    const auto& detailLayer = map.getLayers()[1]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(detailLayer.getChunks().size(), 1u);
+    CHECK_EQ(detailLayer.getPendingChunkCount(), 1u);
+
+    //the rest are loaded on demand, and added after those already loaded
+    CHECK_EQ(layer.loadRegion(tmx::IntRect(40, 40, 1, 1)), 1u);
+    CHECK_EQ(layer.getChunks().size(), 3u);
+    CHECK_EQ(layer.getChunks()[2].position.x, 32);
+    CHECK_EQ(layer.getChunks()[2].tiles[255].getID(), 5u);
+    CHECK_EQ(layer.loadRegion(tmx::IntRect(40, 40, 1, 1)), 0u);
+    CHECK_EQ(layer.getPendingChunkCount(), 2u);
+
+    //several regions, combined with lazy decoding
+    tmx::Map lazyMap;
+    lazyMap.setLazyDecoding(true);
+    lazyMap.setRegionsOfInterest({ tmx::IntRect(-16, -16, 1, 1), tmx::IntRect(32, 32, 16, 16) });
+    CHECK_EQ(lazyMap.load("maps/infinite.tmx"), true);
+    auto& lazyLayer = lazyMap.getLayers()[0]->getLayerAs<tmx::TileLayer>();
+    CHECK_EQ(lazyLayer.isDecoded(), false);
+    CHECK_EQ(lazyLayer.getChunks().size(), 2u);
+    CHECK_EQ(lazyLayer.getPendingChunkCount(), 3u);
+
+    tmx::ThreadPool pool(2);
+    CHECK_EQ(lazyLayer.loadRegion(tmx::IntRect(-1000, -1000, 2000, 2000), &pool), 3u);
+    CHECK_EQ(lazyLayer.getPendingChunkCount(), 0u);
+    CHECK_EQ(lazyLayer.getChunks().size(), fullLayer.getChunks().size());
+
+    //binary maps are written with every chunk
+    std::vector<char> binary;
+    tmx::BinaryMap::write(map, binary);
+    tmx::Map binaryMap;
+    CHECK_EQ(tmx::BinaryMap::read(binaryMap, binary.data(), binary.size(), "maps"), true);
+    CHECK_EQ(binaryMap.getLayers()[0]->getLayerAs<tmx::TileLayer>().getChunks().size(), 5u);
+    CHECK_EQ(binaryMap.getLayers()[1]->getLayerAs<tmx::TileLayer>().getChunks().size(), 2u);
+
+    //as are saved maps
+    std::string document;
+    CHECK_EQ(map.saveToString(document, "maps"), true);
+    tmx::Map savedMap;
+    CHECK_EQ(savedMap.loadFromString(document, "maps"), true);
+    CHECK_EQ(savedMap.getLayers()[0]->getLayerAs<tmx::TileLayer>().getChunks().size(), 5u);
+
+    //writing the map leaves the chunks which haven't been loaded as they were
+    CHECK_EQ(layer.getPendingChunkCount(), 2u);
+    CHECK_EQ(layer.getChunks().size(), 3u);
+    CHECK_EQ(layer.loadRegion(tmx::IntRect(-1000, -1000, 2000, 2000)), 2u);
+}
+
+void testMapInfo()
+{
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    tmx::MapInfo info;
+    CHECK_EQ(info.probe("maps/platform.tmx"), true);
+    CHECK_EQ(info.getVersion().upper, map.getVersion().upper);
+    CHECK_EQ(info.getVersion().lower, map.getVersion().lower);
+    CHECK_EQ(info.getOrientation() == map.getOrientation(), true);
+    CHECK_EQ(info.getRenderOrder() == map.getRenderOrder(), true);
+    CHECK_EQ(info.getTileCount().x, map.getTileCount().x);
+    CHECK_EQ(info.getTileCount().y, map.getTileCount().y);
+    CHECK_EQ(info.getTileSize().x, map.getTileSize().x);
+    CHECK_EQ(info.isInfinite(), false);
+    CHECK_EQ(info.getClass(), map.getClass());
+    CHECK_EQ(info.getProperties().size(), map.getProperties().size());
+
+    //layers inside groups follow the group
+    const auto& layers = info.getLayers();
+    CHECK_EQ(layers.size(), 6u);
+    CHECK_EQ(layers[0].name, "TestGroup");
+    CHECK_EQ(layers[0].type == tmx::Layer::Type::Group, true);
+    CHECK_EQ(layers[1].name, "Far");
+    CHECK_EQ(layers[1].className, "TestLayerClass");
+    CHECK_EQ(layers[1].groupPath, "TestGroup");
+    CHECK_EQ(layers[4].name, "Objects");
+    CHECK_EQ(layers[4].type == tmx::Layer::Type::Object, true);
+    CHECK_EQ(layers[4].groupPath.empty(), true);
+    CHECK_EQ(layers[5].type == tmx::Layer::Type::Image, true);
+
+    const auto& tilesets = info.getTilesets();
+    CHECK_EQ(tilesets.size(), 2u);
+    CHECK_EQ(tilesets[0].firstGID, 1u);
+    CHECK_EQ(tilesets[0].source, "images/tilemap/platform.tsx");
+    CHECK_EQ(tilesets[1].firstGID, 43u);
+    CHECK_EQ(tilesets[1].source.empty(), true);
+    CHECK_EQ(tilesets[1].name, "tileset02");
+
+    CHECK_EQ(info.probe("maps/infinite.tmx"), true);
+    CHECK_EQ(info.isInfinite(), true);
+    CHECK_EQ(info.getLayers().size(), 2u);
+    CHECK_EQ(info.getProperties().empty(), true);
+
+    tmx::ZipArchiveProvider archive;
+    CHECK_EQ(archive.openArchive("maps/archive.zip"), true);
+    info.setAssetProvider(&archive);
+    CHECK_EQ(info.probe("maps/templatetest.tmx"), true);
+    CHECK_EQ(info.getLayers().size(), 1u);
+
+    CHECK_EQ(info.probe("maps/missing.tmx"), false);
+    CHECK_EQ(info.getLayers().empty(), true);
+}
+
+void testJsonMap()
+{
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    tmx::Map jsonMap;
+    CHECK_EQ(jsonMap.load("maps/platform.tmj"), true);
+    CHECK_EQ(jsonMap.getTileCount().x, map.getTileCount().x);
+    CHECK_EQ(jsonMap.getTileCount().y, map.getTileCount().y);
+    CHECK_EQ(jsonMap.getClass(), map.getClass());
+    CHECK_EQ(jsonMap.getProperties().size(), map.getProperties().size());
+    CHECK_EQ(jsonMap.getTilesets().size(), map.getTilesets().size());
+    CHECK_EQ(jsonMap.getTilesets()[0].getTiles().size(), map.getTilesets()[0].getTiles().size());
+    CHECK_EQ(jsonMap.getTilesets()[1].getFirstGID(), map.getTilesets()[1].getFirstGID());
+    CHECK_EQ(jsonMap.getAnimatedTiles().size(), map.getAnimatedTiles().size());
+    CHECK_EQ(jsonMap.getDependencies().size(), 1u);
+    CHECK_EQ(jsonMap.getDependencies()[0], "images/tilemap/platform.tsj");
+    CHECK_EQ(jsonMap.getLayers().size(), map.getLayers().size());
+
+    //the first layer is base64 compressed, the others are plain arrays
+    const auto& group = map.getLayers()[0]->getLayerAs<tmx::LayerGroup>();
+    const auto& jsonGroup = jsonMap.getLayers()[0]->getLayerAs<tmx::LayerGroup>();
+    CHECK_EQ(jsonGroup.getLayers().size(), group.getLayers().size());
+    for (auto i = 0u; i < group.getLayers().size(); ++i)
+    {
+        CHECK_EQ(jsonGroup.getLayers()[i]->getName(), group.getLayers()[i]->getName());
+        if (group.getLayers()[i]->getType() == tmx::Layer::Type::Tile)
+        {
+            const auto& tiles = group.getLayers()[i]->getLayerAs<tmx::TileLayer>().getTiles();
+            const auto& jsonTiles = jsonGroup.getLayers()[i]->getLayerAs<tmx::TileLayer>().getTiles();
+            CHECK_EQ(std::equal(tiles.begin(), tiles.end(), jsonTiles.begin(), jsonTiles.end(),
+                [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getID() == b.getID() && a.getFlipFlags() == b.getFlipFlags(); }), true);
+        }
+    }
+
+    const auto& objects = map.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    const auto& jsonObjects = jsonMap.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    CHECK_EQ(jsonObjects.size(), objects.size());
+    CHECK_EQ(jsonObjects[1].getName(), objects[1].getName());
+    CHECK_EQ(jsonObjects[1].getShape() == objects[1].getShape(), true);
+    CHECK_EQ(jsonObjects[1].getProperties().size(), objects[1].getProperties().size());
+
+    tmx::Map templateMap;
+    CHECK_EQ(templateMap.load("maps/templatetest.tmj"), true);
+    CHECK_EQ(templateMap.getTemplateObjects().size(), 1u);
+    const auto& spawns = templateMap.getLayers()[0]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    CHECK_EQ(spawns.size(), 2u);
+    CHECK_EQ(spawns[0].getName(), "spawn");
+    CHECK_EQ(spawns[1].getName(), "boss");
+    CHECK_EQ(spawns[1].getTileID(), 2u);
+    CHECK_EQ(spawns[1].getProperties().size(), 1u);
+
+    tmx::Tileset tileset;
+    CHECK_EQ(tileset.loadWithoutMap("images/tilemap/platform.tsj"), true);
+    CHECK_EQ(tileset.getName(), map.getTilesets()[0].getName());
+    CHECK_EQ(tileset.getTileCount(), map.getTilesets()[0].getTileCount());
+
+    const std::string json = R"({ "type":"map", "version":"1.10", "orientation":"orthogonal", "width":2, "height":1,
+        "tilewidth":16, "tileheight":16, "tilesets":[],
+        "layers":[{ "type":"tilelayer", "name":"Strings \u00e9", "width":2, "height":1, "data":[1, 2147483650] }] })";
+    CHECK_EQ(tmx::JsonMap::isJson(json.data(), json.size()), true);
+    tmx::Map stringMap;
+    CHECK_EQ(stringMap.loadFromString(json, "maps"), true);
+    CHECK_EQ(stringMap.getLayers().size(), 1u);
+    CHECK_EQ(stringMap.getLayers()[0]->getName(), "Strings \xc3\xa9");
+    const auto& stringTiles = stringMap.getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles();
+    CHECK_EQ(stringTiles[1].getID(), 2u);
+    CHECK_EQ(stringTiles[1].getFlipFlags(), tmx::TileLayer::FlipFlag::Horizontal);
+    CHECK_EQ(stringTiles[1].getGID(), 2147483650u);
+
+    //tiles are packed the same way Tiled stores them
+    CHECK_EQ(sizeof(tmx::TileLayer::Tile), 4u);
+    const auto packedTile = tmx::TileLayer::Tile::fromGID(0xa0000123);
+    CHECK_EQ(packedTile.getID(), 0x123u);
+    CHECK_EQ(packedTile.getFlipFlags(), static_cast<std::uint32_t>(tmx::TileLayer::FlipFlag::Horizontal | tmx::TileLayer::FlipFlag::Diagonal));
+    CHECK_EQ(packedTile.getGID(), 0xa0000123u);
+
+    //setting the ID or flags leaves the other untouched
+    auto editedTile = packedTile;
+    editedTile.setID(0x456);
+    CHECK_EQ(editedTile.getGID(), 0xa0000456u);
+    editedTile.setFlipFlags(tmx::TileLayer::FlipFlag::Vertical);
+    CHECK_EQ(editedTile.getGID(), 0x40000456u);
+    CHECK_EQ(tmx::TileLayer::Tile(0x456, tmx::TileLayer::FlipFlag::Vertical).getGID(), editedTile.getGID());
+    CHECK_EQ(tmx::TileLayer::Tile().getGID(), 0u);
+
+    const std::string broken = R"({ "type":"map", "layers":[ )";
+    tmx::Map brokenMap;
+    CHECK_EQ(brokenMap.loadFromString(broken, "maps"), false);
+    CHECK_EQ(tmx::JsonMap::isJson("<map/>", 6), false);
+}
+
+void testSaveMap()
+{
+    tmx::Map map;
+    map.setThreadCount(2);
+    CHECK_EQ(map.load("maps/platform.tmx"), true);
+
+    const auto compareTiles = [](const tmx::Map& a, const tmx::Map& b)
+    {
+        const auto& groupA = a.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers();
+        const auto& groupB = b.getLayers()[0]->getLayerAs<tmx::LayerGroup>().getLayers();
+        if (groupA.size() != groupB.size())
+        {
+            return false;
+        }
+
+        for (auto i = 0u; i < groupA.size(); ++i)
+        {
+            const auto& tilesA = groupA[i]->getLayerAs<tmx::TileLayer>().getTiles();
+            const auto& tilesB = groupB[i]->getLayerAs<tmx::TileLayer>().getTiles();
+            if (!std::equal(tilesA.begin(), tilesA.end(), tilesB.begin(), tilesB.end(),
+                [](const tmx::TileLayer::Tile& x, const tmx::TileLayer::Tile& y) { return x.getID() == y.getID() && x.getFlipFlags() == y.getFlipFlags(); }))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (auto encoding : { tmx::SaveSettings::Encoding::CSV, tmx::SaveSettings::Encoding::Base64, tmx::SaveSettings::Encoding::Base64Zlib })
+    {
+        tmx::SaveSettings settings;
+        settings.encoding = encoding;
+
+        std::string document;
+        CHECK_EQ(map.saveToString(document, "maps", settings), true);
+
+        tmx::Map savedMap;
+        CHECK_EQ(savedMap.loadFromString(document, "maps"), true);
+        CHECK_EQ(savedMap.getClass(), map.getClass());
+        CHECK_EQ(savedMap.getRenderOrder() == map.getRenderOrder(), true);
+        CHECK_EQ(savedMap.getProperties().size(), map.getProperties().size());
+        CHECK_EQ(savedMap.getTilesets().size(), map.getTilesets().size());
+        CHECK_EQ(savedMap.getTilesets()[0].getImagePath(), map.getTilesets()[0].getImagePath());
+        CHECK_EQ(savedMap.getTilesets()[1].getImagePath(), map.getTilesets()[1].getImagePath());
+        CHECK_EQ(savedMap.getLayers().size(), map.getLayers().size());
+        CHECK_EQ(compareTiles(savedMap, map), true);
+
+        const auto& objects = map.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+        const auto& savedObjects = savedMap.getLayers()[1]->getLayerAs<tmx::ObjectGroup>().getObjects();
+        CHECK_EQ(savedObjects.size(), objects.size());
+        CHECK_EQ(savedObjects[3].getPoints().size(), objects[3].getPoints().size());
+        CHECK_EQ(savedObjects[4].getRotation(), objects[4].getRotation());
+        CHECK_EQ(savedMap.getLayers()[1]->getOffset().y, map.getLayers()[1]->getOffset().y);
+
+        //saving the saved map produces the same document
+        std::string resaved;
+        CHECK_EQ(savedMap.saveToString(resaved, "maps", settings), true);
+        CHECK_EQ(resaved == document, true);
+    }
+
+    CHECK_EQ(map.save("savetest.tmx"), true);
+    tmx::Map loadedMap;
+    CHECK_EQ(loadedMap.load("savetest.tmx"), true);
+    CHECK_EQ(loadedMap.getTilesets()[0].getSource(), "images/tilemap/platform.tsx");
+    CHECK_EQ(compareTiles(loadedMap, map), true);
+    std::remove("savetest.tmx");
+
+    //templates are applied to the saved objects, and their tile set added to the map
+    tmx::Map templateMap;
+    CHECK_EQ(templateMap.load("maps/templatetest.tmx"), true);
+    std::string document;
+    CHECK_EQ(templateMap.saveToString(document, "maps"), true);
+    tmx::Map savedTemplateMap;
+    CHECK_EQ(savedTemplateMap.loadFromString(document, "maps"), true);
+    CHECK_EQ(savedTemplateMap.getTilesets().size(), 1u);
+    CHECK_EQ(savedTemplateMap.getTemplateObjects().empty(), true);
+    const auto& spawns = savedTemplateMap.getLayers()[0]->getLayerAs<tmx::ObjectGroup>().getObjects();
+    CHECK_EQ(spawns[1].getName(), "boss");
+    CHECK_EQ(spawns[1].getTileID(), 2u);
+    CHECK_EQ(spawns[1].getProperties().size(), 1u);
+
+    tmx::Tileset tileset;
+    CHECK_EQ(tileset.loadWithoutMap("images/tilemap/platform.tsx"), true);
+    tileset.saveToString(document, "images/tilemap");
+    tmx::Tileset savedTileset("images/tilemap");
+    CHECK_EQ(savedTileset.loadWithoutMapFromString(document), true);
+    CHECK_EQ(savedTileset.getName(), tileset.getName());
+    CHECK_EQ(savedTileset.getClass(), tileset.getClass());
+    CHECK_EQ(savedTileset.getImagePath(), tileset.getImagePath());
+    CHECK_EQ(savedTileset.getProperties().size(), tileset.getProperties().size());
+    CHECK_EQ(savedTileset.getTiles().size(), tileset.getTiles().size());
+    CHECK_EQ(savedTileset.getSource().empty(), true);
+
+    //layers and tile sets can be added to a loaded map, as a
+    //procedural generator might before saving the result
+    tmx::Map generatedMap;
+    CHECK_EQ(generatedMap.load("maps/animated.tmx"), true);
+    tileset.setFirstGID(generatedMap.getTilesets().back().getLastGID() + 1);
+    generatedMap.addTileset(tileset);
+    generatedMap.setTileCount({ 4, 4 });
+
+    std::vector<tmx::TileLayer::Tile> generatedTiles;
+    for (auto i = 0u; i < 16; ++i)
+    {
+        generatedTiles.emplace_back(tileset.getFirstGID() + i, i % 2 ? tmx::TileLayer::FlipFlag::Horizontal : 0);
+    }
+    auto generatedLayer = std::make_unique<tmx::TileLayer>(generatedTiles.size());
+    generatedLayer->setName("generated");
+    generatedLayer->setSize(4, 4);
+    generatedLayer->setTiles(generatedTiles);
+    CHECK_EQ(generatedLayer->getTiles().size(), 16u);
+    generatedMap.addLayer(std::move(generatedLayer));
+
+    tmx::SaveSettings zlibSettings;
+    zlibSettings.encoding = tmx::SaveSettings::Encoding::Base64Zlib;
+    CHECK_EQ(generatedMap.saveToString(document, "maps", zlibSettings), true);
+    tmx::Map savedGeneratedMap;
+    CHECK_EQ(savedGeneratedMap.loadFromString(document, "maps"), true);
+    CHECK_EQ(savedGeneratedMap.getTileCount().x, 4u);
+    CHECK_EQ(savedGeneratedMap.getTilesets().size(), 3u);
+    CHECK_EQ(savedGeneratedMap.getTilesets()[2].getFirstGID(), 29u);
+    CHECK_EQ(savedGeneratedMap.getTilesets()[2].getName(), tileset.getName());
+    CHECK_EQ(savedGeneratedMap.getAnimatedTiles().size(), generatedMap.getAnimatedTiles().size());
+    CHECK_EQ(savedGeneratedMap.getLayers().size(), 2u);
+    CHECK_EQ(savedGeneratedMap.getLayers()[1]->getName(), "generated");
+    const auto& savedGeneratedTiles = savedGeneratedMap.getLayers()[1]->getLayerAs<tmx::TileLayer>().getTiles();
+    CHECK_EQ(std::equal(generatedTiles.begin(), generatedTiles.end(), savedGeneratedTiles.begin(), savedGeneratedTiles.end(),
+        [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getGID() == b.getGID(); }), true);
+}
+
 void testResolvingPaths()
 {
     RevertWindowsPathHandling revertWindowsPathHandling;
@@ -271,6 +1514,188 @@ void testResolvingPaths()
     CHECK_EQ(tmx::resolveFilePath("a\\..\\b\\c", "C:\\A\\B\\..\\C"), "C:/A/C/b/c");
 }
 
+void testBase64Decode()
+{
+    CHECK_EQ(tmx::base64_decode("dG14bGl0ZQ=="), "tmxlite");
+    CHECK_EQ(tmx::base64_decode("dG14bGl0ZTI="), "tmxlite2");
+    CHECK_EQ(tmx::base64_decode("dG14bGl0ZTIz"), "tmxlite23");
+
+    //whitespace as written by Tiled should be skipped
+    CHECK_EQ(tmx::base64_decode("\n   dG14bG\n   l0ZQ==\n  "), "tmxlite");
+
+    //long enough to take the vector paths, with a line break part way through
+    CHECK_EQ(tmx::base64_decode("VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZy4gVGhl\nIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZy4="),
+        "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.");
+
+    //decoding stops at invalid characters
+    CHECK_EQ(tmx::base64_decode("dG14*bGl0ZQ=="), "tmx");
+
+    //and never writes past the end of the output
+    std::string out(4, '\0');
+    auto size = tmx::base64_decode("dG14bGl0ZQ==", 12, reinterpret_cast<unsigned char*>(&out[0]), out.size());
+    CHECK_EQ(size, 4u);
+    CHECK_EQ(out, "tmxl");
+
+    CHECK_EQ(tmx::base64_encode("tmxlite"), "dG14bGl0ZQ==");
+    CHECK_EQ(tmx::base64_encode("tmxlite2"), "dG14bGl0ZTI=");
+    CHECK_EQ(tmx::base64_encode("tmxlite23"), "dG14bGl0ZTIz");
+    CHECK_EQ(tmx::base64_encode(""), "");
+}
+
+void testCSVDecode()
+{
+    std::uint32_t out[8] = {};
+    std::size_t used = 0;
+
+    //as written by Tiled, with line breaks after the trailing comma of each row
+    const std::string rows = "\n1,2,3,\n4,5,6\n";
+    CHECK_EQ(tmx::csv_decode(rows.data(), rows.size(), out, 8, &used), 6u);
+    CHECK_EQ(used, rows.size());
+    CHECK_EQ(out[0], 1u);
+    CHECK_EQ(out[5], 6u);
+
+    //flip flags make for large values, and long runs of digits cross block boundaries
+    const std::string large = "3221225473," + std::string(70, '0') + "42";
+    CHECK_EQ(tmx::csv_decode(large.data(), large.size(), out, 8, &used), 2u);
+    CHECK_EQ(out[0], 3221225473u);
+    CHECK_EQ(out[1], 42u);
+
+    //parsing stops at the first value which doesn't fit, so it can be resumed
+    CHECK_EQ(tmx::csv_decode(rows.data(), rows.size(), out, 4, &used), 4u);
+    CHECK_EQ(tmx::csv_decode(rows.data() + used, rows.size() - used, out, 8, &used), 2u);
+    CHECK_EQ(out[0], 5u);
+
+    //malformed input reports where parsing stopped
+    const std::string invalid = "1,2,x,4";
+    CHECK_EQ(tmx::csv_decode(invalid.data(), invalid.size(), out, 8, &used), 2u);
+    CHECK_EQ(used, 4u);
+
+    const std::string empty = "1,,2";
+    CHECK_EQ(tmx::csv_decode(empty.data(), empty.size(), out, 8, &used), 1u);
+    CHECK_EQ(used, 2u);
+
+    const std::string overflow = "1,4294967296";
+    CHECK_EQ(tmx::csv_decode(overflow.data(), overflow.size(), out, 8, &used), 1u);
+    CHECK_EQ(used, 2u);
+}
+
+//loads a square map of the given size with the given layer data, returning the first layer's decode result
+int decodeLayer(const std::string& data, bool lazy = false, unsigned size = 2)
+{
+    const auto sizeString = std::to_string(size);
+    const std::string document = R"(<map version="1.10" orientation="orthogonal" renderorder="right-down" width=")" + sizeString + R"(" height=")" + sizeString
+        + R"(" tilewidth="16" tileheight="16" infinite="0">
+ <layer id="1" name="Tiles" width=")" + sizeString + R"(" height=")" + sizeString + R"(">)" + data + "</layer>\n</map>";
+
+    tmx::Map map;
+    map.setLazyDecoding(lazy);
+    if (!map.loadFromString(document, "maps"))
+    {
+        return -1;
+    }
+
+    const auto& layer = map.getLayers()[0]->getLayerAs<tmx::TileLayer>();
+    const auto result = layer.getDecodeResult();
+    if (result != tmx::TileLayer::DecodeResult::Success && !layer.getTiles().empty())
+    {
+        return -2;
+    }
+    return static_cast<int>(result);
+}
+
+void testDecodeResult()
+{
+    const auto Success = static_cast<int>(tmx::TileLayer::DecodeResult::Success);
+    const auto DataError = static_cast<int>(tmx::TileLayer::DecodeResult::DataError);
+    const auto SizeMismatch = static_cast<int>(tmx::TileLayer::DecodeResult::SizeMismatch);
+
+    CHECK_EQ(decodeLayer(R"(<data encoding="csv">1,2,3,4</data>)"), Success);
+    CHECK_EQ(decodeLayer(R"(<data encoding="csv">1,2,3</data>)"), SizeMismatch);
+    CHECK_EQ(decodeLayer(R"(<data encoding="csv">1,2,3,4,5</data>)"), SizeMismatch);
+    CHECK_EQ(decodeLayer(R"(<data encoding="csv">1,2,x,4</data>)"), DataError);
+    CHECK_EQ(decodeLayer(R"(<data encoding="csv">1,2,3</data>)", true), SizeMismatch);
+
+    //four little endian GIDs, and the same missing the last one
+    CHECK_EQ(decodeLayer(R"(<data encoding="base64">AQAAAAIAAAADAAAABAAAAA==</data>)"), Success);
+    CHECK_EQ(decodeLayer(R"(<data encoding="base64">AQAAAAIAAAADAAAA</data>)"), SizeMismatch);
+}
+
+void testCompressedLayers()
+{
+    //the same 64x64 tiles stored as CSV, and compressed with zlib and zstd.
+    //Each is larger than the blocks the data is streamed through
+    tmx::Map map;
+    CHECK_EQ(map.load("maps/compression.tmx"), true);
+    CHECK_EQ(map.getLayers().size(), 3u);
+
+    const auto& csvTiles = map.getLayers()[0]->getLayerAs<tmx::TileLayer>().getTiles();
+    const auto sameTiles = [&csvTiles](const tmx::Layer::Ptr& layer)
+    {
+        const auto& tiles = layer->getLayerAs<tmx::TileLayer>().getTiles();
+        return std::equal(csvTiles.begin(), csvTiles.end(), tiles.begin(), tiles.end(),
+            [](const tmx::TileLayer::Tile& a, const tmx::TileLayer::Tile& b) { return a.getID() == b.getID() && a.getFlipFlags() == b.getFlipFlags(); });
+    };
+    CHECK_EQ(csvTiles.size(), 4096u);
+    CHECK_EQ(sameTiles(map.getLayers()[1]), true);
+
+    //damaged copies of the compressed data
+    std::string document;
+    CHECK_EQ(tmx::readFileIntoString("maps/compression.tmx", &document), true);
+    const auto layerData = [&document](const std::string& compression)
+    {
+        const std::string dataStart = "<data encoding=\"base64\" compression=\"" + compression + "\">";
+        const auto start = document.find(dataStart) + dataStart.size();
+        const auto end = document.find("</data>", start);
+        auto data = document.substr(start, end - start);
+        data.erase(std::remove_if(data.begin(), data.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; }), data.end());
+        return data;
+    };
+    const std::string zlibData = layerData("zlib");
+
+    const auto zlibLayer = [](const std::string& data)
+    {
+        return "<data encoding=\"base64\" compression=\"zlib\">" + data + "</data>";
+    };
+
+    const auto Success = static_cast<int>(tmx::TileLayer::DecodeResult::Success);
+    const auto DataError = static_cast<int>(tmx::TileLayer::DecodeResult::DataError);
+    const auto SizeMismatch = static_cast<int>(tmx::TileLayer::DecodeResult::SizeMismatch);
+
+#if defined USE_ZSTD || defined USE_EXTLIBS
+    CHECK_EQ(map.getLayers()[2]->getLayerAs<tmx::TileLayer>().getDecodeResult() == tmx::TileLayer::DecodeResult::Success, true);
+    CHECK_EQ(sameTiles(map.getLayers()[2]), true);
+
+    const auto zstdData = layerData("zstd");
+    const auto zstdLayer = [](const std::string& data)
+    {
+        return "<data encoding=\"base64\" compression=\"zstd\">" + data + "</data>";
+    };
+    CHECK_EQ(decodeLayer(zstdLayer(zstdData.substr(0, (zstdData.size() / 8) * 4)), false, 64), DataError);
+    CHECK_EQ(decodeLayer(zstdLayer(zstdData), false, 32), SizeMismatch);
+    CHECK_EQ(decodeLayer(zstdLayer(zstdData), false, 65), SizeMismatch);
+#else
+    //zstd is only available when the library is built with USE_ZSTD or USE_EXTLIBS
+    CHECK_EQ(map.getLayers()[2]->getLayerAs<tmx::TileLayer>().getDecodeResult() == tmx::TileLayer::DecodeResult::DataError, true);
+    CHECK_EQ(map.getLayers()[2]->getLayerAs<tmx::TileLayer>().getTiles().empty(), true);
+#endif
+    CHECK_EQ(decodeLayer(zlibLayer(zlibData), false, 64), Success);
+
+    //stream ends part way through
+    CHECK_EQ(decodeLayer(zlibLayer(zlibData.substr(0, (zlibData.size() / 8) * 4)), false, 64), DataError);
+
+    //stream holds more tiles than the layer
+    CHECK_EQ(decodeLayer(zlibLayer(zlibData), false, 32), SizeMismatch);
+    CHECK_EQ(decodeLayer(zlibLayer(zlibData), true, 2), SizeMismatch);
+
+    //stream holds fewer tiles than the layer
+    CHECK_EQ(decodeLayer(zlibLayer(zlibData), false, 65), SizeMismatch);
+
+    //corrupt data part way through the stream
+    auto corrupt = zlibData;
+    std::fill(corrupt.begin() + corrupt.size() / 2, corrupt.begin() + corrupt.size() / 2 + 64, 'A');
+    CHECK_EQ(decodeLayer(zlibLayer(corrupt), false, 64), DataError);
+}
+
 }  // namespace
 
 int main()
@@ -279,8 +1704,52 @@ int main()
     std::cout << std::endl << "------------------------------" << std::endl << std::endl;
     testLoadTilesetWithoutMap();
     std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testMappedFile();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testBufferLoad();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testParallelLoad();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testLazyDecoding();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testMapReader();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testBinaryMap();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testMapCache();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testTilesetCache();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testTemplateCache();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testAsyncLoad();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testIncrementalLoader();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testAssetProvider();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testZipArchive();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testLayerFilter();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testRegionOfInterest();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testMapInfo();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testJsonMap();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testSaveMap();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
     testResolvingPaths();
     std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testBase64Decode();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testCSVDecode();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testDecodeResult();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
+    testCompressedLayers();
+    std::cout << std::endl << "------------------------------" << std::endl << std::endl;
 
 #if defined(PAUSE_AT_END)
     std::cout << std::endl << "Press return to quit..." <<std::endl;
@@ -76,11 +76,11 @@ bool MapLayer::create(const tmx::Map& map, std::uint32_t layerIndex, const std::
             for (auto x = 0u; x < mapSize.x; ++x)
             {
                 const auto idx = y * mapSize.x + x;
-                if (idx < tileIDs.size() && tileIDs[idx].ID >= ts.getFirstGID()
-                    && tileIDs[idx].ID < (ts.getFirstGID() + ts.getTileCount()))
+                if (idx < tileIDs.size() && tileIDs[idx].getID() >= ts.getFirstGID()
+                    && tileIDs[idx].getID() < (ts.getFirstGID() + ts.getTileCount()))
                 {
                     //tex coords
-                    auto idIndex = (tileIDs[idx].ID - ts.getFirstGID());
+                    auto idIndex = (tileIDs[idx].getID() - ts.getFirstGID());
                     float u = static_cast<float>(idIndex % tileCountX);
                     float v = static_cast<float>(idIndex / tileCountX);
                     u *= mapTileSize.x; //TODO we should be using the tile set size, as this may be different from the map's grid size
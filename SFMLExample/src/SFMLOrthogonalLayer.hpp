@@ -150,7 +150,7 @@ public:
                         animTime = 0;
                     }
 
-                    tile.ID = x->tileID;
+                    tile.setID(x->tileID);
                     animTime += x->duration;
                     x++;
                 }
@@ -244,13 +244,13 @@ private:
                 {
                     for (auto x = xPos; x < xPos + chunkTileCount.x; ++x)
                     {
-                        if (idx < m_chunkTileIDs.size() && m_chunkTileIDs[idx].ID >= ca->m_firstGID
-                            && m_chunkTileIDs[idx].ID <= ca->m_lastGID)
+                        if (idx < m_chunkTileIDs.size() && m_chunkTileIDs[idx].getID() >= ca->m_firstGID
+                            && m_chunkTileIDs[idx].getID() <= ca->m_lastGID)
                         {
-                            if (registerAnimation && m_animTiles.find(m_chunkTileIDs[idx].ID) != m_animTiles.end())
+                            if (registerAnimation && m_animTiles.find(m_chunkTileIDs[idx].getID()) != m_animTiles.end())
                             {
                                 AnimationState as;
-                                as.animTile = m_animTiles[m_chunkTileIDs[idx].ID];
+                                as.animTile = m_animTiles[m_chunkTileIDs[idx].getID()];
                                 as.startTime = sf::milliseconds(0);
                                 as.tileCords = sf::Vector2u(x,y);
                                 m_activeAnimations.push_back(as);
@@ -258,7 +258,7 @@ private:
 
                             sf::Vector2f tileOffset(static_cast<float>(x) * mapTileSize.x, static_cast<float>(y) * mapTileSize.y + mapTileSize.y - ca->tileSetSize.y);
 
-                            auto idIndex = m_chunkTileIDs[idx].ID - ca->m_firstGID;
+                            auto idIndex = m_chunkTileIDs[idx].getID() - ca->m_firstGID;
                             sf::Vector2f tileIndex(sf::Vector2i(idIndex % ca->tsTileCount.x, idIndex / ca->tsTileCount.x));
                             tileIndex.x *= ca->tileSetSize.x;
                             tileIndex.y *= ca->tileSetSize.y;
@@ -271,7 +271,7 @@ private:
                                 sf::Vertex(tileOffset - getPosition() + sf::Vector2f(sf::Vector2u(ca->tileSetSize.x, ca->tileSetSize.y)), m_chunkColors[idx], tileIndex + sf::Vector2f(sf::Vector2u(ca->tileSetSize.x, ca->tileSetSize.y))),
                                 sf::Vertex(tileOffset - getPosition() + sf::Vector2f(0.f,static_cast<float>(ca->tileSetSize.y)), m_chunkColors[idx], tileIndex + sf::Vector2f(0.f, static_cast<float>(ca->tileSetSize.y)))
                             };
-                            doFlips(m_chunkTileIDs[idx].flipFlags,&tile[0].texCoords,&tile[1].texCoords,&tile[2].texCoords,&tile[3].texCoords,&tile[4].texCoords,&tile[5].texCoords);
+                            doFlips(m_chunkTileIDs[idx].getFlipFlags(),&tile[0].texCoords,&tile[1].texCoords,&tile[2].texCoords,&tile[3].texCoords,&tile[4].texCoords,&tile[5].texCoords);
                             ca->addTile(tile);
                         }
                         idx++;
@@ -542,7 +542,7 @@ private:
         {
             for (const auto& tile : layerIDs)
             {
-                if (tile.ID >= i->getFirstGID() && tile.ID < maxID)
+                if (tile.getID() >= i->getFirstGID() && tile.getID() < maxID)
                 {
                     usedTileSets.push_back(&(*i));
                     break;
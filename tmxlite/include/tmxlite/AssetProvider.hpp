@@ -0,0 +1,164 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/MappedFile.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace tmx
+{
+    /*!
+    \brief Holds the contents of a file returned by an AssetProvider.
+    The contents may be a mapped file, a string owned by the buffer,
+    or memory borrowed from elsewhere such as an archive already
+    loaded by the application. Borrowed memory is never modified -
+    if a parser needs to write to the buffer it is copied first.
+    */
+    class TMXLITE_EXPORT_API AssetBuffer final
+    {
+    public:
+        AssetBuffer() = default;
+
+        AssetBuffer(const AssetBuffer&) = delete;
+        AssetBuffer& operator = (const AssetBuffer&) = delete;
+        AssetBuffer(AssetBuffer&&) = default;
+        AssetBuffer& operator = (AssetBuffer&&) = default;
+
+        /*!
+        \brief Takes ownership of a mapped file
+        */
+        void setMappedFile(MappedFile&& file);
+
+        /*!
+        \brief Takes ownership of the given string
+        */
+        void setString(std::string&& data);
+
+        /*!
+        \brief Borrows the given memory without copying it.
+        \param data Pointer to the file contents
+        \param size Size of the contents in bytes
+        \param owner Optional pointer to an object which owns the memory.
+        The buffer keeps the owner alive for as long as the data is used,
+        else the memory must outlive the buffer.
+        */
+        void setBorrowed(const char* data, std::size_t size, std::shared_ptr<const void> owner = nullptr);
+
+        /*!
+        \brief Releases the contents of the buffer
+        */
+        void clear();
+
+        /*!
+        \brief Returns a pointer to the contents of the buffer, or nullptr
+        if it is empty. The contents are not null terminated.
+        */
+        const char* data() const;
+
+        /*!
+        \brief Returns a pointer to the contents of the buffer which may
+        be modified. Borrowed memory is copied into the buffer the first
+        time this is called.
+        */
+        char* getMutableData();
+
+        /*!
+        \brief Returns the size of the contents in bytes
+        */
+        std::size_t size() const;
+
+    private:
+        enum class Storage
+        {
+            None, Mapped, String, Borrowed
+        };
+
+        Storage m_storage = Storage::None;
+        MappedFile m_file;
+        std::string m_string;
+        const char* m_borrowed = nullptr;
+        std::size_t m_borrowedSize = 0;
+        std::shared_ptr<const void> m_owner;
+    };
+
+    /*!
+    \brief Interface used to read all of the files referred to while
+    loading, such as maps, tile sets, templates and object types.
+    By default files are read from disk, but a custom provider can be
+    set on a Map, Tileset, ObjectTypes, MapReader or IncrementalLoader
+    to read them from any other source, for example a packed archive.
+    Paths passed to the provider are those resolved relative to the
+    file which referred to them, using forward slashes as separators.
+    Providers may be called from several threads at once if a map
+    is loaded with an Executor, or maps are loaded concurrently.
+    */
+    class TMXLITE_EXPORT_API AssetProvider
+    {
+    public:
+        virtual ~AssetProvider() = default;
+
+        /*!
+        \brief Reads the file at the given path into the given buffer.
+        \returns true on success, else false
+        */
+        virtual bool open(const std::string& path, AssetBuffer& buffer) = 0;
+
+        /*!
+        \brief Used by the TilesetCache and TemplateCache to find out if a
+        file has changed since it was cached. Both values should change
+        when the contents of the file do.
+        \returns true if the information is available, else false. Files
+        for which this returns false are never cached. The default
+        implementation returns false.
+        */
+        virtual bool getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize);
+
+        /*!
+        \brief Returns the provider used when none has been set, which
+        reads files from disk.
+        */
+        static AssetProvider& getDefault();
+    };
+
+    /*!
+    \brief Reads files from disk. Files are mapped where possible so that
+    they can be parsed in place, else they are read into memory.
+    This is the default AssetProvider.
+    */
+    class TMXLITE_EXPORT_API FileSystemProvider final : public AssetProvider
+    {
+    public:
+        bool open(const std::string& path, AssetBuffer& buffer) override;
+        bool getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize) override;
+    };
+}
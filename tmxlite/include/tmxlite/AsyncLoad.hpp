@@ -0,0 +1,146 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace tmx
+{
+    class Map;
+
+    /*!
+    \brief Handle to a map being loaded in the background, returned by
+    Map::loadAsync().
+    The map must not be used until loading has finished, that is until
+    isReady() returns true or wait() or get() have returned. Progress
+    can be queried at any time, and loading may be cancelled. Destroying
+    the handle cancels any load still in progress and waits for it to stop.
+    */
+    class TMXLITE_EXPORT_API AsyncLoad final
+    {
+    public:
+        /*!
+        \brief Describes how much of a map has been loaded
+        */
+        struct Progress final
+        {
+            std::size_t bytesParsed = 0; //!< bytes of the map file parsed so far
+            std::size_t totalBytes = 0; //!< size of the map file, once it has been read
+            std::size_t layersLoaded = 0; //!< layers, including those in groups, finished so far
+            std::size_t totalLayers = 0; //!< number of layers in the map, once it has been parsed
+        };
+
+        /*!
+        \brief Function called each time loading progresses.
+        This is called on the loading threads, although never
+        concurrently, and should return quickly.
+        */
+        using ProgressCallback = std::function<void(const Progress&)>;
+
+        AsyncLoad() = default;
+        ~AsyncLoad();
+
+        AsyncLoad(const AsyncLoad&) = delete;
+        AsyncLoad& operator = (const AsyncLoad&) = delete;
+        AsyncLoad(AsyncLoad&&) noexcept = default;
+        AsyncLoad& operator = (AsyncLoad&&) noexcept;
+
+        /*!
+        \brief Returns true if this handle refers to a load
+        */
+        bool isValid() const { return m_state != nullptr; }
+
+        /*!
+        \brief Returns true once loading has finished, whether
+        it succeeded, failed or was cancelled
+        */
+        bool isReady() const;
+
+        /*!
+        \brief Blocks until loading has finished
+        */
+        void wait();
+
+        /*!
+        \brief Waits for loading to finish and returns the result
+        \returns true if the map was loaded, or false if loading failed
+        or was cancelled, in which case the map is left empty
+        */
+        bool get();
+
+        /*!
+        \brief Requests that loading stop. Loading is cancelled
+        cooperatively, between layers and between chunks of infinite
+        maps, so may not stop immediately.
+        */
+        void cancel();
+
+        /*!
+        \brief Returns true if cancel() has been called
+        */
+        bool isCancelled() const;
+
+        /*!
+        \brief Returns the current progress of the load
+        */
+        Progress getProgress() const;
+
+    private:
+        friend class Map;
+
+        struct State final
+        {
+            explicit State(ProgressCallback cb) : callback(std::move(cb)) {}
+
+            std::atomic<bool> cancelled = { false };
+            std::atomic<bool> finished = { false };
+            bool result = false;
+
+            std::atomic<std::size_t> bytesParsed = { 0 };
+            std::atomic<std::size_t> totalBytes = { 0 };
+            std::atomic<std::size_t> layersLoaded = { 0 };
+            std::atomic<std::size_t> totalLayers = { 0 };
+
+            ProgressCallback callback;
+            std::mutex callbackMutex;
+
+            Progress getProgress() const;
+            void report();
+        };
+
+        std::shared_ptr<State> m_state;
+        std::thread m_thread;
+    };
+}
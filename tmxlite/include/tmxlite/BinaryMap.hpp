@@ -0,0 +1,101 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    class Map;
+
+    /*!
+    \brief Reads and writes maps in tmxlite's binary format (*.tmxb).
+    The binary format stores a fully parsed Map - its tilesets, layers,
+    objects and properties, with tile data stored as packed global IDs -
+    so that it can be loaded without any XML, base64 or compression being
+    decoded. Shipping builds can convert their maps with write() ahead of
+    time, while editors continue to use *.tmx files.
+    Map::load() recognises binary files automatically, and maps them into
+    memory rather than reading them.
+    The format is versioned and checksummed, and files written by a
+    different version of the format, or which are corrupt, fail to load.
+    Paths to images and other resources are stored as they were resolved
+    when the map was written.
+    */
+    class TMXLITE_EXPORT_API BinaryMap final
+    {
+    public:
+        /*!
+        \brief Version of the binary format written by this version of tmxlite.
+        Files must match this version to be loaded.
+        */
+        static constexpr std::uint32_t FormatVersion = 2;
+
+        /*!
+        \brief Writes the given map to a file in the binary format
+        \param map The map to write. Any tile layers which have not yet been
+        decoded are decoded first.
+        \param path Path of the file to write
+        \returns true on success, else false
+        */
+        static bool write(const Map& map, const std::string& path);
+
+        /*!
+        \brief Writes the given map in the binary format to a buffer
+        \param map The map to write
+        \param destination Buffer to which the data is written. Any existing
+        contents are replaced.
+        */
+        static void write(const Map& map, std::vector<char>& destination);
+
+        /*!
+        \brief Loads a map from binary data in memory, replacing
+        any map already loaded.
+        \param map The map into which to load the data
+        \param data Pointer to the binary data
+        \param size Size of the data in bytes
+        \param workingDir The working directory of the map
+        \returns true on success, else false
+        */
+        static bool read(Map& map, const char* data, std::size_t size, const std::string& workingDir);
+
+        /*!
+        \brief Returns true if the given data starts with the
+        header of a binary map, of any version
+        */
+        static bool isBinaryMap(const char* data, std::size_t size);
+
+    private:
+        class Serialiser;
+    };
+}
@@ -0,0 +1,128 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+namespace tmx
+{
+    /*!
+    \brief Interface used by the library to run parallel work.
+    By default everything is loaded on the calling thread. Implement
+    this interface to have parallel work, such as parsing the layers
+    of a Map, run on an existing job system, or use the ThreadPool
+    which ships with the library.
+    \see Map::setExecutor(), Tileset::setExecutor(), ThreadPool
+    */
+    class TMXLITE_EXPORT_API Executor
+    {
+    public:
+        using Task = std::function<void()>;
+
+        virtual ~Executor() = default;
+
+        /*!
+        \brief Queues a task to be run.
+        Tasks may be run on any thread, in any order, including
+        immediately on the calling thread. Tasks submitted by the
+        library never throw.
+        */
+        virtual void submit(Task task) = 0;
+
+        /*!
+        \brief Blocks the calling thread until done() returns true.
+        done() becomes true once tasks previously submitted by the
+        calling thread have completed. It is safe to call from any
+        thread, and cheap enough to poll.
+        Note that wait() may itself be called from within a task, so
+        implementations with a fixed number of threads should run other
+        queued tasks while waiting rather than simply blocking, else
+        all of the threads may end up waiting on tasks which never run.
+        */
+        virtual void wait(const std::function<bool()>& done) = 0;
+    };
+
+    /*!
+    \brief Executor which runs every task immediately on the calling
+    thread, exactly as if no executor were used at all.
+    */
+    class TMXLITE_EXPORT_API SerialExecutor final : public Executor
+    {
+    public:
+        void submit(Task task) override { task(); }
+        void wait(const std::function<bool()>&) override {}
+    };
+
+    /*!
+    \brief Runs a set of related tasks on an Executor and waits for
+    them all to complete.
+    Any exception thrown by a task is caught and the first one is
+    rethrown from wait(). If the executor is nullptr tasks are instead
+    run immediately on the calling thread, and exceptions propagate
+    straight out of run().
+    */
+    class TMXLITE_EXPORT_API TaskGroup final
+    {
+    public:
+        explicit TaskGroup(Executor* executor);
+
+        /*!
+        \brief Waits for any outstanding tasks, discarding any exceptions
+        */
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator = (const TaskGroup&) = delete;
+
+        /*!
+        \brief Submits a task to the group's executor
+        */
+        void run(Executor::Task task);
+
+        /*!
+        \brief Waits for all the tasks submitted so far to complete,
+        then rethrows the first exception thrown by any of them.
+        */
+        void wait();
+
+    private:
+        Executor* m_executor;
+        std::atomic<std::size_t> m_pending;
+
+        std::mutex m_mutex;
+        std::exception_ptr m_exception;
+
+        void waitForTasks();
+    };
+}
@@ -25,30 +25,6 @@ and must not be misrepresented as being the original software.
 source distribution.
 *********************************************************************/
 
-/*********************************************************************
-base64_decode
-
-Copyright (C) 2004-2008 René Nyffenegger
-This source code is provided 'as-is', without any express or implied
-warranty. In no event will the author be held liable for any damages
-arising from the use of this software.
-
-Permission is granted to anyone to use this software for any purpose,
-including commercial applications, and to alter it and redistribute it
-freely, subject to the following restrictions:
-
-1. The origin of this source code must not be misrepresented; you must not
-claim that you wrote the original source code. If you use this source code
-in a product, an acknowledgment in the product documentation would be
-appreciated but is not required.
-
-2. Altered source versions must be plainly marked as such, and must not be
-misrepresented as being the original source code.
-3. This notice may not be removed or altered from any source distribution.
-
-René Nyffenegger rene.nyffenegger@adp-gmbh.ch
-*********************************************************************/
-
 #pragma once
 
 #include <tmxlite/detail/Android.hpp>
@@ -67,71 +43,65 @@ namespace tmx
     //using inline here just to supress unused warnings on gcc (TODO: can say "(void)x" instead)
     bool decompress(const char* source, std::vector<unsigned char>& dest, std::size_t inSize, std::size_t expectedSize);
 
-    static inline std::string base64_decode(std::string const& encoded_string)
-    {
-        static const std::string base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-            "abcdefghijklmnopqrstuvwxyz"
-            "0123456789+/";            
-            
-        std::function<bool(unsigned char)> is_base64 = 
-            [](unsigned char c)->bool
-        {
-            return (isalnum(c) || (c == '+') || (c == '/'));
-        };
-
-        auto in_len = encoded_string.size();
-        int i = 0;
-        int j = 0;
-        int in_ = 0;
-        unsigned char char_array_4[4], char_array_3[3];
-        std::string ret;
-
-        while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_]))
-        {
-            char_array_4[i++] = encoded_string[in_]; in_++;
-            if (i == 4)
-            {
-                for (i = 0; i < 4; i++)
-                {
-                    char_array_4[i] = static_cast<unsigned char>(base64_chars.find(char_array_4[i]));
-                }
-                char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-                char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-                char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-                for (i = 0; (i < 3); i++)
-                {
-                    ret += char_array_3[i];
-                }
-                i = 0;
-            }
-        }
-
-        if (i)
-        {
-            for (j = i; j < 4; j++)
-            {
-                char_array_4[j] = 0;
-            }
+    /*!
+    \brief Decodes base64 encoded data into the given buffer.
+    Whitespace in the input is skipped, and decoding stops at the
+    first padding or non-base64 character, or when the output buffer
+    is full. A fully decoded input requires at most (srcLen / 4) * 3 bytes.
+    \param src Pointer to the encoded characters
+    \param srcLen Number of characters in src
+    \param dst Buffer to write the decoded bytes to
+    \param dstSize Size of the destination buffer in bytes
+    \param srcUsed If this is not null then decoding stops before any group
+    of four characters which won't entirely fit in dst, and srcUsed receives the
+    number of characters consumed. This allows large inputs to be decoded a block
+    at a time by calling the function again from src + srcUsed, until it returns 0.
+    \returns the number of bytes written to dst
+    */
+    std::size_t base64_decode(const char* src, std::size_t srcLen, unsigned char* dst, std::size_t dstSize, std::size_t* srcUsed = nullptr);
 
-            for (j = 0; j < 4; j++)
-            {
-                char_array_4[j] = static_cast<unsigned char>(base64_chars.find(char_array_4[j]));
-            }
+    /*!
+    \brief Decodes the given base64 encoded string.
+    \see base64_decode(const char*, std::size_t, unsigned char*, std::size_t, std::size_t*)
+    */
+    std::string base64_decode(std::string const& encoded_string);
 
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+    /*!
+    \brief Encodes data as base64, padded and without line breaks.
+    \param src Pointer to the data to encode
+    \param srcLen Size of the data in bytes
+    \param dst Buffer to write the encoded characters to, which must have
+    room for ((srcLen + 2) / 3) * 4 characters. No null terminator is written.
+    \returns the number of characters written to dst
+    */
+    std::size_t base64_encode(const unsigned char* src, std::size_t srcLen, char* dst);
 
-            for (j = 0; (j < i - 1); j++)
-            {
-                ret += char_array_3[j];
-            }
-        }
+    /*!
+    \brief Returns the base64 encoding of the given string.
+    \see base64_encode(const unsigned char*, std::size_t, char*)
+    */
+    std::string base64_encode(const std::string& data);
 
-        return ret;
-    }
+    /*!
+    \brief Parses comma separated unsigned integer values, such as
+    layer data using the CSV encoding, into the given buffer.
+    Whitespace between values is skipped. Parsing stops at the end of
+    the input, when the output buffer is full, or at the first character
+    which does not form part of a valid list of values: anything other than
+    digits, commas or whitespace, an empty value or a value which doesn't
+    fit in 32 bits.
+    \param src Pointer to the characters to parse
+    \param srcLen Number of characters in src
+    \param dst Buffer to write the values to
+    \param dstCount Number of values which fit in dst
+    \param srcUsed If this is not null it receives the number of characters
+    consumed. This equals srcLen only when the entire input was valid and
+    parsed, otherwise it is the offset of the offending character, or of
+    the first value which didn't fit in dst. Parsing can be resumed from
+    src + srcUsed in the latter case.
+    \returns the number of values written to dst
+    */
+    std::size_t csv_decode(const char* src, std::size_t srcLen, std::uint32_t* dst, std::size_t dstCount, std::size_t* srcUsed = nullptr);
 
     static inline Colour colourFromString(std::string str)
     {
@@ -223,4 +193,19 @@ namespace tmx
     \brief Appends the contents of a file into the given string.
     */
     bool readFileIntoString(const std::string& path, std::string* out);
+
+    /*!
+    \brief Returns a 64 bit hash of the given data, optionally combined
+    with a seed such as the hash of some other data.
+    This is fast rather than cryptographically secure, and is used to
+    detect when the contents of files have changed.
+    */
+    std::uint64_t hashData(const char* data, std::size_t size, std::uint64_t seed = 0);
+
+    /*!
+    \brief Retrieves the last modification time, in seconds, and the size
+    in bytes of the file at the given path.
+    \returns false if the file does not exist or cannot be queried
+    */
+    bool getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize);
 } //namespacec tmx
\ No newline at end of file
@@ -87,6 +87,9 @@ namespace tmx
         bool locked() const {return m_locked;}
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+
         std::string m_workingDir;
         std::string m_filePath;
         Colour m_transparencyColour;
@@ -0,0 +1,130 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Map.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    class LayerGroup;
+    class MemoryStream;
+    class XmlStream;
+
+    /*!
+    \brief Loads a map a piece at a time, so that loading can be spread
+    over many frames on platforms which cannot load on another thread.
+    Each call to step() parses tile sets, layers and other elements of
+    the map until the given budget has been used. Elements are parsed
+    whole, so a step overruns its budget by at most the time taken to
+    parse the largest single element. Enabling lazy decoding on the
+    map moves the cost of decoding tile data out of the load entirely.
+    Layer groups are parsed one child at a time.
+    Only tmx files are supported. To load a binary map use Map::load().
+    \see Map::setLazyDecoding()
+    */
+    class TMXLITE_EXPORT_API IncrementalLoader final
+    {
+    public:
+        enum class Status
+        {
+            InProgress,
+            Done,
+            Failed
+        };
+
+        /*!
+        \brief Constructor.
+        \param path Path to the map file to load. The file is not
+        opened until the first call to step()
+        */
+        explicit IncrementalLoader(const std::string& path);
+        ~IncrementalLoader();
+
+        IncrementalLoader(const IncrementalLoader&) = delete;
+        IncrementalLoader& operator = (const IncrementalLoader&) = delete;
+
+        /*!
+        \brief Parses the map until the given time has passed, or the
+        map has been loaded. At least one element is parsed by each call.
+        \returns The status of the load once the step has finished
+        */
+        Status step(std::chrono::microseconds budget);
+
+        /*!
+        \brief Parses the map until at least the given number of bytes
+        of the map file have been read, or the map has been loaded.
+        At least one element is parsed by each call.
+        \returns The status of the load once the step has finished
+        */
+        Status step(std::size_t byteBudget);
+
+        /*!
+        \brief Returns the current status of the load
+        */
+        Status getStatus() const { return m_status; }
+
+        /*!
+        \brief Returns the number of bytes of the map file parsed so far
+        */
+        std::size_t getBytesRead() const { return m_bytesRead; }
+
+        /*!
+        \brief Returns the map being loaded. Settings such as the map's
+        Executor, TilesetCache or AssetProvider may be changed before the
+        first call to step(). The map is incomplete until getStatus() returns Done,
+        and is empty if loading fails.
+        */
+        Map& getMap() { return m_map; }
+        const Map& getMap() const { return m_map; }
+
+    private:
+        std::string m_path;
+        Map m_map;
+        Status m_status;
+        std::size_t m_bytesRead;
+
+        AssetBuffer m_file;
+        std::unique_ptr<MemoryStream> m_stream;
+        std::unique_ptr<XmlStream> m_xml;
+
+        //groups which have been started but not yet ended
+        std::vector<LayerGroup*> m_groups;
+
+        void parseNext();
+        void begin();
+        void fail();
+        void close();
+    };
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tmx
+{
+    class Map;
+    class Object;
+    class Tileset;
+
+    /*!
+    \brief Reads maps, tile sets and object templates saved in Tiled's
+    JSON format (*.tmj, *.tsj and *.tj) into the same classes as those
+    loaded from XML.
+    Map::load(), Tileset::loadWithoutMap() and the templates used by
+    objects all recognise JSON documents automatically, whatever their
+    file extension, so a map may freely refer to files of either format.
+    Documents are parsed in place, without an allocation for each value,
+    and tile data stored as arrays is decoded straight into the layer's
+    tiles by the same decoder used for CSV data. The map's settings,
+    such as its executor, caches, layer filter and regions of interest,
+    apply to JSON maps just as they do to XML maps.
+    \see https://doc.mapeditor.org/en/stable/reference/json-map-format/
+    */
+    class TMXLITE_EXPORT_API JsonMap final
+    {
+    public:
+        /*!
+        \brief Loads a map from a JSON document in memory, replacing
+        any map already loaded.
+        \param map The map into which to load the document
+        \param data Pointer to the document. This is parsed in place, so
+        its contents should be considered undefined once this returns.
+        It does not need to be null terminated.
+        \param size Size of the document in bytes
+        \param workingDir The working directory of the map
+        \returns true on success, else false
+        */
+        static bool read(Map& map, char* data, std::size_t size, const std::string& workingDir);
+
+        /*!
+        \brief Loads a tile set from a JSON document in memory.
+        Any relative paths are resolved against the tile set's working
+        directory. This does not set the first GID.
+        \param tileset The tile set into which to load the document
+        \param data Pointer to the document, which is parsed in place
+        \param size Size of the document in bytes
+        \returns true on success, else false
+        */
+        static bool read(Tileset& tileset, char* data, std::size_t size);
+
+        /*!
+        \brief Returns true if the given data looks like a JSON document,
+        that is its first character other than whitespace is '{'
+        */
+        static bool isJson(const char* data, std::size_t size);
+
+    private:
+        friend class TemplateCache;
+
+        class Parser;
+
+        //reads the object of a template, along with the source and first GID of its tile set, if it has one
+        static bool readTemplate(char* data, std::size_t size, const std::string& path, Object& object, std::string& tilesetSource, std::uint32_t& firstGID);
+    };
+}
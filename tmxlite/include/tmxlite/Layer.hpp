@@ -60,6 +60,11 @@ namespace tmx
         Layer() : m_opacity(1.f), m_visible(true) {};
         virtual ~Layer() = default;
 
+        Layer(const Layer&) = default;
+        Layer(Layer&&) = default;
+        Layer& operator = (const Layer&) = default;
+        Layer& operator = (Layer&&) = default;
+
         /*!
         \brief Layer type as returned by getType()
         Tile: this layer is a TileLayer type
@@ -148,8 +153,11 @@ namespace tmx
         */
         const std::vector<Property>& getProperties() const { return m_properties; }
 
-    protected:
-
+        /*!
+        \brief Setters for the layer attributes. These are filled in when
+        the layer is loaded, and may be used to build or modify a layer
+        in memory before saving the map with Map::save()
+        */
         void setName(const std::string& name) { m_name = name; }
         void setClass(const std::string& cls) { m_class = cls; }
         void setOpacity(float opacity) { m_opacity = opacity; }
@@ -158,9 +166,14 @@ namespace tmx
         void setParallaxFactor(float x, float y) { m_parallaxFactor.x = x; m_parallaxFactor.y = y; }
         void setTintColour(Colour c) { m_tintColour = c; }
         void setSize(std::uint32_t width, std::uint32_t height) { m_size = Vector2u(width, height); }
+
+    protected:
         void addProperty(const pugi::xml_node& node) { m_properties.emplace_back(); m_properties.back().parse(node); }
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+
         std::string m_name;
         std::string m_class;
         float m_opacity;
@@ -63,6 +63,10 @@ namespace tmx
         const std::vector<Layer::Ptr>& getLayers() const { return m_layers; }
 
     private:
+        friend class BinaryMap;
+        friend class IncrementalLoader;
+        friend class JsonMap;
+        friend class Map;
 
         std::vector<Layer::Ptr> m_layers;
 
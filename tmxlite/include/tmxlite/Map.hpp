@@ -27,12 +27,20 @@ source distribution.
 
 #pragma once
 
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/AsyncLoad.hpp>
 #include <tmxlite/Tileset.hpp>
 #include <tmxlite/Layer.hpp>
 #include <tmxlite/Property.hpp>
 #include <tmxlite/Types.hpp>
 #include <tmxlite/Object.hpp>
+#include <tmxlite/TemplateCache.hpp>
+#include <tmxlite/ThreadPool.hpp>
+#include <tmxlite/TilesetCache.hpp>
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <map>
@@ -80,6 +88,29 @@ namespace tmx
         Even, Odd, None
     };
 
+    /*!
+    \brief Settings used when saving a map with Map::save()
+    */
+    struct TMXLITE_EXPORT_API SaveSettings final
+    {
+        /*!
+        \brief Encodings which may be used for tile layer data
+        */
+        enum class Encoding
+        {
+            CSV,
+            Base64,
+            Base64Zlib,
+            Base64Zstd //!< requires the library to be built with USE_ZSTD or USE_EXTLIBS
+        }encoding = Encoding::CSV;
+
+        /*!
+        \brief Compression level used by the zlib and zstd encodings,
+        or 0 to use the default level of the compressor
+        */
+        int compressionLevel = 0;
+    };
+
     /*!
     \brief Parser for TMX format tile maps.
     This class can be used to parse the XML format tile maps created
@@ -88,12 +119,33 @@ namespace tmx
     class before calling load() providing a path to the *.tmx file to be
     loaded. Then layers or objects can be requested from the Map class
     to be interpreted as needed.
+    Maps saved in Tiled's JSON format (*.tmj) are recognised and loaded
+    in the same way.
     \see https://doc.mapeditor.org/en/stable/reference/tmx-map-format/#map
     */
     class TMXLITE_EXPORT_API Map final
     {
     public:
-            
+        /*!
+        \brief Describes a layer to a LayerFilter, before the
+        layer itself is parsed.
+        */
+        struct LayerInfo final
+        {
+            std::string name;
+            std::string className;
+            Layer::Type type = Layer::Type::Tile;
+            //names of the groups containing the layer, outermost first and
+            //separated by '/'. Empty for layers at the top level of the map
+            std::string groupPath;
+        };
+
+        /*!
+        \brief Returns true if the described layer should be loaded
+        \see setLayerFilter()
+        */
+        using LayerFilter = std::function<bool(const LayerInfo&)>;
+
         Map();
         ~Map() = default;
         Map(const Map&) = delete;
@@ -103,7 +155,8 @@ namespace tmx
 
         /*!
         \brief Attempts to parse the tilemap at the given location.
-        \param std::string Path to map file to try to parse
+        \param std::string Path to map file to try to parse, which may be
+        a *.tmx, *.tmj or binary (*.tmxb) map
         \returns true if map was parsed successfully else returns false.
         In debug mode this will attempt to log any errors to the console.
         */
@@ -118,6 +171,253 @@ namespace tmx
         */
         bool loadFromString(const std::string& data, const std::string& workingDir);
 
+        /*!
+        \brief Loads a map from a document stored in a string, parsing
+        the string in place rather than copying it.
+        \param data A std::string containing the map data to load. The
+        contents of the string are modified while parsing.
+        \param workingDir A std::string containing the working directory
+        in which to find assets such as tile sets or images
+        \returns true if successful, else false
+        \see loadFromBuffer()
+        */
+        bool loadFromString(std::string&& data, const std::string& workingDir);
+
+        /*!
+        \brief Loads a map from an XML or JSON document stored in a mutable buffer.
+        The buffer is parsed in place so that no copy of the document
+        is made. The buffer remains owned by the caller, and only needs
+        to exist for the duration of this call. Its contents should be
+        considered undefined once the function returns.
+        \param data Pointer to the map data to load. This does not need
+        to be null terminated.
+        \param size Size of the buffer in bytes
+        \param workingDir A std::string containing the working directory
+        in which to find assets such as tile sets or images
+        \returns true if successful, else false
+        */
+        bool loadFromBuffer(char* data, std::size_t size, const std::string& workingDir);
+
+        /*!
+        \brief Starts loading the map at the given path on a background
+        thread, using load() along with all of this map's settings.
+        The map must not be used, moved or destroyed until loading has
+        finished, and the returned handle should be used to wait for
+        the result.
+        \param path Path to the map file to load
+        \param callback Optional function called each time loading progresses
+        \returns AsyncLoad handle which can be used to query progress, cancel
+        the load or wait for the result
+        \see AsyncLoad
+        */
+        AsyncLoad loadAsync(const std::string& path, AsyncLoad::ProgressCallback callback = {});
+
+        /*!
+        \brief Writes the map to a *.tmx file.
+        Tile sets which were loaded from their own file are written as
+        references to that file, with paths made relative to the directory
+        of the saved map, while embedded tile sets are written in full.
+        Tile layers are encoded as independent tasks on the map's Executor,
+        if it has one. Objects created from templates are written with
+        the template applied, rather than as a reference to the template.
+        \param path Path of the file to write
+        \param settings SaveSettings describing how tile data is encoded
+        \returns true on success, else false
+        \see Tileset::save()
+        */
+        bool save(const std::string& path, const SaveSettings& settings = {}) const;
+
+        /*!
+        \brief Writes the map as a *.tmx document to a string
+        \param destination String to which the document is written. Any
+        existing contents are replaced.
+        \param workingDir Directory to which paths in the document are made
+        relative, usually the directory the document will be saved in
+        \param settings SaveSettings describing how tile data is encoded
+        \returns true on success, else false
+        */
+        bool saveToString(std::string& destination, const std::string& workingDir, const SaveSettings& settings = {}) const;
+
+        /*!
+        \brief Sets the Executor used to run parallel work when loading a map.
+        Tilesets, tile layers, object groups and layer groups are parsed as
+        independent tasks on the executor, and the results stored in document
+        order. The executor must outlive any calls to load() or decodeAll()
+        made while it is set, and may be shared between maps.
+        \param executor Pointer to the executor to use, or nullptr to load
+        everything on the calling thread (the default)
+        \see Executor
+        */
+        void setExecutor(Executor* executor);
+
+        /*!
+        \brief Returns the Executor used when loading, or nullptr
+        if maps are loaded on the calling thread.
+        */
+        Executor* getExecutor() const { return m_executor; }
+
+        /*!
+        \brief Convenience function which creates a ThreadPool owned by
+        this map, and uses it as the map's Executor.
+        \param count The number of threads to use. 0 uses one thread per
+        hardware thread available, and 1 disables parallel loading,
+        destroying any pool previously created.
+        \see setExecutor()
+        */
+        void setThreadCount(std::size_t count);
+
+        /*!
+        \brief Returns the number of threads in the pool created by
+        setThreadCount(), or 1 if there is none.
+        */
+        std::size_t getThreadCount() const { return m_threadPool ? m_threadPool->getThreadCount() : 1; }
+
+        /*!
+        \brief Sets a TilesetCache used to load the external tile sets
+        referred to by the map, including those used by templates.
+        Maps which share a cache parse each tile set file only once, and
+        share a single copy of its data in memory. The cache must outlive
+        any calls to load() made while it is set.
+        \param cache Pointer to the cache to use, or nullptr to load tile
+        sets for each map separately (the default)
+        \see TilesetCache
+        */
+        void setTilesetCache(TilesetCache* cache) { m_tilesetCache = cache; }
+
+        /*!
+        \brief Returns the TilesetCache used when loading, or nullptr
+        if tile sets are loaded separately for each map.
+        */
+        TilesetCache* getTilesetCache() const { return m_tilesetCache; }
+
+        /*!
+        \brief Sets a TemplateCache used to load the object templates
+        referred to by the map. Maps which share a cache parse each
+        template file only once. The cache must outlive any calls to
+        load() made while it is set.
+        \param cache Pointer to the cache to use, or nullptr to load
+        templates for each map separately (the default)
+        \see TemplateCache
+        */
+        void setTemplateCache(TemplateCache* cache) { m_templateCache = cache; }
+
+        /*!
+        \brief Returns the TemplateCache used when loading, or nullptr
+        if templates are loaded separately for each map.
+        */
+        TemplateCache* getTemplateCache() const { return m_templateCache; }
+
+        /*!
+        \brief Sets the AssetProvider used to read the map file, and all
+        of the files it refers to such as tile sets and templates. The
+        provider must outlive any calls to load() made while it is set.
+        Tile set and template caches identify files by their path, so a
+        cache should only be shared between maps using the same provider.
+        Files written to the cache directory are always read from disk.
+        \param provider Pointer to the provider to use, or nullptr to read
+        files from disk (the default)
+        \see AssetProvider
+        */
+        void setAssetProvider(AssetProvider* provider) { m_assetProvider = provider; }
+
+        /*!
+        \brief Returns the AssetProvider used when loading, or nullptr
+        if files are read from disk.
+        */
+        AssetProvider* getAssetProvider() const { return m_assetProvider; }
+
+        /*!
+        \brief Enables or disables lazy decoding of tile layer data.
+        When enabled, the base64 or CSV encoded data of each tile layer is
+        stored as it is when the map is loaded, and only decoded the first
+        time TileLayer::getTiles() or TileLayer::getChunks() is called.
+        This saves load time and memory for layers which are rarely or
+        never used. Disabled by default.
+        \see decodeAll()
+        */
+        void setLazyDecoding(bool enabled) { m_lazyDecoding = enabled; }
+
+        /*!
+        \brief Returns true if lazy decoding of tile layer data is enabled
+        \see setLazyDecoding()
+        */
+        bool getLazyDecoding() const { return m_lazyDecoding; }
+
+        /*!
+        \brief Decodes the data of any tile layers which have not yet
+        been decoded, including those inside layer groups. If an Executor
+        is set the layers are decoded in parallel.
+        \see setLazyDecoding()
+        */
+        void decodeAll() const;
+
+        /*!
+        \brief Sets a filter used to choose which layers are loaded.
+        The filter is called for every layer, including object groups and
+        the layers inside groups, before the layer is parsed. Layers for
+        which it returns false are skipped entirely, so their tile data is
+        never decoded and their objects never parsed. Rejecting a group
+        skips all of the layers it contains. The filter may be called
+        from several threads at once if an Executor is set.
+        When a cache directory is set, maps loaded with a filter may be
+        read from existing cache entries, but new entries are not written.
+        \param filter The filter to use, or an empty function to load every
+        layer (the default)
+        */
+        void setLayerFilter(LayerFilter filter) { m_layerFilter = std::move(filter); }
+
+        /*!
+        \brief Returns the filter used to choose which layers are loaded
+        \see setLayerFilter()
+        */
+        const LayerFilter& getLayerFilter() const { return m_layerFilter; }
+
+        /*!
+        \brief Sets the regions of an infinite map which are loaded.
+        Only the chunks of tile layers which intersect at least one of the
+        regions are decoded when the map is loaded. The encoded data of
+        the remaining chunks is kept, so that they can be loaded later
+        with TileLayer::loadRegion(). Maps read from binary data always
+        load every chunk, as they need no decoding.
+        When a cache directory is set, maps loaded with regions of interest
+        may be read from existing cache entries, but new entries are not
+        written.
+        \param regions The areas to load, in tiles. An empty vector loads
+        every chunk (the default)
+        \see TileLayer::loadRegion()
+        */
+        void setRegionsOfInterest(const std::vector<IntRect>& regions) { m_regionsOfInterest = regions; }
+
+        /*!
+        \brief Returns the regions of an infinite map which are loaded
+        \see setRegionsOfInterest()
+        */
+        const std::vector<IntRect>& getRegionsOfInterest() const { return m_regionsOfInterest; }
+
+        /*!
+        \brief Sets a directory in which to cache parsed maps.
+        When set, load() hashes the contents of the map file and looks
+        for a matching entry in the cache directory. If one is found,
+        and none of the external tilesets or templates used by the map
+        have changed since the entry was written, the map is loaded
+        from the entry instead of being parsed. Otherwise the map is
+        parsed as usual and a new entry written. Entries are stored
+        in the binary map format, and are written atomically so a cache
+        directory may be shared by several processes. The directory is
+        created if it does not exist, but its parent must.
+        \param directory Path to the cache directory. An empty string
+        disables the cache (the default).
+        \see BinaryMap, getDependencies()
+        */
+        void setCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+
+        /*!
+        \brief Returns the cache directory, or an empty string if
+        maps are not cached.
+        \see setCacheDirectory()
+        */
+        const std::string& getCacheDirectory() const { return m_cacheDirectory; }
+
         /*!
         \brief Returns the version of the tile map last parsed.
         If no tile map has yet been parsed the version will read 0, 0
@@ -141,6 +441,15 @@ namespace tmx
         */
         const Vector2u& getTileCount() const { return m_tileCount; }
 
+        /*!
+        \brief Sets the tile count of the map in the X and Y directions.
+        This is used along with addLayer() and addTileset() to resize a
+        loaded map, for example when generating new layers in memory to
+        be written out with save(). The size of any existing layers is
+        not changed.
+        */
+        void setTileCount(const Vector2u& count) { m_tileCount = count; }
+
         /*!
         \brief Returns the size of the tile grid in this map.
         Actual tile sizes may vary and will be extended / shrunk about
@@ -187,6 +496,15 @@ namespace tmx
         */
         const std::vector<Tileset>& getTilesets() const { return m_tilesets; }
 
+        /*!
+        \brief Adds a tile set to the map, such as one loaded with
+        Tileset::loadWithoutMap(). The first GID of the tile set should
+        be set with Tileset::setFirstGID() so that it follows the last
+        GID of the tile sets already used by the map.
+        \see save()
+        */
+        void addTileset(const Tileset& tileset);
+
         /*!
         \brief Returns a reference to the vector containing the layer data.
         Layers are pointer-to-baseclass, the concrete type of which can be
@@ -195,6 +513,13 @@ namespace tmx
         */
         const std::vector<Layer::Ptr>& getLayers() const { return m_layers; }
 
+        /*!
+        \brief Adds a layer to the top of the map, for example a TileLayer
+        generated in memory to be written out with save()
+        \see TileLayer::setTiles()
+        */
+        void addLayer(Layer::Ptr layer) { m_layers.push_back(std::move(layer)); }
+
         /*!
         \brief Returns the class of the Map, as defined in the editor Tiled 1.9+
         */
@@ -207,6 +532,7 @@ namespace tmx
 
         /*!
         \brief Returns a Hashmap of all animated tiles accessible by TileID
+        The frames of these tiles use global tile IDs.
         */
         const std::map<std::uint32_t, Tileset::Tile>& getAnimatedTiles() const { return m_animTiles; }
 
@@ -245,6 +571,15 @@ namespace tmx
         */
         Vector2f getParallaxOrigin() const { return m_parallaxOrigin; }
 
+        /*!
+        \brief Returns the paths of the external tileset and template
+        files which were loaded along with the map, sorted by name.
+        Modifying any of these files changes the loaded map, so they
+        should be watched along with the map file itself when reloading
+        maps which have been edited.
+        */
+        const std::vector<std::string>& getDependencies() const { return m_dependencies; }
+
     private:
         Version m_version;
         std::string m_class;
@@ -273,8 +608,69 @@ namespace tmx
         std::unordered_map<std::string, Object> m_templateObjects;
         std::unordered_map<std::string, Tileset> m_templateTilesets;
 
+        std::vector<std::string> m_dependencies;
+        std::string m_cacheDirectory;
+        std::shared_ptr<AsyncLoad::State> m_loadState;
+
+        std::unique_ptr<ThreadPool> m_threadPool;
+        Executor* m_executor;
+        TilesetCache* m_tilesetCache;
+        TemplateCache* m_templateCache;
+        AssetProvider* m_assetProvider;
+        bool m_lazyDecoding;
+        LayerFilter m_layerFilter;
+        std::vector<IntRect> m_regionsOfInterest;
+
+        //guards the template objects, template tilesets and dependencies,
+        //which are added to by layers parsed on other threads. A moved map
+        //is given a new mutex, as maps can't be moved while loading
+        struct LoadMutex final
+        {
+            LoadMutex() = default;
+            LoadMutex(LoadMutex&&) {}
+            LoadMutex& operator = (LoadMutex&&) { return *this; }
+            std::mutex mutex;
+        };
+        LoadMutex m_loadMutex;
+
+        friend class BinaryMap;
+        friend class IncrementalLoader;
+        friend class JsonMap;
+        friend class LayerGroup;
+        friend class MapInfo;
+        friend class MapReader;
+        friend class Object;
+        friend class TemplateCache;
+        friend class TileLayer;
+        friend class Tileset;
+        bool loadCached(const std::string& path, char* data, std::size_t size);
+        AssetProvider& getProvider() const { return m_assetProvider ? *m_assetProvider : AssetProvider::getDefault(); }
+        bool parseDocument(const pugi::xml_node&, const std::string& workingDir);
         bool parseMapNode(const pugi::xml_node&);
 
+        //called once all the tilesets and layers have been parsed
+        void finaliseLoad();
+
+        //records a file loaded while parsing the map.
+        //may be called from any thread
+        void addDependency(const std::string& path);
+
+        //used to report progress and check for cancellation
+        //when loading asynchronously. May be called from any thread
+        bool isLoadCancelled() const { return m_loadState && m_loadState->cancelled; }
+        void setBytesParsed(std::size_t parsed, std::size_t total);
+        void parseLayer(Layer& layer, const pugi::xml_node& node);
+        std::size_t countLayers(const pugi::xml_node& node, const std::string& groupPath) const;
+
+        //applies the layer filter to a layer node, or to layers read from
+        //a binary map, where groupPath is the path of the parent group
+        bool acceptLayer(const pugi::xml_node& node, const std::string& groupPath) const;
+        void filterLayers(std::vector<Layer::Ptr>& layers, const std::string& groupPath) const;
+        static std::string getGroupPath(const pugi::xml_node& group);
+
+        //returns false if the node name is not that of a layer
+        static bool getLayerType(const std::string& nodeName, Layer::Type& type);
+
         //always returns false so we can return this
         //on load failure
         bool reset();
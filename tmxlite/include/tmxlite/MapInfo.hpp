@@ -0,0 +1,171 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Map.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    class AssetProvider;
+
+    /*!
+    \brief Reads the header of a map without loading it.
+    probe() reads the attributes of the map, its properties, the names,
+    types and classes of its layers, and which tile sets it uses. Every
+    other element, including all tile data and objects, is skipped over
+    by looking only for the tags which end it - nothing is decoded,
+    decompressed or parsed, and external tile sets are not opened.
+    This makes it suitable for listing many maps, for example on a level
+    select screen, where loading each Map would take far longer.
+    Only tmx files are supported.
+    \see Map
+    */
+    class TMXLITE_EXPORT_API MapInfo final
+    {
+    public:
+        /*!
+        \brief A tile set used by the map
+        */
+        struct TilesetReference final
+        {
+            std::uint32_t firstGID = 0;
+            //path to an external tile set, resolved relative to
+            //the map, or empty if the tile set is embedded
+            std::string source;
+            //name of an embedded tile set. This is empty for
+            //external tile sets, as they are not opened
+            std::string name;
+        };
+
+        MapInfo();
+
+        /*!
+        \brief Reads the header of the map at the given path
+        \returns true if successful, else false
+        */
+        bool probe(const std::string& path);
+
+        /*!
+        \brief Reads the header of a map from the given stream
+        \param stream Stream containing the map document
+        \param workingDir Directory used to resolve the paths of
+        external tile sets
+        \returns true if successful, else false
+        */
+        bool probe(std::istream& stream, const std::string& workingDir);
+
+        /*!
+        \brief Sets the AssetProvider used by probe() to read the file.
+        \param provider Pointer to the provider to use, or nullptr to read
+        files from disk (the default)
+        \see AssetProvider
+        */
+        void setAssetProvider(AssetProvider* provider) { m_assetProvider = provider; }
+
+        /*!
+        \brief Returns the AssetProvider used when probing, or nullptr
+        if files are read from disk.
+        */
+        AssetProvider* getAssetProvider() const { return m_assetProvider; }
+
+        /*!
+        \brief Returns the version of the map
+        */
+        const Version& getVersion() const { return m_version; }
+
+        /*!
+        \brief Returns the orientation of the map
+        */
+        Orientation getOrientation() const { return m_orientation; }
+
+        /*!
+        \brief Returns the render order of the map
+        */
+        RenderOrder getRenderOrder() const { return m_renderOrder; }
+
+        /*!
+        \brief Returns the size of the map in tiles
+        */
+        const Vector2u& getTileCount() const { return m_tileCount; }
+
+        /*!
+        \brief Returns the size of a tile in pixels
+        */
+        const Vector2u& getTileSize() const { return m_tileSize; }
+
+        /*!
+        \brief Returns true if the map is infinite
+        */
+        bool isInfinite() const { return m_infinite; }
+
+        /*!
+        \brief Returns the class of the map
+        */
+        const std::string& getClass() const { return m_class; }
+
+        /*!
+        \brief Returns the properties of the map
+        */
+        const std::vector<Property>& getProperties() const { return m_properties; }
+
+        /*!
+        \brief Returns every layer of the map in document order, including
+        those inside groups, each of which follows the group containing it
+        */
+        const std::vector<Map::LayerInfo>& getLayers() const { return m_layers; }
+
+        /*!
+        \brief Returns the tile sets used by the map
+        */
+        const std::vector<TilesetReference>& getTilesets() const { return m_tilesets; }
+
+    private:
+        AssetProvider* m_assetProvider;
+
+        Version m_version;
+        Orientation m_orientation;
+        RenderOrder m_renderOrder;
+        Vector2u m_tileCount;
+        Vector2u m_tileSize;
+        bool m_infinite;
+        std::string m_class;
+        std::vector<Property> m_properties;
+        std::vector<Map::LayerInfo> m_layers;
+        std::vector<TilesetReference> m_tilesets;
+
+        //always returns false so we can return this
+        //on failure
+        bool reset();
+    };
+}
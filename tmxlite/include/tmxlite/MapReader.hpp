@@ -0,0 +1,169 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Property.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    class AssetProvider;
+    class Map;
+    class Object;
+    class Tileset;
+
+    /*!
+    \brief Reads a map as a stream of events, without ever loading
+    the whole document.
+    Rather than building a Map, the document is read a single element
+    at a time, and the contents passed to a Handler as they are found.
+    Tilesets, tile layers, image layers, objects and properties are
+    each parsed from their own element and discarded once the Handler
+    returns, so the memory used is bounded by the size of the largest
+    of these elements rather than by the size of the map. Layer groups
+    and object groups are streamed so that their size doesn't matter.
+    This is suited to tools which scan many maps, for example to gather
+    statistics or validate them, which have no use for the map once the
+    data has been seen.
+    \see Map
+    */
+    class TMXLITE_EXPORT_API MapReader final
+    {
+    public:
+        /*!
+        \brief Receives the events raised while reading a map.
+        Every function returns true to continue reading, or false to stop.
+        The references passed to each function are only valid until it
+        returns. The default implementations do nothing.
+        */
+        class TMXLITE_EXPORT_API Handler
+        {
+        public:
+            virtual ~Handler() = default;
+
+            /*!
+            \brief Raised once the map node has been read. The map contains
+            all of its attributes, such as the orientation and tile count,
+            but no tilesets, layers or properties.
+            */
+            virtual bool onMap(const Map&) { return true; }
+
+            /*!
+            \brief Raised for the properties of the map, or of the layer
+            most recently passed to onLayerBegin() which has not yet ended.
+            */
+            virtual bool onProperties(const std::vector<Property>&) { return true; }
+
+            /*!
+            \brief Raised for each tileset of the map, in document order.
+            External tilesets are loaded before this is raised.
+            */
+            virtual bool onTileset(const Tileset&) { return true; }
+
+            /*!
+            \brief Raised when a layer begins. Tile layers and image layers
+            are completely parsed by this point, including their properties,
+            whereas layer groups and object groups only contain the values
+            of their attributes - their contents follow as separate events.
+            Layers are nested by calls to onLayerBegin() and onLayerEnd().
+            */
+            virtual bool onLayerBegin(const Layer&) { return true; }
+
+            /*!
+            \brief Raised for each row of tiles in a tile layer of a map
+            which is not infinite. The parameters are the layer to which
+            the tiles belong, the index of the row within the layer, a
+            pointer to the first tile in the row and the number of tiles
+            in the row.
+            */
+            virtual bool onTileRow(const TileLayer&, std::uint32_t, const TileLayer::Tile*, std::size_t) { return true; }
+
+            /*!
+            \brief Raised for each chunk of a tile layer in an infinite map
+            */
+            virtual bool onChunk(const TileLayer&, const TileLayer::Chunk&) { return true; }
+
+            /*!
+            \brief Raised for each object in an object group
+            */
+            virtual bool onObject(const Object&) { return true; }
+
+            /*!
+            \brief Raised when the layer passed to the matching call to
+            onLayerBegin() ends
+            */
+            virtual bool onLayerEnd(const Layer&) { return true; }
+        };
+
+        /*!
+        \brief Reads the map file at the given path, passing its contents
+        to the given Handler.
+        \returns false if the map could not be read. Stopping early by
+        returning false from the Handler is not considered an error.
+        */
+        bool read(const std::string& path, Handler& handler);
+
+        /*!
+        \brief Reads a map from the given stream, passing its contents
+        to the given Handler.
+        \param stream Stream containing the map document
+        \param workingDir Directory in which to look for the files
+        referenced by the map, such as external tilesets and templates
+        \param handler Handler to which the contents are passed
+        \returns false if the map could not be read. Stopping early by
+        returning false from the Handler is not considered an error.
+        */
+        bool read(std::istream& stream, const std::string& workingDir, Handler& handler);
+
+        /*!
+        \brief Sets the AssetProvider used to read the map file and the
+        files it refers to, such as external tile sets and templates.
+        When no provider is set the map file is streamed from disk.
+        \param provider Pointer to the provider to use, or nullptr to read
+        files from disk (the default)
+        \see AssetProvider
+        */
+        void setAssetProvider(AssetProvider* provider) { m_assetProvider = provider; }
+
+        /*!
+        \brief Returns the AssetProvider used when reading, or nullptr
+        if files are read from disk.
+        */
+        AssetProvider* getAssetProvider() const { return m_assetProvider; }
+
+    private:
+        AssetProvider* m_assetProvider = nullptr;
+    };
+}
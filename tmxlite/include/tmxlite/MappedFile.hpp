@@ -0,0 +1,99 @@
+/*********************************************************************
+Matt Marchant 2016 - 2023
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace tmx
+{
+    /*!
+    \brief Maps the contents of a file into memory.
+    The mapping is private copy-on-write, so the returned buffer
+    may be modified (for example by parsing XML in place) without
+    the changes ever being written back to disk. Pages which are
+    never modified are shared with the OS file cache, so mapping
+    a file costs far less resident memory than reading it into
+    a std::string.
+    If mapping is not supported on the current platform open()
+    returns false and the file should be read by other means.
+    */
+    class TMXLITE_EXPORT_API MappedFile final
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator = (const MappedFile&) = delete;
+        MappedFile(MappedFile&&) noexcept;
+        MappedFile& operator = (MappedFile&&) noexcept;
+
+        /*!
+        \brief Attempts to map the file at the given path.
+        Any currently mapped file is closed first.
+        \returns true on success, else false. Empty files
+        cannot be mapped and will also return false.
+        */
+        bool open(const std::string& path);
+
+        /*!
+        \brief Unmaps the file, if one is mapped.
+        Any pointers returned by data() become invalid.
+        */
+        void close();
+
+        /*!
+        \brief Returns true if a file is currently mapped
+        */
+        bool isOpen() const { return m_data != nullptr; }
+
+        /*!
+        \brief Returns a pointer to the mapped file contents,
+        or nullptr if no file is mapped. Note that the contents
+        are NOT null terminated.
+        */
+        char* data() { return m_data; }
+        const char* data() const { return m_data; }
+
+        /*!
+        \brief Returns the size of the mapped file in bytes
+        */
+        std::size_t size() const { return m_size; }
+
+    private:
+        char* m_data = nullptr;
+        std::size_t m_size = 0;
+
+#ifdef _WIN32
+        void* m_mappingHandle = nullptr;
+#endif
+    };
+}
@@ -196,6 +196,10 @@ namespace tmx
         const std::string& getTilesetName() const { return m_tilesetName; }
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+        friend class TemplateCache;
+
         std::uint32_t m_UID;
         std::string m_name;
         std::string m_class;
@@ -76,6 +76,9 @@ namespace tmx
         const std::vector<Object>& getObjects() const { return m_objects; }
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+
         Colour m_colour;
         DrawOrder m_drawOrder;
 
@@ -26,6 +26,7 @@ source distribution.
 
 #pragma once
 
+#include <tmxlite/AssetProvider.hpp>
 #include <tmxlite/Property.hpp>
 
 #include <string>
@@ -68,15 +69,55 @@ namespace tmx
         */
         bool loadFromString(const std::string& data, const std::string& workingDir);
 
+        /*!
+        \brief Loads an object types from a document stored in a string,
+        parsing the string in place rather than copying it.
+        \param data A std::string containing the object types to load.
+        The contents of the string are modified while parsing.
+        \param workingDir A std::string containing the working directory
+        in which to find files.
+        \returns true if successful, else false
+        */
+        bool loadFromString(std::string&& data, const std::string& workingDir);
+
+        /*!
+        \brief Loads an object types from a document stored in a mutable
+        buffer, which is parsed in place. The buffer remains owned by the
+        caller and only needs to exist for the duration of this call, after
+        which its contents should be considered undefined.
+        \param data Pointer to the document. This does not need to be null terminated.
+        \param size Size of the buffer in bytes
+        \param workingDir A std::string containing the working directory
+        in which to find files.
+        \returns true if successful, else false
+        */
+        bool loadFromBuffer(char* data, std::size_t size, const std::string& workingDir);
+
         /*!
         \brief Returns all predefined types and their default values.
         */
         const std::vector<Type>& getTypes() const { return m_types; }
 
+        /*!
+        \brief Sets the AssetProvider used by load() to read the file.
+        \param provider Pointer to the provider to use, or nullptr to read
+        files from disk (the default)
+        \see AssetProvider
+        */
+        void setAssetProvider(AssetProvider* provider) { m_assetProvider = provider; }
+
+        /*!
+        \brief Returns the AssetProvider used when loading, or nullptr
+        if files are read from disk.
+        */
+        AssetProvider* getAssetProvider() const { return m_assetProvider; }
+
     private:
         std::string m_workingDirectory;
         std::vector<Type> m_types;
+        AssetProvider* m_assetProvider = nullptr;
 
+        bool parseDocument(const pugi::xml_node&, const std::string& workingDir);
         bool parseObjectTypesNode(const pugi::xml_node&);
 
         //always returns false so we can return this
@@ -141,6 +141,9 @@ namespace tmx
 
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+
         union
         {
             bool m_boolValue;
@@ -0,0 +1,108 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Object.hpp>
+#include <tmxlite/Tileset.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tmx
+{
+    class Map;
+
+    /*!
+    \brief Caches object templates so that they are parsed only once
+    no matter how many maps use them.
+    Entries are keyed by the resolved path of the template file, and are
+    reloaded if the modification time or size of the template, or of the
+    tile set it uses, change. Files are read through the Map's AssetProvider,
+    and templates are not cached if the provider can't report when they
+    change. The tile sets used by templates are shared
+    with the cached copy in the same way as those loaded by a TilesetCache.
+    A cache is safe to use from multiple threads, and may be shared
+    between any number of maps, which may be cleared or destroyed
+    independently of the cache.
+    \see Map::setTemplateCache(), Map::getTemplateObjects()
+    */
+    class TMXLITE_EXPORT_API TemplateCache final
+    {
+    public:
+        TemplateCache() = default;
+
+        TemplateCache(const TemplateCache&) = delete;
+        TemplateCache& operator = (const TemplateCache&) = delete;
+
+        /*!
+        \brief Removes all templates from the cache
+        */
+        void clear();
+
+        /*!
+        \brief Returns the number of templates currently cached
+        */
+        std::size_t size() const;
+
+    private:
+        friend class Object;
+
+        struct FileInfo final
+        {
+            std::string path;
+            std::int64_t modifiedTime = 0;
+            std::int64_t fileSize = 0;
+        };
+
+        struct Template final
+        {
+            Object object;
+            Tileset tileset;
+            std::vector<FileInfo> files; //the template followed by its tile set, if any
+            bool cacheable = true; //false if the provider can't tell when files change
+        };
+        using TemplatePtr = std::shared_ptr<const Template>;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, TemplatePtr> m_templates;
+
+        //these return nullptr if the template failed to load
+        TemplatePtr load(const std::string& path, Map* map);
+
+        //templates which are not cached may use a tile set already loaded
+        //by the map, rather than parsing their own copy
+        static TemplatePtr parse(const std::string& path, Map* map, bool useMapTilesets);
+    };
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Executor.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tmx
+{
+    /*!
+    \brief A work stealing pool of threads which can be used as an
+    Executor for parallel loading.
+    Each thread has its own queue of tasks, and takes tasks from the
+    queues of other threads when its own is empty. Threads which wait()
+    on tasks run queued tasks while they wait, so it is safe to wait
+    from within a task.
+    \see Map::setExecutor(), Map::setThreadCount()
+    */
+    class TMXLITE_EXPORT_API ThreadPool final : public Executor
+    {
+    public:
+        /*!
+        \brief Constructor.
+        \param threadCount Number of worker threads to start. If this
+        is 0 then one thread per hardware thread is started.
+        */
+        explicit ThreadPool(std::size_t threadCount = 0);
+
+        /*!
+        \brief Runs any tasks still queued, then stops the threads
+        */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator = (ThreadPool&&) = delete;
+
+        void submit(Task task) override;
+        void wait(const std::function<bool()>& done) override;
+
+        /*!
+        \brief Returns the number of worker threads in the pool
+        */
+        std::size_t getThreadCount() const { return m_threads.size(); }
+
+    private:
+        struct WorkQueue;
+
+        //one queue per thread, plus one shared by any thread outside the pool
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic<bool> m_running;
+        std::atomic<std::size_t> m_queued;
+        std::atomic<std::size_t> m_waiting;
+
+        std::size_t getQueueIndex() const;
+        bool runTask(std::size_t queueIndex);
+        void threadFunc(std::size_t queueIndex);
+    };
+}
@@ -30,8 +30,14 @@ source distribution.
 #include <tmxlite/Layer.hpp>
 #include <tmxlite/Types.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
 namespace tmx
 {
+    class Executor;
+
     /*!
     \brief A layer made up from a series of tile sets
     */
@@ -39,12 +45,53 @@ namespace tmx
     {
     public:
         /*!
-        \brief Tile information for a layer
+        \brief Tile information for a layer.
+        Tiles store the raw 32 bit global ID the same way Tiled does,
+        with the flip flags in the top 4 bits, so that decoded layer
+        data can be copied straight into them.
         */
         struct Tile final
         {
-            std::uint32_t ID = 0; //!< Global ID of the tile
-            std::uint8_t flipFlags = 0; //!< Flags marking if the tile should be flipped when drawn
+            constexpr Tile() : m_gid(0) {}
+            constexpr Tile(std::uint32_t id, std::uint8_t flags) : m_gid((id & IDMask) | (static_cast<std::uint32_t>(flags) << 28)) {}
+
+            /*!
+            \brief Returns the global ID of the tile, without the flip flags
+            */
+            constexpr std::uint32_t getID() const { return m_gid & IDMask; }
+
+            /*!
+            \brief Sets the global ID of the tile, keeping its flip flags
+            */
+            void setID(std::uint32_t id) { m_gid = (m_gid & ~IDMask) | (id & IDMask); }
+
+            /*!
+            \brief Returns the flags marking if the tile should be flipped when drawn
+            \see FlipFlag
+            */
+            constexpr std::uint8_t getFlipFlags() const { return static_cast<std::uint8_t>(m_gid >> 28); }
+
+            /*!
+            \brief Sets the flags marking if the tile should be flipped when drawn
+            */
+            void setFlipFlags(std::uint8_t flags) { m_gid = (m_gid & IDMask) | (static_cast<std::uint32_t>(flags & 0xf) << 28); }
+
+            /*!
+            \brief Returns the raw global ID as stored by Tiled,
+            with the flip flags in the top 4 bits
+            */
+            constexpr std::uint32_t getGID() const { return m_gid; }
+
+            /*!
+            \brief Creates a Tile from a raw global ID as stored by Tiled
+            */
+            static constexpr Tile fromGID(std::uint32_t gid) { return Tile(gid); }
+
+        private:
+            static constexpr std::uint32_t IDMask = 0x0fffffff;
+            explicit constexpr Tile(std::uint32_t gid) : m_gid(gid) {}
+
+            std::uint32_t m_gid;
         };
 
         /*!
@@ -67,7 +114,30 @@ namespace tmx
             Diagonal = 0x2
         };
             
+        /*!
+        \brief Result of decoding the tile data of a layer
+        */
+        enum class DecodeResult
+        {
+            Success,
+            DataError, //!< the data was corrupt, truncated or used an unsupported encoding or compression
+            MemoryError, //!< the decompressor could not allocate the memory it needed
+            SizeMismatch //!< the data held more or fewer tiles than the layer or chunk size requires
+        };
+
         explicit TileLayer(std::size_t);
+        ~TileLayer();
+
+        /*!
+        \brief Copying a layer copies its tile data, along with any data
+        still waiting to be decoded, so that the copy can be decoded
+        independently of the original. Moving a layer leaves the
+        moved from layer empty.
+        */
+        TileLayer(const TileLayer&);
+        TileLayer(TileLayer&&) noexcept;
+        TileLayer& operator = (const TileLayer&);
+        TileLayer& operator = (TileLayer&&) noexcept;
 
         Type getType() const override { return Layer::Type::Tile; }
         void parse(const pugi::xml_node&, Map*) override;
@@ -76,30 +146,146 @@ namespace tmx
         \brief Returns the list of tiles used to make up the layer
         If this is empty then the map is most likely infinite, in
         which case the tile data is stored in chunks.
+        If the map was loaded with lazy decoding enabled the tile
+        data is decoded the first time this is called.
         \see getChunks()
         */
-        const std::vector<Tile>& getTiles() const { return m_tiles; }
+        const std::vector<Tile>& getTiles() const { decode(); return m_tiles; }
 
         /*!
         \brief Returns a vector of chunks which make up this layer
         if the map is set to infinite. This will be empty if the map
         is not infinite.
+        If the map was loaded with lazy decoding enabled the tile
+        data is decoded the first time this is called.
         \see getTiles()
         */
-        const std::vector<Chunk>& getChunks() const { return m_chunks; }
+        const std::vector<Chunk>& getChunks() const { decode(); return m_chunks; }
+
+        /*!
+        \brief Replaces the tiles of the layer, for example when generating
+        a map in memory to be saved with Map::save(). Any data waiting to
+        be decoded, or chunks waiting to be loaded, is discarded.
+        This must not be called while another thread is using the layer.
+        \see setChunks()
+        */
+        void setTiles(std::vector<Tile> tiles);
+
+        /*!
+        \brief Replaces the chunks of the layer, if the map is infinite.
+        Any data waiting to be decoded, or chunks waiting to be loaded,
+        is discarded. This must not be called while another thread is
+        using the layer.
+        \see setTiles()
+        */
+        void setChunks(std::vector<Chunk> chunks);
+
+        /*!
+        \brief Decodes the tile data of this layer if it has not yet been
+        decoded. This is only necessary when the map was loaded with lazy
+        decoding enabled, and the data is wanted up front rather than on
+        the first call to getTiles() or getChunks(). It is safe to call
+        this from multiple threads.
+        \param executor Optional Executor used to decode the chunks of
+        infinite maps in parallel.
+        \see Map::setLazyDecoding()
+        */
+        void decode(Executor* executor = nullptr) const
+        {
+            if (!m_decoded.load(std::memory_order_acquire))
+            {
+                decodePending(executor);
+            }
+        }
+
+        /*!
+        \brief Returns the result of decoding the tile data of this layer.
+        If decoding failed the layer has no tiles, or in infinite maps the
+        chunks which failed are missing, and this returns the reason for
+        the first failure. If the map was loaded with lazy decoding
+        enabled the tile data is decoded first.
+        */
+        DecodeResult getDecodeResult() const { decode(); return m_decodeResult; }
+
+        /*!
+        \brief Returns true if the tile data of this layer has been decoded
+        */
+        bool isDecoded() const { return m_decoded.load(std::memory_order_acquire); }
+
+        /*!
+        \brief Decodes the chunks of an infinite map which intersect the
+        given region, and which were not loaded because they were outside
+        the map's regions of interest. The chunks are added to the end of
+        those returned by getChunks(), so this must not be called while
+        another thread is using them.
+        \param region The area to load, in tiles
+        \param executor Optional Executor used to decode the chunks in parallel
+        \returns The number of chunks which were loaded
+        \see Map::setRegionsOfInterest()
+        */
+        std::size_t loadRegion(const IntRect& region, Executor* executor = nullptr) { return loadPending(&region, executor); }
+
+        /*!
+        \brief Returns the number of chunks of an infinite map which are
+        waiting to be loaded with loadRegion()
+        */
+        std::size_t getPendingChunkCount() const;
 
     private:
-        std::vector<Tile> m_tiles;
-        std::vector<Chunk> m_chunks;
+        friend class BinaryMap;
+        friend class JsonMap;
+        friend class MapWriter;
+
+        //encoded text of a chunk of an infinite map
+        struct EncodedChunk final
+        {
+            Vector2i position;
+            Vector2i size;
+            const char* data = nullptr;
+        };
+
+        struct EncodedData;
+
+        mutable std::vector<Tile> m_tiles;
+        mutable std::vector<Chunk> m_chunks;
         std::size_t m_tileCount;
 
-        void parseBase64(const pugi::xml_node&);
-        void parseCSV(const pugi::xml_node&);
+        //encoded data waiting to be decoded on first access
+        mutable std::unique_ptr<EncodedData> m_encodedData;
+        mutable DecodeResult m_decodeResult;
+
+        //chunks outside the map's regions of interest
+        std::unique_ptr<EncodedData> m_pendingChunks;
+        mutable std::mutex m_decodeMutex;
+        mutable std::atomic<bool> m_decoded;
+
+        //these expect the decode mutex of both layers to be held
+        void copyData(const TileLayer&);
+        void moveData(TileLayer&);
+
+        void parseEncoded(const pugi::xml_node&, Map*);
+        //decodes, or stores for decoding later, text in the given encoding and compression
+        void parseEncoded(const std::string& encoding, const std::string& compression, const char* data, std::vector<EncodedChunk>&& chunks, Map*);
         void parseUnencoded(const pugi::xml_node&);
 
+        void decodePending(Executor*) const;
+        //the map, if given, is checked between chunks to see if loading was cancelled
+        void decodeData(const EncodedData&, Executor*, const Map* = nullptr) const;
+        //returns the first failure, if any chunks failed to decode
+        DecodeResult decodeChunks(const EncodedData&, std::vector<Chunk>& destination, Executor*, const Map*) const;
+
+        //loads pending chunks which intersect the region, or all of them if it's nullptr
+        std::size_t loadPending(const IntRect*, Executor*);
+
+        //decodes the pending chunks into destination, leaving the layer unchanged
+        void decodePendingChunks(std::vector<Chunk>& destination, Executor*) const;
+
         void createTiles(const std::vector<std::uint32_t>&, std::vector<Tile>& destination);
     };
 
+    static_assert(sizeof(TileLayer::Tile) == 4, "Tiles are expected to be packed into 4 bytes");
+    static_assert(std::is_trivially_copyable<TileLayer::Tile>::value, "Tiles are expected to be copyable as raw GIDs");
+
     template <>
     inline TileLayer& Layer::getLayerAs<TileLayer>()
     {
@@ -28,11 +28,14 @@ source distribution.
 #pragma once
 
 #include <tmxlite/Config.hpp>
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/Executor.hpp>
 #include <tmxlite/ObjectGroup.hpp>
 #include <tmxlite/Property.hpp>
 
 #include <array>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -78,7 +81,10 @@ namespace tmx
                 {
                     /*!
                         \brief ID of the tile to be displayed during this frame
-                        \note For convenience, this is global tile ID - you do not need to add the firstGID of the tileset to it
+                        \note This is the local ID of the tile within the tile set, as tile sets
+                        may be shared between maps with different first GIDs. The tiles returned
+                        by Map::getAnimatedTiles() have the firstGID of the tileset added, so
+                        that their frames use global tile IDs.
                     */
                     std::uint32_t tileID = 0;
 
@@ -140,7 +146,8 @@ namespace tmx
         };
 
         /**
-        \brief Loads the tilemap from the given location.
+        \brief Loads the tilemap from the given location, which may
+        be either a *.tsx or *.tsj file.
         This does not set the first GID.
         This does not support templates.
         Usually tilemaps are loaded automatically as part of a Map instead.
@@ -155,6 +162,47 @@ namespace tmx
         */
         bool loadWithoutMapFromString(const std::string& xmlStr);
 
+        /**
+        \brief Loads the tilemap from the given XML string, parsing
+        the string in place rather than copying it.
+        The contents of the string are modified while parsing.
+        This does not set the first GID.
+        This does not support templates.
+        \see loadWithoutMapFromBuffer()
+        */
+        bool loadWithoutMapFromString(std::string&& xmlStr);
+
+        /**
+        \brief Loads the tilemap from XML or JSON stored in a mutable buffer.
+        The buffer is parsed in place so that no copy is made. It remains
+        owned by the caller and only needs to exist for the duration of
+        this call, after which its contents should be considered undefined.
+        The buffer does not need to be null terminated.
+        This does not set the first GID.
+        This does not support templates.
+        */
+        bool loadWithoutMapFromBuffer(char* data, std::size_t size);
+
+        /*!
+        \brief Writes the tile set to a *.tsx file.
+        Paths to images are made relative to the directory of the
+        saved file. The first GID is not written, as it belongs to
+        the map which uses the tile set.
+        \param path Path of the file to write
+        \returns true on success, else false
+        \see Map::save()
+        */
+        bool save(const std::string& path) const;
+
+        /*!
+        \brief Writes the tile set as a *.tsx document to a string
+        \param destination String to which the document is written. Any
+        existing contents are replaced.
+        \param workingDir Directory to which paths in the document are made
+        relative, usually the directory the document will be saved in
+        */
+        void saveToString(std::string& destination, const std::string& workingDir) const;
+
         /*!
         \brief Attempts to parse the given xml node as part of a map.
         If node parsing fails, an error is printed in the console
@@ -162,6 +210,38 @@ namespace tmx
         */
         bool parse(pugi::xml_node, Map*);
 
+        /*!
+        \brief Sets the Executor used to parse the tiles of large tile
+        sets in parallel. This is set automatically to the Map's executor
+        when the tile set is loaded as part of a map.
+        \param executor Pointer to the executor to use, or nullptr to load
+        everything on the calling thread (the default)
+        \see Executor
+        */
+        void setExecutor(Executor* executor) { m_executor = executor; }
+
+        /*!
+        \brief Returns the Executor used when parsing, or nullptr if
+        everything is parsed on the calling thread.
+        */
+        Executor* getExecutor() const { return m_executor; }
+
+        /*!
+        \brief Sets the AssetProvider used to read external tile set files.
+        This is set automatically to the Map's provider when the tile set
+        is loaded as part of a map.
+        \param provider Pointer to the provider to use, or nullptr to read
+        files from disk (the default)
+        \see AssetProvider
+        */
+        void setAssetProvider(AssetProvider* provider) { m_assetProvider = provider; }
+
+        /*!
+        \brief Returns the AssetProvider used when loading, or nullptr
+        if files are read from disk.
+        */
+        AssetProvider* getAssetProvider() const { return m_assetProvider; }
+
         /*!
         \brief Returns the first GID of this tile set.
         This the ID of the first tile in the tile set, so that
@@ -184,39 +264,39 @@ namespace tmx
         /*!
         \brief Returns the name of this tile set.
         */
-        const std::string& getName() const { return m_name; }
+        const std::string& getName() const { return m_data->name; }
 
         /*!
         \brief Returns the class of the Tileset, as defined in the editor Tiled 1.9+
         */
-        const std::string& getClass() const { return m_class; }
+        const std::string& getClass() const { return m_data->className; }
 
         /*!
         \brief Returns the width and height of a tile in the
         tile set, in pixels.
         */
-        const Vector2u& getTileSize() const { return m_tileSize; }
+        const Vector2u& getTileSize() const { return m_data->tileSize; }
 
         /*!
         \brief Returns the spacing, in pixels, between each tile in the set
         */
-        std::uint32_t getSpacing() const { return m_spacing; }
+        std::uint32_t getSpacing() const { return m_data->spacing; }
 
         /*!
         \brief Returns the margin, in pixels, around each tile in the set
         */
-        std::uint32_t getMargin() const { return m_margin; }
+        std::uint32_t getMargin() const { return m_data->margin; }
 
         /*!
         \brief Returns the number of tiles in the tile set
         */
-        std::uint32_t getTileCount() const { return m_tileCount; }
+        std::uint32_t getTileCount() const { return m_data->tileCount; }
 
         /*!
         \brief Returns the number of columns which make up the tile set.
         This is used when rendering collection of images sets
         */
-        std::uint32_t getColumnCount() const { return m_columnCount; }
+        std::uint32_t getColumnCount() const { return m_data->columnCount; }
 
         /*!
         \brief Returns the alignment of tile objects.
@@ -225,55 +305,61 @@ namespace tmx
         orthogonal mode and Bottom in isometric mode.
         \see ObjectAlignment
         */
-        ObjectAlignment getObjectAlignment() const { return m_objectAlignment; }
+        ObjectAlignment getObjectAlignment() const { return m_data->objectAlignment; }
 
         /*!
         \brief Returns the tile offset in pixels.
         Tile will draw tiles offset from the top left using this value.
         */
-        const Vector2u& getTileOffset() const { return m_tileOffset; }
+        const Vector2u& getTileOffset() const { return m_data->tileOffset; }
 
         /*!
         \brief Returns a reference to the list of Property objects for this
         tile set
         */
-        const std::vector<Property>& getProperties() const { return m_properties; }
+        const std::vector<Property>& getProperties() const { return m_data->properties; }
 
         /*!
         \brief Returns the file path to the tile set image, relative to the
         working directory. Use this to load the texture required by whichever
         method you choose to render the map.
         */
-        const std::string& getImagePath() const { return m_imagePath; }
+        const std::string& getImagePath() const { return m_data->imagePath; }
+
+        /*!
+        \brief Returns the path of the file from which the tile set
+        was loaded, or an empty string if it was embedded in a map.
+        */
+        const std::string& getSource() const { return m_data->source; }
 
         /*!
         \brief Returns the size of the tile set image in pixels.
          */
-        const Vector2u& getImageSize() const { return m_imageSize; }
+        const Vector2u& getImageSize() const { return m_data->imageSize; }
 
         /*!
         \brief Returns the colour used by the tile map image to represent transparency.
         By default this is a transparent colour (0, 0, 0, 0)
         */
-        const Colour& getTransparencyColour() const { return m_transparencyColour; }
+        const Colour& getTransparencyColour() const { return m_data->transparencyColour; }
 
         /*!
         \brief Returns true if the image used by this tileset specifically requests
         a colour to use as transparency.
         */
-        bool hasTransparency() const { return m_hasTransparency; }
+        bool hasTransparency() const { return m_data->hasTransparency; }
 
         /*!
         \brief Returns a vector of Terrain types associated with one
         or more tiles within this tile set
         */
-        const std::vector<Terrain>& getTerrainTypes() const { return m_terrainTypes; }
+        const std::vector<Terrain>& getTerrainTypes() const { return m_data->terrainTypes; }
 
         /*!
         \brief Returns a reference to the vector of tile data used by
         tiles which make up this tile set.
         */
-        const std::vector<Tile>& getTiles() const { return m_tiles; }
+        const std::vector<Tile>& getTiles() const { return m_data->tiles; }
 
         /*!
          \brief Checks if a tiled ID is in the range of the first ID and the last ID
@@ -290,40 +376,57 @@ namespace tmx
         const Tile* getTile(std::uint32_t id) const;
 
     private:
+        friend class BinaryMap;
+        friend class JsonMap;
+        friend class TemplateCache;
+        friend class TilesetCache;
 
         std::string m_workingDir;
-
+        Executor* m_executor;
+        AssetProvider* m_assetProvider;
         std::uint32_t m_firstGID;
-        std::string m_source;
-        std::string m_name;
-        std::string m_class;
-        Vector2u m_tileSize;
-        std::uint32_t m_spacing;
-        std::uint32_t m_margin;
-        std::uint32_t m_tileCount;
-        std::uint32_t m_columnCount;
-        ObjectAlignment m_objectAlignment;
-        Vector2u m_tileOffset;
-
-        std::vector<Property> m_properties;
-        std::string m_imagePath;
-        Vector2u m_imageSize;
-        Colour m_transparencyColour;
-        bool m_hasTransparency;
-
-        std::vector<Terrain> m_terrainTypes;
-        std::vector<std::uint32_t> m_tileIndex;
-        std::vector<Tile> m_tiles;
+
+        //everything parsed from the tile set is kept separately, so
+        //that copies of a tile set loaded by a TilesetCache can share it
+        struct Data final
+        {
+            std::string source;
+            std::string name;
+            std::string className;
+            Vector2u tileSize;
+            std::uint32_t spacing = 0;
+            std::uint32_t margin = 0;
+            std::uint32_t tileCount = 0;
+            std::uint32_t columnCount = 0;
+            ObjectAlignment objectAlignment = ObjectAlignment::Unspecified;
+            Vector2u tileOffset;
+
+            std::vector<Property> properties;
+            std::string imagePath;
+            Vector2u imageSize;
+            Colour transparencyColour = { 0, 0, 0, 0 };
+            bool hasTransparency = false;
+
+            std::vector<Terrain> terrainTypes;
+            std::vector<std::uint32_t> tileIndex;
+            std::vector<Tile> tiles;
+        };
+        std::shared_ptr<Data> m_data;
 
         //always returns false so we can return this
         //on load failure
         bool reset();
 
+        bool parseDocument(const pugi::xml_node&);
+        //loads a tile set referred to by a map or template from its own file
+        bool parseReference(std::uint32_t firstGID, const std::string& source, Map*);
         void parseOffsetNode(const pugi::xml_node&);
         void parsePropertyNode(const pugi::xml_node&);
         void parseTerrainNode(const pugi::xml_node&);
         Tile& newTile(std::uint32_t ID);
         void parseTileNode(const pugi::xml_node&, Map*);
+        void parseTileData(Tile&, const pugi::xml_node&, Map*, Colour& transparency, bool& hasTransparency) const;
+        void parseTileNodes(const std::vector<std::pair<std::size_t, pugi::xml_node>>&, Map*);
         void createMissingTile(std::uint32_t ID);
     };
 }
@@ -0,0 +1,97 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/Tileset.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace tmx
+{
+    /*!
+    \brief Caches external tile sets so that they are parsed only once
+    no matter how many maps refer to them.
+    Entries are keyed by the resolved path of the tile set file, and are
+    reloaded if the file's modification time or size change, as reported
+    by the AssetProvider of the tile set being loaded. Tile sets
+    loaded through the cache share their data with the cached copy, so
+    only a single copy of each tile set is kept in memory. Each map still
+    stores its own first GID.
+    A cache is safe to use from multiple threads, and may be shared
+    between any number of maps. Maps keep the data of their tile sets
+    alive, so a cache may be cleared or destroyed while maps which were
+    loaded with it still exist.
+    \see Map::setTilesetCache()
+    */
+    class TMXLITE_EXPORT_API TilesetCache final
+    {
+    public:
+        TilesetCache() = default;
+
+        TilesetCache(const TilesetCache&) = delete;
+        TilesetCache& operator = (const TilesetCache&) = delete;
+
+        /*!
+        \brief Loads the tile set file at the given path into 'tileset',
+        parsing the file only if it is not already cached, or has been
+        modified since it was cached. The first GID of 'tileset' is unchanged.
+        \param path Path to the tile set file. This is not resolved against
+        the working directory of 'tileset'.
+        \param tileset The Tileset to load. Its executor, if any, is used
+        to parse the file.
+        \returns true on success, else false
+        */
+        bool load(const std::string& path, Tileset& tileset);
+
+        /*!
+        \brief Removes all tile sets from the cache
+        */
+        void clear();
+
+        /*!
+        \brief Returns the number of tile sets currently cached
+        */
+        std::size_t size() const;
+
+    private:
+        struct Entry final
+        {
+            std::int64_t modifiedTime = 0;
+            std::int64_t fileSize = 0;
+            Tileset tileset;
+        };
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+}
@@ -0,0 +1,124 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/Config.hpp>
+#include <tmxlite/AssetProvider.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace tmx
+{
+    /*!
+    \brief An AssetProvider which reads maps, tile sets and templates
+    directly from a zip archive.
+    The archive's central directory is read once when it is opened,
+    and indexed by path so that each file is found in constant time.
+    Files which are stored without compression are returned as a view
+    of the archive, without being copied. Deflated files are inflated
+    directly from the archive into a buffer of their final size.
+    The archive file is mapped into memory where possible.
+    Paths are looked up relative to the root of the archive, so a map
+    at "levels/level1.tmx" in the archive is loaded by passing that path
+    to Map::load(). Relative paths to tile sets and templates are then
+    resolved within the archive as they would be on disk.
+    Only stored and deflated entries are supported, and encrypted
+    entries cannot be read. Zip64 archives are supported.
+    Once opened, an archive may be read from any number of threads.
+    */
+    class TMXLITE_EXPORT_API ZipArchiveProvider final : public AssetProvider
+    {
+    public:
+        /*!
+        \brief Opens the zip archive at the given path, reading it with the
+        given provider, which reads from disk if nullptr. Any currently
+        open archive is closed first.
+        \returns true if the archive was opened, else false
+        */
+        bool openArchive(const std::string& path, AssetProvider* provider = nullptr);
+
+        /*!
+        \brief Opens a zip archive which has already been loaded into memory.
+        The memory is not copied, and must remain valid until the archive
+        is closed and all the maps loaded from it have finished loading.
+        \returns true if the archive was opened, else false
+        */
+        bool openArchive(const char* data, std::size_t size);
+
+        /*!
+        \brief Closes the archive. Buffers already returned by open() remain
+        valid, as long as memory passed to openArchive() does too.
+        */
+        void closeArchive();
+
+        /*!
+        \brief Returns true if an archive is open
+        */
+        bool isArchiveOpen() const { return m_archive != nullptr; }
+
+        /*!
+        \brief Returns the number of files in the open archive
+        */
+        std::size_t getFileCount() const { return m_entries.size(); }
+
+        /*!
+        \brief Returns true if the open archive contains a file at the given path
+        */
+        bool contains(const std::string& path) const;
+
+        bool open(const std::string& path, AssetBuffer& buffer) override;
+
+        /*!
+        \brief Reports the CRC-32 of the file as its modified time, so that
+        caches reload files which change when the archive is reopened.
+        */
+        bool getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize) override;
+
+    private:
+        struct Entry final
+        {
+            std::uint64_t headerOffset = 0;
+            std::uint64_t compressedSize = 0;
+            std::uint64_t size = 0;
+            std::uint32_t crc = 0;
+            std::uint16_t method = 0;
+        };
+
+        //shared with the buffers of stored files so
+        //they outlive the archive being closed
+        std::shared_ptr<AssetBuffer> m_archive;
+        std::unordered_map<std::string, Entry> m_entries;
+
+        bool readDirectory();
+        const Entry* find(const std::string& path) const;
+    };
+}
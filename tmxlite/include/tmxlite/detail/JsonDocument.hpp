@@ -0,0 +1,849 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    /*
+    Parses a JSON document in place. Strings are unescaped and null
+    terminated inside the buffer, as pugixml does with XML, and the
+    document is recorded as a flat array of nodes in document order,
+    so that the only allocation is the node array itself rather than
+    one for each value. Arrays of numbers, such as tile layer data,
+    are recorded as a single node holding their text, which is also
+    null terminated, so that it can be handed straight to the CSV
+    decoder.
+    */
+    class JsonDocument final
+    {
+    public:
+        enum class Type : std::uint8_t
+        {
+            Null, Boolean, Number, String, Array, Object, NumberArray
+        };
+
+        struct Node final
+        {
+            Type type = Type::Null;
+            bool boolean = false;
+            std::uint32_t size = 1; //this node and all of its descendants
+            std::uint32_t length = 0; //of the text
+            const char* text = nullptr; //strings and number arrays are null terminated, numbers are not
+        };
+
+        //the buffer must remain valid, and unmodified, for as long as the document is used
+        bool parse(char* data, std::size_t size)
+        {
+            m_nodes.clear();
+            m_nodes.reserve(size / 64 + 16);
+            m_error.clear();
+
+            m_begin = data;
+            m_current = data;
+            m_end = data + size;
+
+            //skip any byte order mark
+            if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+            {
+                m_current += 3;
+            }
+
+            if (!parseValue(0))
+            {
+                m_nodes.clear();
+                return false;
+            }
+
+            skipWhitespace();
+            if (m_current != m_end && *m_current != 0)
+            {
+                return fail("unexpected data after the document");
+            }
+            return true;
+        }
+
+        //the root value, or nullptr if nothing has been parsed
+        const Node* getRoot() const { return m_nodes.empty() ? nullptr : m_nodes.data(); }
+
+        const std::string& getError() const { return m_error; }
+
+    private:
+        //deeper documents are assumed to be malicious rather than maps
+        static constexpr std::size_t MaxDepth = 256;
+
+        std::vector<Node> m_nodes;
+        std::string m_error;
+
+        const char* m_begin = nullptr;
+        char* m_current = nullptr;
+        char* m_end = nullptr;
+
+        bool fail(const char* message)
+        {
+            if (m_error.empty())
+            {
+                m_error = std::string(message) + " at offset " + std::to_string(m_current - m_begin);
+            }
+            m_nodes.clear();
+            return false;
+        }
+
+        void skipWhitespace()
+        {
+            while (m_current != m_end
+                && (*m_current == ' ' || *m_current == '\n' || *m_current == '\r' || *m_current == '\t'))
+            {
+                ++m_current;
+            }
+        }
+
+        std::size_t push(Type type)
+        {
+            m_nodes.emplace_back();
+            m_nodes.back().type = type;
+            return m_nodes.size() - 1;
+        }
+
+        void close(std::size_t index)
+        {
+            m_nodes[index].size = static_cast<std::uint32_t>(m_nodes.size() - index);
+        }
+
+        bool parseValue(std::size_t depth)
+        {
+            skipWhitespace();
+            if (m_current == m_end)
+            {
+                return fail("unexpected end of document");
+            }
+
+            switch (*m_current)
+            {
+            case '{':
+                return parseObject(depth + 1);
+            case '[':
+                return parseArray(depth + 1);
+            case '"':
+                return parseString();
+            case 't':
+                return parseLiteral("true", Type::Boolean, true);
+            case 'f':
+                return parseLiteral("false", Type::Boolean, false);
+            case 'n':
+                return parseLiteral("null", Type::Null, false);
+            default:
+                return parseNumber();
+            }
+        }
+
+        bool parseObject(std::size_t depth)
+        {
+            if (depth > MaxDepth)
+            {
+                return fail("document is nested too deeply");
+            }
+
+            auto index = push(Type::Object);
+            ++m_current;
+            skipWhitespace();
+
+            if (m_current != m_end && *m_current == '}')
+            {
+                ++m_current;
+                close(index);
+                return true;
+            }
+
+            while (true)
+            {
+                skipWhitespace();
+                if (m_current == m_end || *m_current != '"')
+                {
+                    return fail("expected a member name");
+                }
+
+                if (!parseString())
+                {
+                    return false;
+                }
+
+                skipWhitespace();
+                if (m_current == m_end || *m_current != ':')
+                {
+                    return fail("expected ':'");
+                }
+                ++m_current;
+
+                if (!parseValue(depth))
+                {
+                    return false;
+                }
+
+                skipWhitespace();
+                if (m_current != m_end && *m_current == ',')
+                {
+                    ++m_current;
+                }
+                else if (m_current != m_end && *m_current == '}')
+                {
+                    ++m_current;
+                    close(index);
+                    return true;
+                }
+                else
+                {
+                    return fail("expected ',' or '}'");
+                }
+            }
+        }
+
+        bool parseArray(std::size_t depth)
+        {
+            if (depth > MaxDepth)
+            {
+                return fail("document is nested too deeply");
+            }
+
+            if (parseNumberArray())
+            {
+                return true;
+            }
+
+            auto index = push(Type::Array);
+            ++m_current;
+            skipWhitespace();
+
+            if (m_current != m_end && *m_current == ']')
+            {
+                ++m_current;
+                close(index);
+                return true;
+            }
+
+            while (true)
+            {
+                if (!parseValue(depth))
+                {
+                    return false;
+                }
+
+                skipWhitespace();
+                if (m_current != m_end && *m_current == ',')
+                {
+                    ++m_current;
+                }
+                else if (m_current != m_end && *m_current == ']')
+                {
+                    ++m_current;
+                    close(index);
+                    return true;
+                }
+                else
+                {
+                    return fail("expected ',' or ']'");
+                }
+            }
+        }
+
+        //records arrays of numbers as a single node. Only the first value is
+        //checked, along with the absence of any strings, arrays or objects,
+        //so that the contents can be found with memchr() rather than being
+        //looked at a character at a time. It's left to whoever reads the
+        //array to check the numbers themselves.
+        bool parseNumberArray()
+        {
+            auto* start = m_current + 1;
+            auto* current = start;
+            while (current != m_end && (*current == ' ' || *current == '\n' || *current == '\r' || *current == '\t'))
+            {
+                ++current;
+            }
+
+            if (current == m_end || !((*current >= '0' && *current <= '9') || *current == '-'))
+            {
+                return false;
+            }
+
+            auto* close = static_cast<char*>(std::memchr(current, ']', m_end - current));
+            if (!close
+                || std::memchr(current, '[', close - current)
+                || std::memchr(current, '{', close - current)
+                || std::memchr(current, '"', close - current))
+            {
+                return false;
+            }
+
+            auto index = push(Type::NumberArray);
+            m_nodes[index].text = start;
+            m_nodes[index].length = static_cast<std::uint32_t>(close - start);
+            *close = 0;
+            m_current = close + 1;
+            return true;
+        }
+
+        bool parseLiteral(const char* literal, Type type, bool value)
+        {
+            auto length = std::strlen(literal);
+            if (static_cast<std::size_t>(m_end - m_current) < length
+                || std::memcmp(m_current, literal, length) != 0)
+            {
+                return fail("invalid value");
+            }
+
+            auto index = push(type);
+            m_nodes[index].boolean = value;
+            m_current += length;
+            return true;
+        }
+
+        bool parseNumber()
+        {
+            auto* start = m_current;
+            if (m_current != m_end && *m_current == '-')
+            {
+                ++m_current;
+            }
+
+            const auto digits = [this]()
+            {
+                auto* first = m_current;
+                while (m_current != m_end && *m_current >= '0' && *m_current <= '9')
+                {
+                    ++m_current;
+                }
+                return m_current != first;
+            };
+
+            if (!digits())
+            {
+                return fail("invalid value");
+            }
+
+            if (m_current != m_end && *m_current == '.')
+            {
+                ++m_current;
+                if (!digits())
+                {
+                    return fail("invalid number");
+                }
+            }
+
+            if (m_current != m_end && (*m_current == 'e' || *m_current == 'E'))
+            {
+                ++m_current;
+                if (m_current != m_end && (*m_current == '+' || *m_current == '-'))
+                {
+                    ++m_current;
+                }
+
+                if (!digits())
+                {
+                    return fail("invalid number");
+                }
+            }
+
+            auto index = push(Type::Number);
+            m_nodes[index].text = start;
+            m_nodes[index].length = static_cast<std::uint32_t>(m_current - start);
+            return true;
+        }
+
+        bool parseString()
+        {
+            //the opening quote
+            auto* start = ++m_current;
+
+            auto* quote = static_cast<char*>(std::memchr(start, '"', m_end - start));
+            if (!quote)
+            {
+                return fail("unterminated string");
+            }
+
+            //most strings have nothing to unescape, and long
+            //ones such as base64 layer data never do
+            auto* end = quote;
+            if (std::memchr(start, '\\', quote - start))
+            {
+                end = unescape(start);
+                if (!end)
+                {
+                    return false;
+                }
+                quote = m_current;
+            }
+
+            *end = 0;
+            m_current = quote + 1;
+
+            auto index = push(Type::String);
+            m_nodes[index].text = start;
+            m_nodes[index].length = static_cast<std::uint32_t>(end - start);
+            return true;
+        }
+
+        //unescapes the string starting at m_current in place, returning
+        //the new end of the string, and leaving m_current at the closing quote
+        char* unescape(char* destination)
+        {
+            while (true)
+            {
+                if (m_current == m_end)
+                {
+                    fail("unterminated string");
+                    return nullptr;
+                }
+
+                auto c = *m_current;
+                if (c == '"')
+                {
+                    return destination;
+                }
+
+                if (c != '\\')
+                {
+                    *destination++ = c;
+                    ++m_current;
+                    continue;
+                }
+
+                if (m_end - m_current < 2)
+                {
+                    fail("unterminated string");
+                    return nullptr;
+                }
+
+                c = m_current[1];
+                m_current += 2;
+                switch (c)
+                {
+                case '"': *destination++ = '"'; break;
+                case '\\': *destination++ = '\\'; break;
+                case '/': *destination++ = '/'; break;
+                case 'b': *destination++ = '\b'; break;
+                case 'f': *destination++ = '\f'; break;
+                case 'n': *destination++ = '\n'; break;
+                case 'r': *destination++ = '\r'; break;
+                case 't': *destination++ = '\t'; break;
+                case 'u':
+                {
+                    std::uint32_t codePoint = 0;
+                    if (!readHex(codePoint))
+                    {
+                        return nullptr;
+                    }
+
+                    //surrogate pairs encode code points outside the basic plane
+                    if (codePoint >= 0xd800 && codePoint <= 0xdbff)
+                    {
+                        std::uint32_t low = 0;
+                        if (m_end - m_current < 2 || m_current[0] != '\\' || m_current[1] != 'u')
+                        {
+                            fail("invalid surrogate pair");
+                            return nullptr;
+                        }
+                        m_current += 2;
+
+                        if (!readHex(low) || low < 0xdc00 || low > 0xdfff)
+                        {
+                            fail("invalid surrogate pair");
+                            return nullptr;
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    destination = writeUTF8(destination, codePoint);
+                }
+                    break;
+                default:
+                    fail("invalid escape sequence");
+                    return nullptr;
+                }
+            }
+        }
+
+        bool readHex(std::uint32_t& value)
+        {
+            if (m_end - m_current < 4)
+            {
+                return fail("invalid escape sequence");
+            }
+
+            value = 0;
+            for (auto i = 0; i < 4; ++i)
+            {
+                auto c = *m_current++;
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                {
+                    value |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    value |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    value |= c - 'A' + 10;
+                }
+                else
+                {
+                    return fail("invalid escape sequence");
+                }
+            }
+            return true;
+        }
+
+        //the escape sequence is always longer than its UTF-8
+        //encoding, so this never overtakes the read position
+        static char* writeUTF8(char* destination, std::uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                *destination++ = static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                *destination++ = static_cast<char>(0xc0 | (codePoint >> 6));
+                *destination++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+            }
+            else if (codePoint < 0x10000)
+            {
+                *destination++ = static_cast<char>(0xe0 | (codePoint >> 12));
+                *destination++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+                *destination++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+            }
+            else
+            {
+                *destination++ = static_cast<char>(0xf0 | (codePoint >> 18));
+                *destination++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+                *destination++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+                *destination++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+            }
+            return destination;
+        }
+    };
+
+    /*
+    A read only view of a node in a JsonDocument. Looking up a member
+    which doesn't exist returns an empty value, from which the default
+    values passed to the accessors are returned, much as pugixml does
+    with missing attributes.
+    */
+    class JsonValue final
+    {
+    public:
+        JsonValue() = default;
+        explicit JsonValue(const JsonDocument::Node* node) : m_node(node) {}
+
+        explicit operator bool() const { return m_node != nullptr; }
+
+        JsonDocument::Type getType() const { return m_node ? m_node->type : JsonDocument::Type::Null; }
+
+        bool isObject() const { return getType() == JsonDocument::Type::Object; }
+        bool isArray() const { return getType() == JsonDocument::Type::Array; }
+        bool isString() const { return getType() == JsonDocument::Type::String; }
+        bool isNumber() const { return getType() == JsonDocument::Type::Number; }
+        bool isNumberArray() const { return getType() == JsonDocument::Type::NumberArray; }
+
+        //returns an empty value if this isn't an object or has no such member
+        JsonValue operator [] (const char* name) const
+        {
+            if (!isObject())
+            {
+                return {};
+            }
+
+            //members are stored as a name followed by its value
+            const auto* end = m_node + m_node->size;
+            for (const auto* key = m_node + 1; key != end; key = key + 1 + key[1].size)
+            {
+                if (std::strcmp(key->text, name) == 0)
+                {
+                    return JsonValue(key + 1);
+                }
+            }
+            return {};
+        }
+
+        //calls f(name, value) for each member of an object
+        template <typename F>
+        void forEachMember(F&& f) const
+        {
+            if (!isObject())
+            {
+                return;
+            }
+
+            const auto* end = m_node + m_node->size;
+            for (const auto* key = m_node + 1; key != end; key = key + 1 + key[1].size)
+            {
+                f(key->text, JsonValue(key + 1));
+            }
+        }
+
+        //iterates the elements of an array, or nothing if this isn't an array
+        class Iterator final
+        {
+        public:
+            explicit Iterator(const JsonDocument::Node* node) : m_node(node) {}
+            JsonValue operator * () const { return JsonValue(m_node); }
+            Iterator& operator ++ () { m_node += m_node->size; return *this; }
+            bool operator != (const Iterator& other) const { return m_node != other.m_node; }
+
+        private:
+            const JsonDocument::Node* m_node;
+        };
+
+        //number of elements in an array
+        std::size_t size() const
+        {
+            std::size_t count = 0;
+            for (auto it = begin(); it != end(); ++it)
+            {
+                count++;
+            }
+            return count;
+        }
+
+        Iterator begin() const { return Iterator(isArray() ? m_node + 1 : nullptr); }
+        Iterator end() const { return Iterator(isArray() ? m_node + m_node->size : nullptr); }
+
+        //the text of strings and number arrays, which is null terminated
+        const char* asCString(const char* defaultValue = "") const
+        {
+            return (isString() || isNumberArray()) ? m_node->text : defaultValue;
+        }
+
+        std::string asString(const char* defaultValue = "") const
+        {
+            if (isString())
+            {
+                return std::string(m_node->text, m_node->length);
+            }
+            //numbers are returned as written, eg older maps store their version as one
+            if (isNumber())
+            {
+                return std::string(m_node->text, m_node->length);
+            }
+            return defaultValue;
+        }
+
+        bool asBool(bool defaultValue = false) const
+        {
+            return getType() == JsonDocument::Type::Boolean ? m_node->boolean : defaultValue;
+        }
+
+        double asDouble(double defaultValue = 0.0) const
+        {
+            return isNumber() ? toDouble(m_node->text, m_node->length) : defaultValue;
+        }
+
+        float asFloat(float defaultValue = 0.f) const
+        {
+            return static_cast<float>(asDouble(defaultValue));
+        }
+
+        //fractions are truncated, and values out of range clamped
+        std::int64_t asInt64(std::int64_t defaultValue = 0) const
+        {
+            if (!isNumber())
+            {
+                return defaultValue;
+            }
+
+            std::int64_t value = 0;
+            if (toInteger(m_node->text, m_node->length, value))
+            {
+                return value;
+            }
+
+            auto result = toDouble(m_node->text, m_node->length);
+            if (result >= 9.2e18)
+            {
+                return std::numeric_limits<std::int64_t>::max();
+            }
+            if (result <= -9.2e18)
+            {
+                return std::numeric_limits<std::int64_t>::min();
+            }
+            return static_cast<std::int64_t>(result);
+        }
+
+        std::int32_t asInt(std::int32_t defaultValue = 0) const
+        {
+            auto value = asInt64(defaultValue);
+            if (value > std::numeric_limits<std::int32_t>::max())
+            {
+                return std::numeric_limits<std::int32_t>::max();
+            }
+            if (value < std::numeric_limits<std::int32_t>::min())
+            {
+                return std::numeric_limits<std::int32_t>::min();
+            }
+            return static_cast<std::int32_t>(value);
+        }
+
+        //negative values return 0
+        std::uint32_t asUInt(std::uint32_t defaultValue = 0) const
+        {
+            auto value = asInt64(defaultValue);
+            if (value < 0)
+            {
+                return 0;
+            }
+            if (value > std::numeric_limits<std::uint32_t>::max())
+            {
+                return std::numeric_limits<std::uint32_t>::max();
+            }
+            return static_cast<std::uint32_t>(value);
+        }
+
+    private:
+        const JsonDocument::Node* m_node = nullptr;
+
+        //returns false if the number isn't a plain integer or won't fit
+        static bool toInteger(const char* text, std::size_t length, std::int64_t& value)
+        {
+            bool negative = (length != 0 && *text == '-');
+            std::size_t i = negative ? 1 : 0;
+
+            //up to 18 digits can't overflow
+            if (length - i > 18)
+            {
+                return false;
+            }
+
+            std::int64_t result = 0;
+            for (; i < length; ++i)
+            {
+                if (text[i] < '0' || text[i] > '9')
+                {
+                    return false;
+                }
+                result = result * 10 + (text[i] - '0');
+            }
+            value = negative ? -result : result;
+            return true;
+        }
+
+        //the text has already been validated by the parser. This doesn't
+        //round correctly in every case, which makes no difference once
+        //the result is stored as a float
+        static double toDouble(const char* text, std::size_t length)
+        {
+            static const double powers[] =
+            {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            const auto* end = text + length;
+            bool negative = (text != end && *text == '-');
+            if (negative)
+            {
+                ++text;
+            }
+
+            std::uint64_t mantissa = 0;
+            std::int32_t exponent = 0;
+            std::int32_t digitCount = 0;
+            const auto addDigit = [&](char c)
+            {
+                if (digitCount < 19)
+                {
+                    mantissa = mantissa * 10 + (c - '0');
+                    if (mantissa != 0)
+                    {
+                        digitCount++;
+                    }
+                    return true;
+                }
+                return false;
+            };
+
+            for (; text != end && *text >= '0' && *text <= '9'; ++text)
+            {
+                if (!addDigit(*text))
+                {
+                    exponent++;
+                }
+            }
+
+            if (text != end && *text == '.')
+            {
+                for (++text; text != end && *text >= '0' && *text <= '9'; ++text)
+                {
+                    if (addDigit(*text))
+                    {
+                        exponent--;
+                    }
+                }
+            }
+
+            if (text != end && (*text == 'e' || *text == 'E'))
+            {
+                ++text;
+                bool negativeExponent = (text != end && *text == '-');
+                if (text != end && (*text == '-' || *text == '+'))
+                {
+                    ++text;
+                }
+
+                std::int32_t value = 0;
+                for (; text != end && *text >= '0' && *text <= '9'; ++text)
+                {
+                    if (value < 10000)
+                    {
+                        value = value * 10 + (*text - '0');
+                    }
+                }
+                exponent += negativeExponent ? -value : value;
+            }
+
+            auto result = static_cast<double>(mantissa);
+            while (exponent > 22)
+            {
+                result *= 1e22;
+                exponent -= 22;
+            }
+            while (exponent < -22)
+            {
+                result /= 1e22;
+                exponent += 22;
+            }
+            result = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+            return negative ? -result : result;
+        }
+    };
+}
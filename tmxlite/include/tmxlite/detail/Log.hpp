@@ -37,6 +37,7 @@ source distribution.
 #include <sstream>
 #include <list>
 #include <ctime>
+#include <mutex>
 
 #ifdef _MSC_VER
 #define NOMINMAX
@@ -86,6 +87,9 @@ namespace tmx
         */
         static void log(const std::string& message, Type type = Type::Info, Output output = Output::Console)
         {
+            //maps may be loaded on more than one thread
+            std::lock_guard<std::recursive_mutex> lock(mutex());
+
             std::string outstring;
             switch (type)
             {
@@ -161,6 +165,7 @@ namespace tmx
         static const std::string& bufferString(){ return stringOutput(); }
 
     private:
+        static std::recursive_mutex& mutex(){ static std::recursive_mutex mutex; return mutex; }
         static std::list<std::string>& buffer(){ static std::list<std::string> buffer; return buffer; }
         static std::string& stringOutput() { static std::string output; return output; }
         static void updateOutString(std::size_t maxBuffer)
@@ -0,0 +1,372 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+namespace tmx
+{
+    /*
+    Presents a block of memory as an input stream, so that the buffers
+    returned by an AssetProvider can be read by an XmlStream.
+    */
+    class MemoryStreamBuf : public std::streambuf
+    {
+    public:
+        MemoryStreamBuf(const char* data, std::size_t size)
+        {
+            //the get area is only ever read from
+            auto* begin = const_cast<char*>(data);
+            setg(begin, begin, begin + size);
+        }
+    };
+
+    class MemoryStream final : private MemoryStreamBuf, public std::istream
+    {
+    public:
+        MemoryStream(const char* data, std::size_t size)
+            : MemoryStreamBuf(data, size),
+            std::istream(this)
+        {
+
+        }
+    };
+
+    /*
+    Splits an XML document into tags, reading it from a stream as
+    it goes. Only the current tag or element is kept in memory. This
+    does no validation - whole elements are handed to pugixml which
+    takes care of that - it only needs to be able to find where each
+    element starts and ends.
+    */
+    class XmlStream final
+    {
+    public:
+        enum class Token
+        {
+            Start, End, EndOfFile, Error
+        };
+
+        explicit XmlStream(std::istream& stream)
+            : m_stream      (stream),
+            m_position      (0),
+            m_tagStart      (0),
+            m_tagEnd        (0),
+            m_selfClosing   (false)
+        {
+
+        }
+
+        //reads up to and including the next start or end tag,
+        //skipping any text, comments and declarations before it
+        Token next()
+        {
+            //anything before the read position has been dealt with. It's
+            //only discarded once it makes up most of the buffer, so that
+            //the remainder isn't moved to the front for every tag
+            if (m_position > m_buffer.size() / 2)
+            {
+                m_buffer.erase(0, m_position);
+                m_position = 0;
+            }
+
+            while (true)
+            {
+                auto start = m_buffer.find('<', m_position);
+                if (start == std::string::npos)
+                {
+                    //text between elements is of no interest
+                    m_buffer.clear();
+                    m_position = 0;
+                    if (!more())
+                    {
+                        return Token::EndOfFile;
+                    }
+                    continue;
+                }
+
+                std::size_t end = 0;
+                if (!skipMarkup(start, end))
+                {
+                    return Token::Error;
+                }
+
+                if (end != 0)
+                {
+                    m_position = end;
+                    continue;
+                }
+
+                if (!findTagEnd(start, end))
+                {
+                    return Token::Error;
+                }
+
+                m_tagStart = start;
+                m_tagEnd = end + 1;
+                m_position = m_tagEnd;
+
+                if (m_buffer[start + 1] == '/')
+                {
+                    m_name = readName(start + 2);
+                    return Token::End;
+                }
+
+                m_name = readName(start + 1);
+                m_selfClosing = (m_buffer[end - 1] == '/');
+                return Token::Start;
+            }
+        }
+
+        //name of the tag last returned by next()
+        const std::string& name() const { return m_name; }
+
+        //true if the start tag last returned by next() has no contents
+        bool selfClosing() const { return m_selfClosing; }
+
+        //returns a copy of the last start tag, closed so that it
+        //can be parsed as an element with no contents
+        std::string tag() const
+        {
+            std::string tag = m_buffer.substr(m_tagStart, m_tagEnd - m_tagStart);
+            if (!m_selfClosing)
+            {
+                tag.insert(tag.size() - 1, 1, '/');
+            }
+            return tag;
+        }
+
+        //reads the remainder of the element opened by the last start
+        //tag, and returns the whole element including the start tag.
+        //The data remains valid until the next call to next()
+        bool element(char*& data, std::size_t& size)
+        {
+            auto position = m_tagEnd;
+            auto depth = m_selfClosing ? 0 : 1;
+            while (depth != 0)
+            {
+                auto start = position;
+                if (!find("<", start))
+                {
+                    return false;
+                }
+
+                std::size_t end = 0;
+                if (!skipMarkup(start, end))
+                {
+                    return false;
+                }
+
+                if (end == 0)
+                {
+                    if (!findTagEnd(start, end))
+                    {
+                        return false;
+                    }
+
+                    if (m_buffer[start + 1] == '/')
+                    {
+                        depth--;
+                    }
+                    else if (m_buffer[end - 1] != '/')
+                    {
+                        depth++;
+                    }
+                    end++;
+                }
+                position = end;
+            }
+
+            m_position = position;
+            data = &m_buffer[m_tagStart];
+            size = m_position - m_tagStart;
+            return true;
+        }
+
+        //skips the remainder of the element opened by the last start tag.
+        //Unlike element() nothing is kept, so the memory used doesn't
+        //depend on the size of the element
+        bool skip()
+        {
+            auto depth = m_selfClosing ? 0 : 1;
+            while (depth != 0)
+            {
+                switch (next())
+                {
+                default:
+                    Logger::log("Unexpected end of map data", Logger::Type::Error);
+                    return false;
+                case Token::Start:
+                    depth += m_selfClosing ? 0 : 1;
+                    break;
+                case Token::End:
+                    depth--;
+                    break;
+                }
+            }
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t BlockSize = 64 * 1024;
+
+        std::istream& m_stream;
+        std::string m_buffer;
+        std::size_t m_position;
+
+        std::size_t m_tagStart;
+        std::size_t m_tagEnd;
+        std::string m_name;
+        bool m_selfClosing;
+
+        //appends the next block of the stream to the buffer
+        bool more()
+        {
+            const auto size = m_buffer.size();
+            m_buffer.resize(size + BlockSize);
+            m_stream.read(&m_buffer[size], BlockSize);
+            m_buffer.resize(size + static_cast<std::size_t>(m_stream.gcount()));
+            return m_buffer.size() != size;
+        }
+
+        bool startsWith(std::size_t position, const char* str)
+        {
+            const auto length = std::strlen(str);
+            while (m_buffer.size() < position + length)
+            {
+                if (!more())
+                {
+                    return false;
+                }
+            }
+            return m_buffer.compare(position, length, str) == 0;
+        }
+
+        //finds str at or after position, reading more of the stream as needed
+        bool find(const char* str, std::size_t& position)
+        {
+            const auto length = std::strlen(str);
+            auto from = position;
+            while (true)
+            {
+                auto result = m_buffer.find(str, from);
+                if (result != std::string::npos)
+                {
+                    position = result;
+                    return true;
+                }
+
+                if (m_buffer.size() >= length)
+                {
+                    from = std::max(from, m_buffer.size() - length + 1);
+                }
+
+                if (!more())
+                {
+                    return false;
+                }
+            }
+        }
+
+        //finds the closing bracket of the tag opened at position,
+        //ignoring any which appear in attribute values
+        bool findTagEnd(std::size_t position, std::size_t& end)
+        {
+            char quote = 0;
+            for (auto i = position + 1;; ++i)
+            {
+                if (i == m_buffer.size() && !more())
+                {
+                    Logger::log("Unexpected end of map data inside a tag", Logger::Type::Error);
+                    return false;
+                }
+
+                const auto c = m_buffer[i];
+                if (quote)
+                {
+                    if (c == quote)
+                    {
+                        quote = 0;
+                    }
+                }
+                else if (c == '"' || c == '\'')
+                {
+                    quote = c;
+                }
+                else if (c == '>')
+                {
+                    end = i;
+                    return true;
+                }
+            }
+        }
+
+        //if the markup at position is a comment, CDATA section or declaration
+        //then end is set to the position after it, else it is left as 0
+        bool skipMarkup(std::size_t position, std::size_t& end)
+        {
+            static const std::array<std::pair<const char*, const char*>, 4u> markup =
+            {
+                std::make_pair("<!--", "-->"),
+                std::make_pair("<![CDATA[", "]]>"),
+                std::make_pair("<?", "?>"),
+                std::make_pair("<!", ">")
+            };
+
+            for (const auto& m : markup)
+            {
+                if (startsWith(position, m.first))
+                {
+                    end = position + std::strlen(m.first);
+                    if (!find(m.second, end))
+                    {
+                        Logger::log("Unexpected end of map data inside " + std::string(m.first), Logger::Type::Error);
+                        return false;
+                    }
+                    end += std::strlen(m.second);
+                    return true;
+                }
+            }
+            return true;
+        }
+
+        std::string readName(std::size_t position) const
+        {
+            auto end = m_buffer.find_first_of(" \t\r\n/>", position);
+            return m_buffer.substr(position, end - position);
+        }
+    };
+}
@@ -0,0 +1,135 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+
+using namespace tmx;
+
+//public
+void AssetBuffer::setMappedFile(MappedFile&& file)
+{
+    clear();
+    m_file = std::move(file);
+    m_storage = Storage::Mapped;
+}
+
+void AssetBuffer::setString(std::string&& data)
+{
+    clear();
+    m_string = std::move(data);
+    m_storage = Storage::String;
+}
+
+void AssetBuffer::setBorrowed(const char* data, std::size_t size, std::shared_ptr<const void> owner)
+{
+    clear();
+    m_borrowed = data;
+    m_borrowedSize = size;
+    m_owner = std::move(owner);
+    m_storage = Storage::Borrowed;
+}
+
+void AssetBuffer::clear()
+{
+    m_file.close();
+    m_string.clear();
+    m_borrowed = nullptr;
+    m_borrowedSize = 0;
+    m_owner.reset();
+    m_storage = Storage::None;
+}
+
+const char* AssetBuffer::data() const
+{
+    switch (m_storage)
+    {
+    default: return nullptr;
+    case Storage::Mapped: return m_file.data();
+    case Storage::String: return m_string.data();
+    case Storage::Borrowed: return m_borrowed;
+    }
+}
+
+char* AssetBuffer::getMutableData()
+{
+    switch (m_storage)
+    {
+    default: return nullptr;
+    case Storage::Mapped: return m_file.data();
+    case Storage::String: return &m_string[0];
+    case Storage::Borrowed:
+        //the owner of borrowed memory doesn't expect it to change
+        setString(std::string(m_borrowed, m_borrowedSize));
+        return &m_string[0];
+    }
+}
+
+std::size_t AssetBuffer::size() const
+{
+    switch (m_storage)
+    {
+    default: return 0;
+    case Storage::Mapped: return m_file.size();
+    case Storage::String: return m_string.size();
+    case Storage::Borrowed: return m_borrowedSize;
+    }
+}
+
+bool AssetProvider::getFileInfo(const std::string&, std::int64_t&, std::int64_t&)
+{
+    return false;
+}
+
+AssetProvider& AssetProvider::getDefault()
+{
+    static FileSystemProvider provider;
+    return provider;
+}
+
+bool FileSystemProvider::open(const std::string& path, AssetBuffer& buffer)
+{
+    MappedFile file;
+    if (file.open(path))
+    {
+        buffer.setMappedFile(std::move(file));
+        return true;
+    }
+
+    std::string contents;
+    if (readFileIntoString(path, &contents))
+    {
+        buffer.setString(std::move(contents));
+        return true;
+    }
+    return false;
+}
+
+bool FileSystemProvider::getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize)
+{
+    return tmx::getFileInfo(path, modifiedTime, fileSize);
+}
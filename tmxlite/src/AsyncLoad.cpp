@@ -0,0 +1,107 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/AsyncLoad.hpp>
+
+using namespace tmx;
+
+AsyncLoad::~AsyncLoad()
+{
+    cancel();
+    wait();
+}
+
+AsyncLoad& AsyncLoad::operator = (AsyncLoad&& other) noexcept
+{
+    if (this != &other)
+    {
+        cancel();
+        wait();
+
+        m_state = std::move(other.m_state);
+        m_thread = std::move(other.m_thread);
+    }
+    return *this;
+}
+
+//public
+bool AsyncLoad::isReady() const
+{
+    return m_state && m_state->finished;
+}
+
+void AsyncLoad::wait()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool AsyncLoad::get()
+{
+    wait();
+    return m_state && m_state->result;
+}
+
+void AsyncLoad::cancel()
+{
+    if (m_state)
+    {
+        m_state->cancelled = true;
+    }
+}
+
+bool AsyncLoad::isCancelled() const
+{
+    return m_state && m_state->cancelled;
+}
+
+AsyncLoad::Progress AsyncLoad::getProgress() const
+{
+    return m_state ? m_state->getProgress() : Progress();
+}
+
+//private
+AsyncLoad::Progress AsyncLoad::State::getProgress() const
+{
+    Progress progress;
+    progress.bytesParsed = bytesParsed;
+    progress.totalBytes = totalBytes;
+    progress.layersLoaded = layersLoaded;
+    progress.totalLayers = totalLayers;
+    return progress;
+}
+
+void AsyncLoad::State::report()
+{
+    if (callback)
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        callback(getProgress());
+    }
+}
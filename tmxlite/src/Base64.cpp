@@ -0,0 +1,496 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+/*
+The vector paths below decode whole blocks of input at a time and
+bail out as soon as a block contains anything which is not part of
+the base64 alphabet (padding, whitespace or garbage). The scalar
+loop then takes over until it is safe to try a vector block again,
+so the vector code never has to deal with any special cases.
+
+The x86 translation/packing steps follow the approach described by
+Wojciech Mula and Daniel Lemire in "Faster Base64 Encoding and
+Decoding Using AVX2 Instructions" (2018).
+*/
+
+#include <tmxlite/FreeFuncs.hpp>
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TMXLITE_BASE64_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TMXLITE_BASE64_NEON
+#include <arm_neon.h>
+#endif
+
+//the MSVC intrinsics are always available, gcc and clang need
+//telling which functions they may generate vector code for
+#if defined(TMXLITE_BASE64_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TMXLITE_TARGET(x) __attribute__((target(x)))
+#else
+#define TMXLITE_TARGET(x)
+#endif
+
+namespace
+{
+    //values in the decode table >= 64 mark characters which
+    //are not part of the base64 alphabet
+    constexpr std::uint8_t Whitespace = 0xfd;
+    constexpr std::uint8_t Padding = 0xfe;
+    constexpr std::uint8_t Invalid = 0xff;
+
+    struct DecodeTable final
+    {
+        std::uint8_t values[256];
+
+        constexpr DecodeTable()
+            : values()
+        {
+            for (auto& v : values)
+            {
+                v = Invalid;
+            }
+
+            const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (auto i = 0u; i < 64u; ++i)
+            {
+                values[static_cast<std::uint8_t>(alphabet[i])] = static_cast<std::uint8_t>(i);
+            }
+
+            values[' '] = values['\t'] = values['\n'] = values['\r'] = Whitespace;
+            values['='] = Padding;
+        }
+
+        constexpr std::uint8_t operator [] (std::uint8_t c) const { return values[c]; }
+    };
+
+    constexpr DecodeTable decodeTable;
+
+    //decodes as many whole blocks as possible, advancing both
+    //pointers. Stops at the first block containing anything
+    //other than the base64 alphabet.
+    using BlockDecoder = void(*)(const std::uint8_t*&, const std::uint8_t*, std::uint8_t*&, const std::uint8_t*);
+
+    void decodeBlocksScalar(const std::uint8_t*& in, const std::uint8_t* inEnd, std::uint8_t*& out, const std::uint8_t* outEnd)
+    {
+        while (inEnd - in >= 4 && outEnd - out >= 3)
+        {
+            std::uint32_t a = decodeTable[in[0]];
+            std::uint32_t b = decodeTable[in[1]];
+            std::uint32_t c = decodeTable[in[2]];
+            std::uint32_t d = decodeTable[in[3]];
+            if ((a | b | c | d) & 0xc0)
+            {
+                return;
+            }
+
+            std::uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
+            out[0] = static_cast<std::uint8_t>(value >> 16);
+            out[1] = static_cast<std::uint8_t>(value >> 8);
+            out[2] = static_cast<std::uint8_t>(value);
+
+            in += 4;
+            out += 3;
+        }
+    }
+
+#ifdef TMXLITE_BASE64_X86
+    TMXLITE_TARGET("ssse3")
+    void decodeBlocksSSSE3(const std::uint8_t*& in, const std::uint8_t* inEnd, std::uint8_t*& out, const std::uint8_t* outEnd)
+    {
+        const __m128i lutLo = _mm_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lutHi = _mm_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lutRoll = _mm_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2F);
+        const __m128i packShuffle = _mm_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        //each block reads 16 characters and stores 16 bytes, 12 of which are valid
+        while (inEnd - in >= 16 && outEnd - out >= 16)
+        {
+            __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+
+            const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+            const __m128i loNibbles = _mm_and_si128(str, mask2F);
+            const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+            const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+
+            if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+            {
+                return;
+            }
+
+            const __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+            const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+            str = _mm_add_epi8(str, roll);
+
+            //pack the 6 bit values into 3 byte groups
+            const __m128i mergeAB = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+            __m128i packed = _mm_madd_epi16(mergeAB, _mm_set1_epi32(0x00011000));
+            packed = _mm_shuffle_epi8(packed, packShuffle);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+
+            in += 16;
+            out += 12;
+        }
+    }
+
+    TMXLITE_TARGET("avx2")
+    void decodeBlocksAVX2(const std::uint8_t*& in, const std::uint8_t* inEnd, std::uint8_t*& out, const std::uint8_t* outEnd)
+    {
+        const __m256i lutLo = _mm256_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i lutHi = _mm256_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i lutRoll = _mm256_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i mask2F = _mm256_set1_epi8(0x2F);
+        const __m256i packShuffle = _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i packPermute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+        //each block reads 32 characters and stores 32 bytes, 24 of which are valid
+        while (inEnd - in >= 32 && outEnd - out >= 32)
+        {
+            __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+
+            const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+            const __m256i loNibbles = _mm256_and_si256(str, mask2F);
+            const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+            const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+
+            if (!_mm256_testz_si256(lo, hi))
+            {
+                return;
+            }
+
+            const __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+            const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+            str = _mm256_add_epi8(str, roll);
+
+            const __m256i mergeAB = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+            __m256i packed = _mm256_madd_epi16(mergeAB, _mm256_set1_epi32(0x00011000));
+            packed = _mm256_shuffle_epi8(packed, packShuffle);
+            packed = _mm256_permutevar8x32_epi32(packed, packPermute);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+
+            in += 32;
+            out += 24;
+        }
+
+        //finish off anything left which is big enough for a 128 bit block
+        decodeBlocksSSSE3(in, inEnd, out, outEnd);
+    }
+
+    BlockDecoder selectBlockDecoder()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        const bool hasSSSE3 = (info[2] & (1 << 9)) != 0;
+        const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+
+        bool hasAVX2 = false;
+        if (maxLeaf >= 7 && hasOSXSave
+            && (_xgetbv(0) & 0x6) == 0x6) //OS saves YMM registers
+        {
+            __cpuidex(info, 7, 0);
+            hasAVX2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        const bool hasSSSE3 = __builtin_cpu_supports("ssse3");
+        const bool hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+        if (hasAVX2)
+        {
+            return decodeBlocksAVX2;
+        }
+
+        if (hasSSSE3)
+        {
+            return decodeBlocksSSSE3;
+        }
+        return decodeBlocksScalar;
+    }
+
+#elif defined(TMXLITE_BASE64_NEON)
+    void decodeBlocksNEON(const std::uint8_t*& in, const std::uint8_t* inEnd, std::uint8_t*& out, const std::uint8_t* outEnd)
+    {
+        //the decode table split in two 64 byte halves, so that
+        //each half can be used with a single 4 register lookup
+        uint8x16x4_t tableLo;
+        uint8x16x4_t tableHi;
+        for (auto i = 0; i < 4; ++i)
+        {
+            tableLo.val[i] = vld1q_u8(decodeTable.values + (i * 16));
+            tableHi.val[i] = vld1q_u8(decodeTable.values + 64 + (i * 16));
+        }
+        const uint8x16_t offset = vdupq_n_u8(64);
+        const uint8x16_t maxValue = vdupq_n_u8(63);
+
+        //each block reads 64 characters and writes 48 bytes
+        while (inEnd - in >= 64 && outEnd - out >= 48)
+        {
+            uint8x16x4_t str = vld4q_u8(in);
+
+            //any byte >= 128 is out of range of both tables and
+            //returns 0 from each, so needs to be checked separately
+            uint8x16_t error = vorrq_u8(vorrq_u8(str.val[0], str.val[1]), vorrq_u8(str.val[2], str.val[3]));
+            error = vcgeq_u8(error, vdupq_n_u8(128));
+
+            for (auto i = 0; i < 4; ++i)
+            {
+                const uint8x16_t lo = vqtbl4q_u8(tableLo, str.val[i]);
+                const uint8x16_t hi = vqtbl4q_u8(tableHi, vsubq_u8(str.val[i], offset));
+                str.val[i] = vorrq_u8(lo, hi);
+                error = vorrq_u8(error, vcgtq_u8(str.val[i], maxValue));
+            }
+
+            if (vmaxvq_u8(error) != 0)
+            {
+                return;
+            }
+
+            uint8x16x3_t packed;
+            packed.val[0] = vorrq_u8(vshlq_n_u8(str.val[0], 2), vshrq_n_u8(str.val[1], 4));
+            packed.val[1] = vorrq_u8(vshlq_n_u8(str.val[1], 4), vshrq_n_u8(str.val[2], 2));
+            packed.val[2] = vorrq_u8(vshlq_n_u8(str.val[2], 6), str.val[3]);
+            vst3q_u8(out, packed);
+
+            in += 64;
+            out += 48;
+        }
+    }
+
+    BlockDecoder selectBlockDecoder()
+    {
+        return decodeBlocksNEON;
+    }
+#else
+    BlockDecoder selectBlockDecoder()
+    {
+        return decodeBlocksScalar;
+    }
+#endif
+
+}
+
+std::size_t tmx::base64_decode(const char* src, std::size_t srcLen, unsigned char* dst, std::size_t dstSize, std::size_t* srcUsed)
+{
+    static const BlockDecoder decodeBlocks = selectBlockDecoder();
+
+    const auto* in = reinterpret_cast<const std::uint8_t*>(src);
+    const auto* inEnd = in + srcLen;
+    auto* out = dst;
+    const auto* outEnd = dst + dstSize;
+
+    //when a block fails to decode we step through this many
+    //characters one at a time before trying another block
+    static const std::size_t ScalarRun = 64;
+    std::size_t scalarCount = 0;
+
+    //start of the group currently being decoded, so that we
+    //can resume from here if the output fills up part way
+    const auto* groupStart = in;
+    std::uint32_t value = 0;
+    std::uint32_t count = 0;
+
+    auto finish = [&](const std::uint8_t* position)
+    {
+        if (srcUsed)
+        {
+            *srcUsed = static_cast<std::size_t>(position - reinterpret_cast<const std::uint8_t*>(src));
+        }
+        return static_cast<std::size_t>(out - dst);
+    };
+
+    while (in != inEnd)
+    {
+        if (count == 0 && scalarCount == 0)
+        {
+            const auto* start = in;
+            decodeBlocks(in, inEnd, out, outEnd);
+            groupStart = in;
+
+            if (in == inEnd)
+            {
+                break;
+            }
+
+            if (in == start)
+            {
+                scalarCount = ScalarRun;
+            }
+        }
+
+        const auto c = decodeTable[*in];
+        if (c == Whitespace)
+        {
+            in++;
+        }
+        else if (c < 64)
+        {
+            in++;
+            value = (value << 6) | c;
+            if (++count == 4)
+            {
+                if (outEnd - out < 3)
+                {
+                    if (srcUsed)
+                    {
+                        //resume from the start of this group next time
+                        return finish(groupStart);
+                    }
+
+                    //output is full so write what fits and stop
+                    for (auto shift = 16; shift >= 0 && out != outEnd; shift -= 8)
+                    {
+                        *out++ = static_cast<std::uint8_t>(value >> shift);
+                    }
+                    return finish(in);
+                }
+
+                out[0] = static_cast<std::uint8_t>(value >> 16);
+                out[1] = static_cast<std::uint8_t>(value >> 8);
+                out[2] = static_cast<std::uint8_t>(value);
+                out += 3;
+
+                value = 0;
+                count = 0;
+                groupStart = in;
+            }
+        }
+        else
+        {
+            //padding marks the end of the data, and anything
+            //else isn't valid so we stop there too
+            break;
+        }
+
+        if (scalarCount)
+        {
+            scalarCount--;
+        }
+    }
+
+    //flush any partial group - 2 characters make 1 byte, 3 make 2
+    if (count > 1)
+    {
+        if (srcUsed && static_cast<std::uint32_t>(outEnd - out) < count - 1)
+        {
+            return finish(groupStart);
+        }
+
+        value <<= 6 * (4 - count);
+        for (auto i = 0u; i < count - 1 && out != outEnd; ++i)
+        {
+            *out++ = static_cast<std::uint8_t>(value >> (16 - (i * 8)));
+        }
+    }
+
+    return finish(in);
+}
+
+std::string tmx::base64_decode(const std::string& encoded_string)
+{
+    std::string ret(((encoded_string.size() + 3) / 4) * 3, '\0');
+    auto size = base64_decode(encoded_string.data(), encoded_string.size(), reinterpret_cast<unsigned char*>(&ret[0]), ret.size());
+    ret.resize(size);
+    return ret;
+}
+
+std::size_t tmx::base64_encode(const unsigned char* src, std::size_t srcLen, char* dst)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    auto* out = dst;
+    const auto* end = src + (srcLen - srcLen % 3);
+    for (; src != end; src += 3)
+    {
+        std::uint32_t group = (std::uint32_t(src[0]) << 16) | (std::uint32_t(src[1]) << 8) | src[2];
+        out[0] = alphabet[group >> 18];
+        out[1] = alphabet[(group >> 12) & 0x3f];
+        out[2] = alphabet[(group >> 6) & 0x3f];
+        out[3] = alphabet[group & 0x3f];
+        out += 4;
+    }
+
+    switch (srcLen % 3)
+    {
+    default: break;
+    case 1:
+        out[0] = alphabet[src[0] >> 2];
+        out[1] = alphabet[(src[0] & 0x3) << 4];
+        out[2] = '=';
+        out[3] = '=';
+        out += 4;
+        break;
+    case 2:
+        out[0] = alphabet[src[0] >> 2];
+        out[1] = alphabet[((src[0] & 0x3) << 4) | (src[1] >> 4)];
+        out[2] = alphabet[(src[1] & 0xf) << 2];
+        out[3] = '=';
+        out += 4;
+        break;
+    }
+
+    return static_cast<std::size_t>(out - dst);
+}
+
+std::string tmx::base64_encode(const std::string& data)
+{
+    std::string ret(((data.size() + 2) / 3) * 4, '\0');
+    base64_encode(reinterpret_cast<const unsigned char*>(data.data()), data.size(), &ret[0]);
+    return ret;
+}
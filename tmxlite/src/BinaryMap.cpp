@@ -0,0 +1,940 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/BinaryMap.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace tmx;
+
+namespace
+{
+    const char Magic[] = { 'T', 'M', 'X', 'B' };
+
+    //magic, format version, payload size and checksum
+    constexpr std::size_t HeaderSize = 24;
+
+    std::uint32_t load32(const unsigned char* data)
+    {
+        return static_cast<std::uint32_t>(data[0])
+            | (static_cast<std::uint32_t>(data[1]) << 8)
+            | (static_cast<std::uint32_t>(data[2]) << 16)
+            | (static_cast<std::uint32_t>(data[3]) << 24);
+    }
+
+    std::uint64_t load64(const unsigned char* data)
+    {
+        return static_cast<std::uint64_t>(load32(data))
+            | (static_cast<std::uint64_t>(load32(data + 4)) << 32);
+    }
+
+    void store32(unsigned char* data, std::uint32_t value)
+    {
+        data[0] = static_cast<unsigned char>(value);
+        data[1] = static_cast<unsigned char>(value >> 8);
+        data[2] = static_cast<unsigned char>(value >> 16);
+        data[3] = static_cast<unsigned char>(value >> 24);
+    }
+
+    void store64(unsigned char* data, std::uint64_t value)
+    {
+        store32(data, static_cast<std::uint32_t>(value));
+        store32(data + 4, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    class Writer final
+    {
+    public:
+        explicit Writer(std::vector<char>& destination)
+            : m_destination(destination) {}
+
+        void u8(std::uint8_t value)
+        {
+            m_destination.push_back(static_cast<char>(value));
+        }
+
+        void u32(std::uint32_t value)
+        {
+            unsigned char bytes[4];
+            store32(bytes, value);
+            m_destination.insert(m_destination.end(), bytes, bytes + 4);
+        }
+
+        void i32(std::int32_t value) { u32(static_cast<std::uint32_t>(value)); }
+
+        void f32(float value)
+        {
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            u32(bits);
+        }
+
+        void boolean(bool value) { u8(value ? 1 : 0); }
+
+        void size(std::size_t value) { u32(static_cast<std::uint32_t>(value)); }
+
+        void string(const std::string& value)
+        {
+            size(value.size());
+            m_destination.insert(m_destination.end(), value.begin(), value.end());
+        }
+
+        void colour(const Colour& value)
+        {
+            u8(value.r);
+            u8(value.g);
+            u8(value.b);
+            u8(value.a);
+        }
+
+        void vector(const Vector2u& value) { u32(value.x); u32(value.y); }
+        void vector(const Vector2i& value) { i32(value.x); i32(value.y); }
+        void vector(const Vector2f& value) { f32(value.x); f32(value.y); }
+
+        template <typename T>
+        void enumeration(T value) { u8(static_cast<std::uint8_t>(value)); }
+
+        //packs the tiles as global IDs, aligned so the
+        //array could be read directly from the file
+        void tiles(const std::vector<TileLayer::Tile>& tiles)
+        {
+            size(tiles.size());
+            while (m_destination.size() % 4 != 0)
+            {
+                u8(0);
+            }
+
+            auto offset = m_destination.size();
+            m_destination.resize(offset + tiles.size() * 4);
+            auto* dest = reinterpret_cast<unsigned char*>(m_destination.data() + offset);
+            for (const auto& tile : tiles)
+            {
+                store32(dest, tile.getGID());
+                dest += 4;
+            }
+        }
+
+    private:
+        std::vector<char>& m_destination;
+    };
+
+    //reads values from a buffer, flagging an error rather than
+    //reading past the end. Once an error is flagged all further
+    //reads return default values.
+    class Reader final
+    {
+    public:
+        Reader(const char* data, std::size_t size)
+            : m_data(reinterpret_cast<const unsigned char*>(data)), m_size(size), m_position(0), m_failed(false) {}
+
+        bool failed() const { return m_failed; }
+
+        void fail() { m_failed = true; }
+
+        std::uint8_t u8()
+        {
+            if (!available(1))
+            {
+                return 0;
+            }
+            return m_data[m_position++];
+        }
+
+        std::uint32_t u32()
+        {
+            if (!available(4))
+            {
+                return 0;
+            }
+            auto value = load32(m_data + m_position);
+            m_position += 4;
+            return value;
+        }
+
+        std::int32_t i32() { return static_cast<std::int32_t>(u32()); }
+
+        float f32()
+        {
+            auto bits = u32();
+            float value = 0.f;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        bool boolean() { return u8() != 0; }
+
+        //reads an element count, failing if there aren't enough bytes
+        //left for that many elements of at least the given size, so
+        //that a corrupt count never causes a huge allocation
+        std::size_t count(std::size_t elementSize)
+        {
+            std::size_t value = u32();
+            if (value != 0 && !available(value * elementSize))
+            {
+                return 0;
+            }
+            return value;
+        }
+
+        std::string string()
+        {
+            auto length = count(1);
+            std::string value(reinterpret_cast<const char*>(m_data + m_position), length);
+            m_position += length;
+            return value;
+        }
+
+        Colour colour()
+        {
+            Colour value;
+            value.r = u8();
+            value.g = u8();
+            value.b = u8();
+            value.a = u8();
+            return value;
+        }
+
+        Vector2u vector2u() { auto x = u32(); return { x, u32() }; }
+        Vector2i vector2i() { auto x = i32(); return { x, i32() }; }
+        Vector2f vector2f() { auto x = f32(); return { x, f32() }; }
+
+        //reads an enum value, failing if it is greater than last
+        template <typename T>
+        T enumeration(T last)
+        {
+            auto value = u8();
+            if (value > static_cast<std::uint8_t>(last))
+            {
+                fail();
+                return last;
+            }
+            return static_cast<T>(value);
+        }
+
+        void tiles(std::vector<TileLayer::Tile>& tiles)
+        {
+            auto tileCount = u32();
+            while (m_position % 4 != 0)
+            {
+                u8();
+            }
+
+            if (tileCount != 0 && !available(std::size_t(tileCount) * 4))
+            {
+                return;
+            }
+
+            tiles.resize(tileCount);
+            const auto* src = m_data + m_position;
+            for (auto& tile : tiles)
+            {
+                tile = TileLayer::Tile::fromGID(load32(src));
+                src += 4;
+            }
+            m_position += std::size_t(tileCount) * 4;
+        }
+
+    private:
+        const unsigned char* m_data;
+        std::size_t m_size;
+        std::size_t m_position;
+        bool m_failed;
+
+        bool available(std::size_t size)
+        {
+            if (m_failed || m_size - m_position < size)
+            {
+                fail();
+                return false;
+            }
+            return true;
+        }
+    };
+}
+
+//has access to the private members of the classes which make up a map
+class BinaryMap::Serialiser final
+{
+public:
+    static void writeMap(Writer& writer, const Map& map)
+    {
+        writer.u32(map.m_version.upper);
+        writer.u32(map.m_version.lower);
+        writer.string(map.m_class);
+        writer.enumeration(map.m_orientation);
+        writer.enumeration(map.m_renderOrder);
+        writer.boolean(map.m_infinite);
+        writer.vector(map.m_tileCount);
+        writer.vector(map.m_tileSize);
+        writer.f32(map.m_hexSideLength);
+        writer.enumeration(map.m_staggerAxis);
+        writer.enumeration(map.m_staggerIndex);
+        writer.vector(map.m_parallaxOrigin);
+        writer.colour(map.m_backgroundColour);
+
+        writer.size(map.m_tilesets.size());
+        for (const auto& tileset : map.m_tilesets)
+        {
+            writeTileset(writer, tileset);
+        }
+
+        writeLayers(writer, map.m_layers);
+        writeProperties(writer, map.m_properties);
+
+        //sorted so that the same map always produces the same file
+        std::vector<const std::pair<const std::string, Object>*> templateObjects;
+        for (const auto& pair : map.m_templateObjects)
+        {
+            templateObjects.push_back(&pair);
+        }
+        std::sort(templateObjects.begin(), templateObjects.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+        writer.size(templateObjects.size());
+        for (const auto* pair : templateObjects)
+        {
+            writer.string(pair->first);
+            writeObject(writer, pair->second);
+        }
+
+        std::vector<const std::pair<const std::string, Tileset>*> templateTilesets;
+        for (const auto& pair : map.m_templateTilesets)
+        {
+            templateTilesets.push_back(&pair);
+        }
+        std::sort(templateTilesets.begin(), templateTilesets.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+        writer.size(templateTilesets.size());
+        for (const auto* pair : templateTilesets)
+        {
+            writer.string(pair->first);
+            writeTileset(writer, pair->second);
+        }
+    }
+
+    static void readMap(Reader& reader, Map& map)
+    {
+        map.m_version.upper = static_cast<std::uint16_t>(reader.u32());
+        map.m_version.lower = static_cast<std::uint16_t>(reader.u32());
+        map.m_class = reader.string();
+        map.m_orientation = reader.enumeration(Orientation::None);
+        map.m_renderOrder = reader.enumeration(RenderOrder::None);
+        map.m_infinite = reader.boolean();
+        map.m_tileCount = reader.vector2u();
+        map.m_tileSize = reader.vector2u();
+        map.m_hexSideLength = reader.f32();
+        map.m_staggerAxis = reader.enumeration(StaggerAxis::None);
+        map.m_staggerIndex = reader.enumeration(StaggerIndex::None);
+        map.m_parallaxOrigin = reader.vector2f();
+        map.m_backgroundColour = reader.colour();
+
+        auto count = reader.count(1);
+        map.m_tilesets.reserve(count);
+        for (auto i = 0u; i < count; ++i)
+        {
+            map.m_tilesets.emplace_back(map.m_workingDirectory);
+            readTileset(reader, map.m_tilesets.back());
+        }
+
+        readLayers(reader, map.m_layers, map.m_workingDirectory, map.m_tileCount);
+        map.filterLayers(map.m_layers, {});
+        readProperties(reader, map.m_properties);
+
+        count = reader.count(1);
+        for (auto i = 0u; i < count && !reader.failed(); ++i)
+        {
+            auto name = reader.string();
+            readObject(reader, map.m_templateObjects[name]);
+        }
+
+        count = reader.count(1);
+        for (auto i = 0u; i < count && !reader.failed(); ++i)
+        {
+            auto name = reader.string();
+            auto result = map.m_templateTilesets.insert(std::make_pair(name, Tileset(map.m_workingDirectory)));
+            readTileset(reader, result.first->second);
+        }
+
+        map.finaliseLoad();
+    }
+
+private:
+    static void writeProperties(Writer& writer, const std::vector<Property>& properties)
+    {
+        writer.size(properties.size());
+        for (const auto& property : properties)
+        {
+            writer.enumeration(property.m_type);
+            writer.string(property.m_name);
+            writer.string(property.m_propertyType);
+
+            switch (property.m_type)
+            {
+            default: break;
+            case Property::Type::Boolean:
+                writer.boolean(property.m_boolValue);
+                break;
+            case Property::Type::Float:
+                writer.f32(property.m_floatValue);
+                break;
+            case Property::Type::Int:
+            case Property::Type::Object:
+                writer.i32(property.m_intValue);
+                break;
+            case Property::Type::String:
+            case Property::Type::File:
+                writer.string(property.m_stringValue);
+                break;
+            case Property::Type::Colour:
+                writer.colour(property.m_colourValue);
+                break;
+            case Property::Type::Class:
+                writeProperties(writer, property.m_classValue);
+                break;
+            }
+        }
+    }
+
+    static void readProperties(Reader& reader, std::vector<Property>& properties)
+    {
+        auto count = reader.count(9);
+        properties.resize(count);
+        for (auto& property : properties)
+        {
+            property.m_type = reader.enumeration(Property::Type::Undef);
+            property.m_name = reader.string();
+            property.m_propertyType = reader.string();
+
+            switch (property.m_type)
+            {
+            default: break;
+            case Property::Type::Boolean:
+                property.m_boolValue = reader.boolean();
+                break;
+            case Property::Type::Float:
+                property.m_floatValue = reader.f32();
+                break;
+            case Property::Type::Int:
+            case Property::Type::Object:
+                property.m_intValue = reader.i32();
+                break;
+            case Property::Type::String:
+            case Property::Type::File:
+                property.m_stringValue = reader.string();
+                break;
+            case Property::Type::Colour:
+                property.m_colourValue = reader.colour();
+                break;
+            case Property::Type::Class:
+                readProperties(reader, property.m_classValue);
+                break;
+            }
+        }
+    }
+
+    static void writeObject(Writer& writer, const Object& object)
+    {
+        writer.u32(object.m_UID);
+        writer.string(object.m_name);
+        writer.string(object.m_class);
+        writer.vector(object.m_position);
+        writer.f32(object.m_AABB.left);
+        writer.f32(object.m_AABB.top);
+        writer.f32(object.m_AABB.width);
+        writer.f32(object.m_AABB.height);
+        writer.f32(object.m_rotation);
+        writer.u32(object.m_tileID);
+        writer.u8(object.m_flipFlags);
+        writer.boolean(object.m_visible);
+        writer.enumeration(object.m_shape);
+
+        writer.size(object.m_points.size());
+        for (const auto& point : object.m_points)
+        {
+            writer.vector(point);
+        }
+        writeProperties(writer, object.m_properties);
+
+        const auto& text = object.m_textData;
+        writer.string(text.fontFamily);
+        writer.u32(text.pixelSize);
+        writer.boolean(text.wrap);
+        writer.colour(text.colour);
+        writer.boolean(text.bold);
+        writer.boolean(text.italic);
+        writer.boolean(text.underline);
+        writer.boolean(text.strikethough);
+        writer.boolean(text.kerning);
+        writer.enumeration(text.hAlign);
+        writer.enumeration(text.vAlign);
+        writer.string(text.content);
+
+        writer.string(object.m_tilesetName);
+    }
+
+    static void readObject(Reader& reader, Object& object)
+    {
+        object.m_UID = reader.u32();
+        object.m_name = reader.string();
+        object.m_class = reader.string();
+        object.m_position = reader.vector2f();
+        object.m_AABB.left = reader.f32();
+        object.m_AABB.top = reader.f32();
+        object.m_AABB.width = reader.f32();
+        object.m_AABB.height = reader.f32();
+        object.m_rotation = reader.f32();
+        object.m_tileID = reader.u32();
+        object.m_flipFlags = reader.u8();
+        object.m_visible = reader.boolean();
+        object.m_shape = reader.enumeration(Object::Shape::Text);
+
+        object.m_points.resize(reader.count(8));
+        for (auto& point : object.m_points)
+        {
+            point = reader.vector2f();
+        }
+        readProperties(reader, object.m_properties);
+
+        auto& text = object.m_textData;
+        text.fontFamily = reader.string();
+        text.pixelSize = reader.u32();
+        text.wrap = reader.boolean();
+        text.colour = reader.colour();
+        text.bold = reader.boolean();
+        text.italic = reader.boolean();
+        text.underline = reader.boolean();
+        text.strikethough = reader.boolean();
+        text.kerning = reader.boolean();
+        text.hAlign = reader.enumeration(Text::HAlign::Right);
+        text.vAlign = reader.enumeration(Text::VAlign::Bottom);
+        text.content = reader.string();
+
+        object.m_tilesetName = reader.string();
+    }
+
+    static void writeObjectGroup(Writer& writer, const ObjectGroup& group)
+    {
+        writer.colour(group.m_colour);
+        writer.enumeration(group.m_drawOrder);
+        writeProperties(writer, group.m_properties);
+
+        writer.size(group.m_objects.size());
+        for (const auto& object : group.m_objects)
+        {
+            writeObject(writer, object);
+        }
+    }
+
+    static void readObjectGroup(Reader& reader, ObjectGroup& group)
+    {
+        group.m_colour = reader.colour();
+        group.m_drawOrder = reader.enumeration(ObjectGroup::DrawOrder::TopDown);
+        readProperties(reader, group.m_properties);
+
+        //an object takes at least 100 bytes
+        group.m_objects.resize(reader.count(100));
+        for (auto& object : group.m_objects)
+        {
+            readObject(reader, object);
+        }
+    }
+
+    static void writeTileset(Writer& writer, const Tileset& tileset)
+    {
+        writer.u32(tileset.m_firstGID);
+        writer.string(tileset.m_data->source);
+        writer.string(tileset.m_data->name);
+        writer.string(tileset.m_data->className);
+        writer.vector(tileset.m_data->tileSize);
+        writer.u32(tileset.m_data->spacing);
+        writer.u32(tileset.m_data->margin);
+        writer.u32(tileset.m_data->tileCount);
+        writer.u32(tileset.m_data->columnCount);
+        writer.enumeration(tileset.m_data->objectAlignment);
+        writer.vector(tileset.m_data->tileOffset);
+        writeProperties(writer, tileset.m_data->properties);
+        writer.string(tileset.m_data->imagePath);
+        writer.vector(tileset.m_data->imageSize);
+        writer.colour(tileset.m_data->transparencyColour);
+        writer.boolean(tileset.m_data->hasTransparency);
+
+        writer.size(tileset.m_data->terrainTypes.size());
+        for (const auto& terrain : tileset.m_data->terrainTypes)
+        {
+            writer.string(terrain.name);
+            writer.u32(terrain.tileID);
+            writeProperties(writer, terrain.properties);
+        }
+
+        writer.size(tileset.m_data->tileIndex.size());
+        for (auto index : tileset.m_data->tileIndex)
+        {
+            writer.u32(index);
+        }
+
+        writer.size(tileset.m_data->tiles.size());
+        for (const auto& tile : tileset.m_data->tiles)
+        {
+            writer.u32(tile.ID);
+            for (auto index : tile.terrainIndices)
+            {
+                writer.i32(index);
+            }
+            writer.u32(tile.probability);
+
+            writer.size(tile.animation.frames.size());
+            for (const auto& frame : tile.animation.frames)
+            {
+                writer.u32(frame.tileID);
+                writer.u32(frame.duration);
+            }
+
+            writeProperties(writer, tile.properties);
+            writeLayer(writer, tile.objectGroup);
+            writeObjectGroup(writer, tile.objectGroup);
+            writer.string(tile.imagePath);
+            writer.vector(tile.imageSize);
+            writer.vector(tile.imagePosition);
+            writer.string(tile.className);
+        }
+    }
+
+    static void readTileset(Reader& reader, Tileset& tileset)
+    {
+        tileset.m_firstGID = reader.u32();
+        tileset.m_data->source = reader.string();
+        tileset.m_data->name = reader.string();
+        tileset.m_data->className = reader.string();
+        tileset.m_data->tileSize = reader.vector2u();
+        tileset.m_data->spacing = reader.u32();
+        tileset.m_data->margin = reader.u32();
+        tileset.m_data->tileCount = reader.u32();
+        tileset.m_data->columnCount = reader.u32();
+        tileset.m_data->objectAlignment = reader.enumeration(Tileset::ObjectAlignment::BottomRight);
+        tileset.m_data->tileOffset = reader.vector2u();
+        readProperties(reader, tileset.m_data->properties);
+        tileset.m_data->imagePath = reader.string();
+        tileset.m_data->imageSize = reader.vector2u();
+        tileset.m_data->transparencyColour = reader.colour();
+        tileset.m_data->hasTransparency = reader.boolean();
+
+        tileset.m_data->terrainTypes.resize(reader.count(12));
+        for (auto& terrain : tileset.m_data->terrainTypes)
+        {
+            terrain.name = reader.string();
+            terrain.tileID = reader.u32();
+            readProperties(reader, terrain.properties);
+        }
+
+        tileset.m_data->tileIndex.resize(reader.count(4));
+        for (auto& index : tileset.m_data->tileIndex)
+        {
+            index = reader.u32();
+        }
+
+        //a tile takes at least 60 bytes
+        tileset.m_data->tiles.resize(reader.count(60));
+        for (auto& tile : tileset.m_data->tiles)
+        {
+            tile.ID = reader.u32();
+            for (auto& index : tile.terrainIndices)
+            {
+                index = reader.i32();
+            }
+            tile.probability = reader.u32();
+
+            tile.animation.frames.resize(reader.count(8));
+            for (auto& frame : tile.animation.frames)
+            {
+                frame.tileID = reader.u32();
+                frame.duration = reader.u32();
+            }
+
+            readProperties(reader, tile.properties);
+            readLayer(reader, tile.objectGroup);
+            readObjectGroup(reader, tile.objectGroup);
+            tile.imagePath = reader.string();
+            tile.imageSize = reader.vector2u();
+            tile.imagePosition = reader.vector2u();
+            tile.className = reader.string();
+        }
+
+        //getTile() relies on the index being valid
+        if (std::any_of(tileset.m_data->tileIndex.begin(), tileset.m_data->tileIndex.end(),
+            [&tileset](std::uint32_t index) { return index > tileset.m_data->tiles.size(); }))
+        {
+            reader.fail();
+        }
+    }
+
+    //common properties of all layers
+    static void writeLayer(Writer& writer, const Layer& layer)
+    {
+        writer.string(layer.m_name);
+        writer.string(layer.m_class);
+        writer.f32(layer.m_opacity);
+        writer.boolean(layer.m_visible);
+        writer.vector(layer.m_offset);
+        writer.vector(layer.m_parallaxFactor);
+        writer.colour(layer.m_tintColour);
+        writer.vector(layer.m_size);
+        writeProperties(writer, layer.m_properties);
+    }
+
+    static void readLayer(Reader& reader, Layer& layer)
+    {
+        layer.m_name = reader.string();
+        layer.m_class = reader.string();
+        layer.m_opacity = reader.f32();
+        layer.m_visible = reader.boolean();
+        layer.m_offset = reader.vector2i();
+        layer.m_parallaxFactor = reader.vector2f();
+        layer.m_tintColour = reader.colour();
+        layer.m_size = reader.vector2u();
+        readProperties(reader, layer.m_properties);
+    }
+
+    static void writeLayers(Writer& writer, const std::vector<Layer::Ptr>& layers)
+    {
+        writer.size(layers.size());
+        for (const auto& layer : layers)
+        {
+            writer.enumeration(layer->getType());
+            writeLayer(writer, *layer);
+
+            switch (layer->getType())
+            {
+            case Layer::Type::Tile:
+            {
+                //binary maps always hold every chunk
+                const auto& tileLayer = layer->getLayerAs<TileLayer>();
+                writer.size(tileLayer.m_tileCount);
+                writer.tiles(tileLayer.getTiles());
+
+                const auto& chunks = tileLayer.getChunks();
+                std::vector<TileLayer::Chunk> pendingChunks;
+                tileLayer.decodePendingChunks(pendingChunks, nullptr);
+
+                const auto writeChunks = [&writer](const std::vector<TileLayer::Chunk>& chunkList)
+                {
+                    for (const auto& chunk : chunkList)
+                    {
+                        writer.vector(chunk.position);
+                        writer.vector(chunk.size);
+                        writer.tiles(chunk.tiles);
+                    }
+                };
+
+                writer.size(chunks.size() + pendingChunks.size());
+                writeChunks(chunks);
+                writeChunks(pendingChunks);
+            }
+                break;
+            case Layer::Type::Object:
+                writeObjectGroup(writer, layer->getLayerAs<ObjectGroup>());
+                break;
+            case Layer::Type::Image:
+            {
+                const auto& imageLayer = layer->getLayerAs<ImageLayer>();
+                writer.string(imageLayer.m_filePath);
+                writer.colour(imageLayer.m_transparencyColour);
+                writer.boolean(imageLayer.m_hasTransparency);
+                writer.vector(imageLayer.m_imageSize);
+                writer.boolean(imageLayer.m_hasRepeatX);
+                writer.boolean(imageLayer.m_hasRepeatY);
+                writer.boolean(imageLayer.m_locked);
+            }
+                break;
+            case Layer::Type::Group:
+            {
+                const auto& group = layer->getLayerAs<LayerGroup>();
+                writer.vector(group.m_tileCount);
+                writeLayers(writer, group.m_layers);
+            }
+                break;
+            }
+        }
+    }
+
+    static void readLayers(Reader& reader, std::vector<Layer::Ptr>& layers, const std::string& workingDir, const Vector2u& tileCount)
+    {
+        //a layer takes at least 60 bytes
+        auto count = reader.count(60);
+        layers.reserve(count);
+        for (auto i = 0u; i < count && !reader.failed(); ++i)
+        {
+            switch (reader.enumeration(Layer::Type::Group))
+            {
+            case Layer::Type::Tile:
+            {
+                auto layer = std::make_unique<TileLayer>(tileCount.x * tileCount.y);
+                readLayer(reader, *layer);
+                layer->m_tileCount = reader.u32();
+                reader.tiles(layer->m_tiles);
+
+                layer->m_chunks.resize(reader.count(20));
+                for (auto& chunk : layer->m_chunks)
+                {
+                    chunk.position = reader.vector2i();
+                    chunk.size = reader.vector2i();
+                    reader.tiles(chunk.tiles);
+                }
+                layers.push_back(std::move(layer));
+            }
+                break;
+            case Layer::Type::Object:
+            {
+                auto layer = std::make_unique<ObjectGroup>();
+                readLayer(reader, *layer);
+                readObjectGroup(reader, *layer);
+                layers.push_back(std::move(layer));
+            }
+                break;
+            case Layer::Type::Image:
+            {
+                auto layer = std::make_unique<ImageLayer>(workingDir);
+                readLayer(reader, *layer);
+                layer->m_filePath = reader.string();
+                layer->m_transparencyColour = reader.colour();
+                layer->m_hasTransparency = reader.boolean();
+                layer->m_imageSize = reader.vector2u();
+                layer->m_hasRepeatX = reader.boolean();
+                layer->m_hasRepeatY = reader.boolean();
+                layer->m_locked = reader.boolean();
+                layers.push_back(std::move(layer));
+            }
+                break;
+            case Layer::Type::Group:
+            {
+                auto layer = std::make_unique<LayerGroup>(workingDir, tileCount);
+                readLayer(reader, *layer);
+                layer->m_tileCount = reader.vector2u();
+                readLayers(reader, layer->m_layers, workingDir, layer->m_tileCount);
+                layers.push_back(std::move(layer));
+            }
+                break;
+            }
+        }
+    }
+};
+
+//public
+bool BinaryMap::write(const Map& map, const std::string& path)
+{
+    std::vector<char> data;
+    write(map, data);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::log("Failed to open " + path + " for writing", Logger::Type::Error);
+        return false;
+    }
+
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.close();
+    if (file.fail())
+    {
+        Logger::log("Failed to write " + path, Logger::Type::Error);
+        return false;
+    }
+    return true;
+}
+
+void BinaryMap::write(const Map& map, std::vector<char>& destination)
+{
+    destination.assign(HeaderSize, 0);
+
+    Writer writer(destination);
+    Serialiser::writeMap(writer, map);
+
+    auto* header = reinterpret_cast<unsigned char*>(destination.data());
+    std::memcpy(header, Magic, sizeof(Magic));
+    store32(header + 4, FormatVersion);
+    store64(header + 8, destination.size() - HeaderSize);
+    store64(header + 16, hashData(destination.data() + HeaderSize, destination.size() - HeaderSize));
+}
+
+bool BinaryMap::read(Map& map, const char* data, std::size_t size, const std::string& workingDir)
+{
+    map.reset();
+
+    if (!isBinaryMap(data, size))
+    {
+        Logger::log("Failed opening map: not a binary map", Logger::Type::Error);
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const unsigned char*>(data);
+    auto version = load32(header + 4);
+    if (version != FormatVersion)
+    {
+        Logger::log("Failed opening map: binary format version " + std::to_string(version)
+            + " is not supported, expected version " + std::to_string(FormatVersion), Logger::Type::Error);
+        return false;
+    }
+
+    auto payloadSize = load64(header + 8);
+    if (payloadSize != size - HeaderSize
+        || load64(header + 16) != hashData(data + HeaderSize, size - HeaderSize))
+    {
+        Logger::log("Failed opening map: binary map data is corrupt", Logger::Type::Error);
+        return false;
+    }
+
+    //make sure we have consistent path separators
+    map.m_workingDirectory = workingDir;
+    std::replace(map.m_workingDirectory.begin(), map.m_workingDirectory.end(), '\\', '/');
+    if (!map.m_workingDirectory.empty() &&
+        map.m_workingDirectory.back() == '/')
+    {
+        map.m_workingDirectory.pop_back();
+    }
+
+    Reader reader(data + HeaderSize, size - HeaderSize);
+    Serialiser::readMap(reader, map);
+
+    if (reader.failed())
+    {
+        Logger::log("Failed opening map: binary map data is corrupt", Logger::Type::Error);
+        return map.reset();
+    }
+    return true;
+}
+
+bool BinaryMap::isBinaryMap(const char* data, std::size_t size)
+{
+    return size >= HeaderSize && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
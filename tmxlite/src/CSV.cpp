@@ -0,0 +1,386 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+/*
+Layer data is scanned 64 characters at a time. Each block is first
+classified into bit masks of digits, commas and invalid characters
+using vector compares. The placement of the commas is then validated
+for the whole block at once with a little bit arithmetic, leaving
+only the start of each value to be visited individually, where up
+to 8 digits are converted at once with SWAR multiplication. This means
+whitespace and separators, which make up a good part of the CSV Tiled
+writes, are never looked at one character at a time.
+*/
+
+#include <tmxlite/FreeFuncs.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TMXLITE_CSV_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TMXLITE_CSV_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    //one bit per character of a block
+    using Mask = std::uint64_t;
+    constexpr std::uint32_t BlockSize = 64;
+
+    //bit n of each mask describes character n of a block
+    struct BlockMasks final
+    {
+        Mask digits = 0;
+        Mask commas = 0;
+        Mask invalid = 0; //anything which isn't a digit, comma or whitespace
+    };
+
+    //returns BlockSize if no bits are set
+    std::uint32_t countTrailingZeros(Mask value)
+    {
+        if (value == 0)
+        {
+            return BlockSize;
+        }
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index = 0;
+        _BitScanForward64(&index, value);
+        return static_cast<std::uint32_t>(index);
+#elif defined(_MSC_VER)
+        unsigned long index = 0;
+        if (_BitScanForward(&index, static_cast<unsigned long>(value)))
+        {
+            return static_cast<std::uint32_t>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+        return static_cast<std::uint32_t>(index) + 32;
+#else
+        return static_cast<std::uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    //mask of all the bits below index
+    Mask maskBelow(std::uint32_t index)
+    {
+        return index < BlockSize ? (Mask(1) << index) - 1 : ~Mask(0);
+    }
+
+#if defined(TMXLITE_CSV_SSE2)
+    BlockMasks classify(const char* in)
+    {
+        BlockMasks masks;
+        for (auto i = 0u; i < BlockSize; i += 16)
+        {
+            const __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+            const __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(str, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(str, _mm_set1_epi8('9' + 1)));
+            const __m128i commas = _mm_cmpeq_epi8(str, _mm_set1_epi8(','));
+            const __m128i whitespace = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(str, _mm_set1_epi8('\n'))),
+                _mm_or_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(str, _mm_set1_epi8('\t'))));
+            const __m128i valid = _mm_or_si128(_mm_or_si128(digits, commas), whitespace);
+
+            masks.digits |= static_cast<Mask>(_mm_movemask_epi8(digits)) << i;
+            masks.commas |= static_cast<Mask>(_mm_movemask_epi8(commas)) << i;
+            masks.invalid |= static_cast<Mask>(~_mm_movemask_epi8(valid) & 0xffff) << i;
+        }
+        return masks;
+    }
+
+#elif defined(TMXLITE_CSV_NEON)
+    std::uint32_t moveMask(uint8x16_t value)
+    {
+        static const std::uint8_t weights[] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        const uint8x16_t bits = vandq_u8(value, vld1q_u8(weights));
+        return static_cast<std::uint32_t>(vaddv_u8(vget_low_u8(bits))) | (static_cast<std::uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+    }
+
+    BlockMasks classify(const char* in)
+    {
+        BlockMasks masks;
+        for (auto i = 0u; i < BlockSize; i += 16)
+        {
+            const uint8x16_t str = vld1q_u8(reinterpret_cast<const std::uint8_t*>(in + i));
+
+            const uint8x16_t digits = vcltq_u8(vsubq_u8(str, vdupq_n_u8('0')), vdupq_n_u8(10));
+            const uint8x16_t commas = vceqq_u8(str, vdupq_n_u8(','));
+            const uint8x16_t whitespace = vorrq_u8(
+                vorrq_u8(vceqq_u8(str, vdupq_n_u8(' ')), vceqq_u8(str, vdupq_n_u8('\n'))),
+                vorrq_u8(vceqq_u8(str, vdupq_n_u8('\r')), vceqq_u8(str, vdupq_n_u8('\t'))));
+            const uint8x16_t valid = vorrq_u8(vorrq_u8(digits, commas), whitespace);
+
+            masks.digits |= static_cast<Mask>(moveMask(digits)) << i;
+            masks.commas |= static_cast<Mask>(moveMask(commas)) << i;
+            masks.invalid |= static_cast<Mask>(~moveMask(valid) & 0xffff) << i;
+        }
+        return masks;
+    }
+
+#else
+    BlockMasks classify(const char* in)
+    {
+        BlockMasks masks;
+        for (auto i = 0u; i < BlockSize; ++i)
+        {
+            const char c = in[i];
+            if (c >= '0' && c <= '9')
+            {
+                masks.digits |= (Mask(1) << i);
+            }
+            else if (c == ',')
+            {
+                masks.commas |= (Mask(1) << i);
+            }
+            else if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            {
+                masks.invalid |= (Mask(1) << i);
+            }
+        }
+        return masks;
+    }
+#endif
+
+    //bit n of the result is the XOR of bits 0 - n of value
+    Mask prefixXor(Mask value)
+    {
+        value ^= (value << 1);
+        value ^= (value << 2);
+        value ^= (value << 4);
+        value ^= (value << 8);
+        value ^= (value << 16);
+        value ^= (value << 32);
+        return value;
+    }
+
+    //converts the first count (1 - 8) characters of str, which must be digits,
+    //using SWAR multiplication. Always reads 8 characters.
+    std::uint64_t parseEightDigits(const char* str, std::uint32_t count)
+    {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        std::uint64_t value = 0;
+        for (auto i = 0u; i < count; ++i)
+        {
+            value = (value * 10) + static_cast<std::uint32_t>(str[i] - '0');
+        }
+        return value;
+#else
+        std::uint64_t value = 0;
+        std::memcpy(&value, str, sizeof(value));
+
+        //the first character is in the lowest byte on little endian
+        //machines, so shifting left drops the unwanted characters and
+        //leaves leading zeros in their place
+        value -= 0x3030303030303030ull;
+        value <<= (8 - count) * 8;
+
+        value = ((value & 0x0f0f0f0f0f0f0f0full) * 2561) >> 8;
+        value = ((value & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+        return ((value & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32;
+#endif
+    }
+}
+
+std::size_t tmx::csv_decode(const char* src, std::size_t srcLen, std::uint32_t* dst, std::size_t dstCount, std::size_t* srcUsed)
+{
+    std::size_t written = 0;
+    std::size_t position = 0;
+    std::size_t stop = srcLen;
+
+    //a value which runs off the end of a block
+    std::uint64_t value = 0;
+    std::size_t valueStart = 0;
+    bool inValue = false;
+
+    //true at the start of the input and after each comma
+    bool expectValue = true;
+
+    auto finish = [&]()
+    {
+        if (srcUsed)
+        {
+            *srcUsed = stop;
+        }
+        return written;
+    };
+
+    auto emitValue = [&]()
+    {
+        inValue = false;
+        if (written == dstCount)
+        {
+            //resume from the start of this value next time
+            stop = valueStart;
+            return false;
+        }
+        dst[written++] = static_cast<std::uint32_t>(value);
+        return true;
+    };
+
+    //slow path for values which are long or cross a block boundary
+    auto parseDigits = [&](const char* block, Mask digits, std::uint32_t index)
+    {
+        const auto end = index + countTrailingZeros(~(digits >> index));
+        for (auto i = index; i < end; ++i)
+        {
+            value = (value * 10) + static_cast<std::uint32_t>(block[i] - '0');
+            if (value > 0xffffffffu)
+            {
+                stop = valueStart;
+                return false;
+            }
+        }
+
+        if (end == BlockSize)
+        {
+            //value continues in the next block
+            inValue = true;
+            return true;
+        }
+        return emitValue();
+    };
+
+    //blocks are copied so that parseEightDigits() may safely read past the end
+    char block[BlockSize + 8] = {};
+    while (position < srcLen)
+    {
+        if (srcLen - position < BlockSize)
+        {
+            //pad the final block with whitespace so that it can be treated as any other
+            std::memset(block, ' ', BlockSize);
+            std::memcpy(block, src + position, srcLen - position);
+        }
+        else
+        {
+            std::memcpy(block, src + position, BlockSize);
+        }
+
+        const auto masks = classify(block);
+        std::uint32_t errorIndex = countTrailingZeros(masks.invalid);
+        Mask limit = maskBelow(errorIndex);
+
+        //a value carried over from the previous block starts at bit 0,
+        //so that run must not be counted again as a new value
+        Mask runStarts = masks.digits & ~(masks.digits << 1) & limit;
+        if (inValue)
+        {
+            runStarts &= ~Mask(1);
+        }
+
+        //values and commas must alternate, starting with a value. The prefix
+        //XOR of the token mask gives the parity of each token, so when expecting
+        //a value every odd token must be the start of a value and every even
+        //one a comma.
+        const Mask tokens = runStarts | (masks.commas & limit);
+        const Mask tokenParity = prefixXor(tokens);
+        const Mask parity = expectValue ? tokenParity : ~tokenParity;
+
+        if ((tokens & parity) != runStarts)
+        {
+            //find the first token out of place and stop there
+            auto remaining = tokens;
+            auto expecting = expectValue;
+            while (remaining != 0)
+            {
+                const auto index = countTrailingZeros(remaining);
+                remaining &= (remaining - 1);
+
+                const bool isComma = ((masks.commas >> index) & 1) != 0;
+                if (isComma == expecting)
+                {
+                    errorIndex = index;
+                    limit = maskBelow(index);
+                    runStarts &= limit;
+                    break;
+                }
+                expecting = isComma;
+            }
+        }
+
+        //the last bit of the prefix XOR is the parity of the token count
+        if (tokenParity >> (BlockSize - 1))
+        {
+            expectValue = !expectValue;
+        }
+
+        const Mask digits = masks.digits & limit;
+        if (inValue
+            && !parseDigits(block, digits, 0))
+        {
+            return finish();
+        }
+
+        while (runStarts != 0)
+        {
+            const auto index = countTrailingZeros(runStarts);
+            runStarts &= (runStarts - 1);
+
+            valueStart = position + index;
+            const auto length = countTrailingZeros(~(digits >> index));
+            if (length <= 8 && index + length < BlockSize)
+            {
+                //the common case of a short value which is entirely within this block
+                if (written == dstCount)
+                {
+                    stop = valueStart;
+                    return finish();
+                }
+                dst[written++] = static_cast<std::uint32_t>(parseEightDigits(block + index, length));
+            }
+            else
+            {
+                value = 0;
+                if (!parseDigits(block, digits, index))
+                {
+                    return finish();
+                }
+            }
+        }
+
+        if (errorIndex != BlockSize)
+        {
+            stop = position + errorIndex;
+            return finish();
+        }
+        position += BlockSize;
+    }
+
+    if (inValue)
+    {
+        emitValue();
+    }
+
+    return finish();
+}
@@ -0,0 +1,98 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/Executor.hpp>
+
+using namespace tmx;
+
+TaskGroup::TaskGroup(Executor* executor)
+    : m_executor(executor),
+    m_pending   (0)
+{
+
+}
+
+TaskGroup::~TaskGroup()
+{
+    //tasks reference this group so they must all finish first
+    waitForTasks();
+}
+
+//public
+void TaskGroup::run(Executor::Task task)
+{
+    if (!m_executor)
+    {
+        task();
+        return;
+    }
+
+    m_pending++;
+    m_executor->submit([this, task]()
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception)
+            {
+                m_exception = std::current_exception();
+            }
+        }
+
+        //this must be the last thing to touch the group
+        m_pending--;
+    });
+}
+
+void TaskGroup::wait()
+{
+    waitForTasks();
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(exception, m_exception);
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+//private
+void TaskGroup::waitForTasks()
+{
+    if (m_executor && m_pending != 0)
+    {
+        m_executor->wait([this]() { return m_pending == 0; });
+    }
+}
@@ -34,6 +34,10 @@ source distribution.
 #include <tmxlite/Types.hpp>
 #include <tmxlite/detail/Log.hpp>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <array>
 #include <cstring>
 #include <fstream>
 
@@ -267,7 +271,7 @@ std::string tmx::resolveFilePath(std::string path, std::string workingDir)
 
 bool tmx::readFileIntoString(const std::string& path, std::string* out)
 {
-    std::ifstream stream(path);
+    std::ifstream stream(path, std::ios::binary);
     if (!stream.is_open())
     {
         return false;
@@ -275,3 +279,66 @@ bool tmx::readFileIntoString(const std::string& path, std::string* out)
     out->append((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
     return !stream.bad();
 }
+
+std::uint64_t tmx::hashData(const char* data, std::size_t size, std::uint64_t seed)
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    auto load64 = [](const unsigned char* d)
+    {
+        std::uint64_t value = 0;
+        for (auto i = 0; i < 8; ++i)
+        {
+            value |= static_cast<std::uint64_t>(d[i]) << (i * 8);
+        }
+        return value;
+    };
+
+    //a crc is far slower to compute than parsing a binary map, so the
+    //data is hashed a word at a time in four independent lanes instead
+    constexpr std::uint64_t Prime = 0x100000001b3ull;
+    std::array<std::uint64_t, 4u> lanes =
+    {
+        0xcbf29ce484222325ull, 0x84222325cbf29ce4ull,
+        0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full
+    };
+
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        for (auto j = 0u; j < lanes.size(); ++j)
+        {
+            lanes[j] = (lanes[j] ^ load64(bytes + i + j * 8)) * Prime;
+            lanes[j] ^= lanes[j] >> 29;
+        }
+    }
+
+    std::uint64_t result = size ^ seed;
+    for (auto lane : lanes)
+    {
+        result = (result ^ lane) * Prime;
+    }
+
+    for (; i < size; ++i)
+    {
+        result = (result ^ bytes[i]) * Prime;
+    }
+    return result ^ (result >> 32);
+}
+
+bool tmx::getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize)
+{
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0)
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+#endif
+    {
+        return false;
+    }
+
+    modifiedTime = static_cast<std::int64_t>(info.st_mtime);
+    fileSize = static_cast<std::int64_t>(info.st_size);
+    return true;
+}
@@ -0,0 +1,309 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#ifdef USE_EXTLIBS
+#include <pugixml.hpp>
+#else
+#include "detail/pugixml.hpp"
+#endif
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/IncrementalLoader.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/detail/Log.hpp>
+#include <tmxlite/detail/XmlStream.hpp>
+
+using namespace tmx;
+
+IncrementalLoader::IncrementalLoader(const std::string& path)
+    : m_path    (path),
+    m_status    (Status::InProgress),
+    m_bytesRead (0)
+{
+
+}
+
+IncrementalLoader::~IncrementalLoader() = default;
+
+//public
+IncrementalLoader::Status IncrementalLoader::step(std::chrono::microseconds budget)
+{
+    const auto start = std::chrono::steady_clock::now();
+    do
+    {
+        parseNext();
+    } while (m_status == Status::InProgress
+        && std::chrono::steady_clock::now() - start < budget);
+
+    return m_status;
+}
+
+IncrementalLoader::Status IncrementalLoader::step(std::size_t byteBudget)
+{
+    const auto target = m_bytesRead + byteBudget;
+    do
+    {
+        parseNext();
+    } while (m_status == Status::InProgress
+        && m_bytesRead < target);
+
+    return m_status;
+}
+
+//private
+void IncrementalLoader::parseNext()
+{
+    if (m_status != Status::InProgress)
+    {
+        return;
+    }
+
+    if (!m_xml)
+    {
+        begin();
+        return;
+    }
+
+    auto token = m_xml->next();
+    if (token == XmlStream::Token::End)
+    {
+        if (m_groups.empty())
+        {
+            //this is the end of the map node
+            m_map.finaliseLoad();
+            m_status = Status::Done;
+
+            close();
+        }
+        else
+        {
+            m_groups.pop_back();
+        }
+        return;
+    }
+
+    if (token != XmlStream::Token::Start)
+    {
+        if (token == XmlStream::Token::EndOfFile)
+        {
+            Logger::log("Unexpected end of map data", Logger::Type::Error);
+        }
+        fail();
+        return;
+    }
+
+    //the same child nodes are handled as by Map::parseMapNode() and LayerGroup::parse()
+    auto& layers = m_groups.empty() ? m_map.m_layers : m_groups.back()->m_layers;
+    const auto& workingDir = m_map.m_workingDirectory;
+    const auto& tileCount = m_map.m_tileCount;
+    const auto name = m_xml->name();
+    pugi::xml_document doc;
+
+    //layers rejected by the map's filter are skipped without being parsed,
+    //which is decided from their start tag. Groups are skipped whole
+    Layer::Type type;
+    if (m_map.getLayerFilter() && Map::getLayerType(name, type))
+    {
+        auto tag = m_xml->tag();
+        if (!doc.load_buffer_inplace(&tag[0], tag.size()))
+        {
+            Logger::log("Failed parsing " + name + " element", Logger::Type::Error);
+            fail();
+            return;
+        }
+
+        std::string groupPath;
+        for (const auto* group : m_groups)
+        {
+            groupPath += (groupPath.empty() ? "" : "/") + group->getName();
+        }
+
+        if (!m_map.acceptLayer(doc.first_child(), groupPath))
+        {
+            char* data = nullptr;
+            std::size_t size = 0;
+            if (!m_xml->element(data, size))
+            {
+                fail();
+                return;
+            }
+            m_bytesRead += size;
+            return;
+        }
+        doc.reset();
+    }
+
+    //groups are parsed from their start tag, and
+    //their children are read by subsequent steps
+    if (name == "group")
+    {
+        auto tag = m_xml->tag();
+        auto result = doc.load_buffer_inplace(&tag[0], tag.size());
+        if (!result)
+        {
+            Logger::log("Failed parsing group element: " + std::string(result.description()), Logger::Type::Error);
+            fail();
+            return;
+        }
+        m_bytesRead += tag.size();
+
+        layers.emplace_back(std::make_unique<LayerGroup>(workingDir, tileCount));
+        auto* group = static_cast<LayerGroup*>(layers.back().get());
+        group->parse(doc.first_child(), &m_map);
+
+        if (!m_xml->selfClosing())
+        {
+            m_groups.push_back(group);
+        }
+        return;
+    }
+
+    char* data = nullptr;
+    std::size_t size = 0;
+    if (!m_xml->element(data, size))
+    {
+        fail();
+        return;
+    }
+    m_bytesRead += size;
+
+    auto result = doc.load_buffer_inplace(data, size);
+    if (!result)
+    {
+        Logger::log("Failed parsing " + name + " element: " + std::string(result.description()), Logger::Type::Error);
+        fail();
+        return;
+    }
+    auto node = doc.first_child();
+
+    if (name == "tileset" && m_groups.empty())
+    {
+        m_map.m_tilesets.emplace_back(workingDir);
+        m_map.m_tilesets.back().setExecutor(m_map.m_executor);
+        m_map.m_tilesets.back().parse(node, &m_map);
+    }
+    else if (name == "layer")
+    {
+        layers.emplace_back(std::make_unique<TileLayer>(tileCount.x * tileCount.y));
+        layers.back()->parse(node, &m_map);
+    }
+    else if (name == "objectgroup")
+    {
+        layers.emplace_back(std::make_unique<ObjectGroup>());
+        layers.back()->parse(node, &m_map);
+    }
+    else if (name == "imagelayer")
+    {
+        layers.emplace_back(std::make_unique<ImageLayer>(workingDir));
+        layers.back()->parse(node, &m_map);
+    }
+    else if (name == "properties")
+    {
+        for (const auto& child : node.children())
+        {
+            if (m_groups.empty())
+            {
+                m_map.m_properties.emplace_back();
+                m_map.m_properties.back().parse(child);
+            }
+            else
+            {
+                m_groups.back()->addProperty(child);
+            }
+        }
+    }
+    else
+    {
+        LOG("Unidentified name " + name + ": node skipped", Logger::Type::Warning);
+    }
+}
+
+void IncrementalLoader::begin()
+{
+    m_map.reset();
+
+    auto& provider = m_map.getProvider();
+    if (!provider.open(m_path, m_file))
+    {
+        Logger::log("Failed to open file " + m_path, Logger::Type::Error);
+        fail();
+        return;
+    }
+
+    m_stream = std::make_unique<MemoryStream>(m_file.data(), m_file.size());
+    m_xml = std::make_unique<XmlStream>(*m_stream);
+    if (m_xml->next() != XmlStream::Token::Start
+        || m_xml->name() != "map")
+    {
+        Logger::log("Failed opening map: no map node found", Logger::Type::Error);
+        fail();
+        return;
+    }
+
+    //the map's own attributes are parsed from its start tag
+    auto tag = m_xml->tag();
+    m_bytesRead += tag.size();
+
+    pugi::xml_document doc;
+    auto result = doc.load_buffer_inplace(&tag[0], tag.size());
+    if (!result)
+    {
+        Logger::log("Failed opening map", Logger::Type::Error);
+        Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+        fail();
+        return;
+    }
+
+    if (!m_map.parseDocument(doc, getFilePath(m_path)))
+    {
+        fail();
+        return;
+    }
+
+    if (m_xml->selfClosing())
+    {
+        m_status = Status::Done;
+        close();
+    }
+}
+
+void IncrementalLoader::fail()
+{
+    m_status = Status::Failed;
+    m_groups.clear();
+    m_map.reset();
+    close();
+}
+
+void IncrementalLoader::close()
+{
+    m_xml.reset();
+    m_stream.reset();
+    m_file.clear();
+}
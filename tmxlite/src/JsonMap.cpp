@@ -0,0 +1,992 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/JsonMap.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/detail/JsonDocument.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace tmx;
+
+namespace
+{
+    bool getLayerType(const char* name, Layer::Type& type)
+    {
+        if (std::strcmp(name, "tilelayer") == 0)
+        {
+            type = Layer::Type::Tile;
+        }
+        else if (std::strcmp(name, "objectgroup") == 0)
+        {
+            type = Layer::Type::Object;
+        }
+        else if (std::strcmp(name, "imagelayer") == 0)
+        {
+            type = Layer::Type::Image;
+        }
+        else if (std::strcmp(name, "group") == 0)
+        {
+            type = Layer::Type::Group;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    //the member holding the class of objects and tiles was briefly
+    //named 'class' in Tiled 1.9, before returning to 'type'
+    std::string getClass(const JsonValue& node)
+    {
+        auto retVal = node["type"].asString();
+        return retVal.empty() ? node["class"].asString() : retVal;
+    }
+
+    //reports the error and returns false
+    bool parseFailed(const std::string& message, const JsonDocument& document)
+    {
+        Logger::log(message, Logger::Type::Error);
+        Logger::log("Reason: " + document.getError(), Logger::Type::Error);
+        return false;
+    }
+}
+
+//has access to the private members of the classes which make up a map
+class JsonMap::Parser final
+{
+public:
+    static bool parseMap(const JsonValue& node, Map& map)
+    {
+        if (!node.isObject())
+        {
+            Logger::log("Failed opening map: document is not a JSON object", Logger::Type::Error);
+            return map.reset();
+        }
+
+        auto type = node["type"].asString("map");
+        if (type != "map")
+        {
+            Logger::log("Failed opening map: document is a " + type + ", not a map", Logger::Type::Error);
+            return map.reset();
+        }
+
+        //older versions of Tiled store the version as a number
+        std::size_t pointPos = 0;
+        auto attribString = node["version"].asString();
+        if (attribString.empty() || (pointPos = attribString.find('.')) == std::string::npos)
+        {
+            Logger::log("Invalid map version value, map not loaded.", Logger::Type::Error);
+            return map.reset();
+        }
+
+        map.m_version.upper = static_cast<std::uint16_t>(STOI(attribString.substr(0, pointPos)));
+        map.m_version.lower = static_cast<std::uint16_t>(STOI(attribString.substr(pointPos + 1)));
+
+        map.m_class = node["class"].asString();
+
+        attribString = node["orientation"].asString();
+        if (attribString.empty())
+        {
+            Logger::log("Missing map orientation attribute, map not loaded.", Logger::Type::Error);
+            return map.reset();
+        }
+
+        if (attribString == "orthogonal")
+        {
+            map.m_orientation = Orientation::Orthogonal;
+        }
+        else if (attribString == "isometric")
+        {
+            map.m_orientation = Orientation::Isometric;
+        }
+        else if (attribString == "staggered")
+        {
+            map.m_orientation = Orientation::Staggered;
+        }
+        else if (attribString == "hexagonal")
+        {
+            map.m_orientation = Orientation::Hexagonal;
+        }
+        else
+        {
+            Logger::log(attribString + " format maps aren't supported yet, sorry! Map not loaded", Logger::Type::Error);
+            return map.reset();
+        }
+
+        attribString = node["renderorder"].asString();
+        if (!attribString.empty())
+        {
+            if (attribString == "right-down")
+            {
+                map.m_renderOrder = RenderOrder::RightDown;
+            }
+            else if (attribString == "right-up")
+            {
+                map.m_renderOrder = RenderOrder::RightUp;
+            }
+            else if (attribString == "left-down")
+            {
+                map.m_renderOrder = RenderOrder::LeftDown;
+            }
+            else if (attribString == "left-up")
+            {
+                map.m_renderOrder = RenderOrder::LeftUp;
+            }
+            else
+            {
+                Logger::log(attribString + ": invalid render order. Map not loaded.", Logger::Type::Error);
+                return map.reset();
+            }
+        }
+
+        map.m_infinite = node["infinite"].asBool(false);
+
+        map.m_tileCount = { node["width"].asUInt(), node["height"].asUInt() };
+        if (map.m_tileCount.x == 0 || map.m_tileCount.y == 0)
+        {
+            Logger::log("Invalid map tile count, map not loaded", Logger::Type::Error);
+            return map.reset();
+        }
+
+        map.m_tileSize = { node["tilewidth"].asUInt(), node["tileheight"].asUInt() };
+        if (map.m_tileSize.x == 0 || map.m_tileSize.y == 0)
+        {
+            Logger::log("Invalid tile size, map not loaded", Logger::Type::Error);
+            return map.reset();
+        }
+
+        map.m_hexSideLength = node["hexsidelength"].asFloat();
+        if (map.m_orientation == Orientation::Hexagonal && map.m_hexSideLength <= 0)
+        {
+            Logger::log("Invalid he side length found, map not loaded", Logger::Type::Error);
+            return map.reset();
+        }
+
+        attribString = node["staggeraxis"].asString();
+        if (attribString == "x")
+        {
+            map.m_staggerAxis = StaggerAxis::X;
+        }
+        else if (attribString == "y")
+        {
+            map.m_staggerAxis = StaggerAxis::Y;
+        }
+        if ((map.m_orientation == Orientation::Staggered || map.m_orientation == Orientation::Hexagonal)
+            && map.m_staggerAxis == StaggerAxis::None)
+        {
+            Logger::log("Map missing stagger axis property. Map not loaded.", Logger::Type::Error);
+            return map.reset();
+        }
+
+        attribString = node["staggerindex"].asString();
+        if (attribString == "odd")
+        {
+            map.m_staggerIndex = StaggerIndex::Odd;
+        }
+        else if (attribString == "even")
+        {
+            map.m_staggerIndex = StaggerIndex::Even;
+        }
+        if ((map.m_orientation == Orientation::Staggered || map.m_orientation == Orientation::Hexagonal)
+            && map.m_staggerIndex == StaggerIndex::None)
+        {
+            Logger::log("Map missing stagger index property. Map not loaded.", Logger::Type::Error);
+            return map.reset();
+        }
+
+        map.m_parallaxOrigin = { node["parallaxoriginx"].asFloat(0.f), node["parallaxoriginy"].asFloat(0.f) };
+
+        attribString = node["backgroundcolor"].asString();
+        if (!attribString.empty())
+        {
+            map.m_backgroundColour = colourFromString(attribString);
+        }
+
+        parseProperties(node["properties"], map.m_properties);
+
+        if (map.m_loadState)
+        {
+            map.m_loadState->totalLayers = countLayers(node["layers"], {}, map);
+            map.m_loadState->report();
+        }
+
+        //as with XML maps tile sets and layers are created in document
+        //order, but the expensive parts of parsing them may be run in parallel
+        TaskGroup tasks(map.m_executor);
+
+        //tasks hold pointers to the tilesets so make sure they never move
+        const auto tilesets = node["tilesets"];
+        map.m_tilesets.reserve(tilesets.size());
+        for (const auto tilesetNode : tilesets)
+        {
+            map.m_tilesets.emplace_back(map.m_workingDirectory);
+            map.m_tilesets.back().setExecutor(map.m_executor);
+            auto* tileset = &map.m_tilesets.back();
+            auto* mapPtr = &map;
+            tasks.run([tileset, tilesetNode, mapPtr]() { parseTileset(tilesetNode, *tileset, mapPtr); });
+        }
+
+        parseLayers(node["layers"], map.m_layers, map, map.m_workingDirectory, map.m_tileCount, {}, tasks);
+        tasks.wait();
+
+        if (map.isLoadCancelled())
+        {
+            Logger::log("Map loading cancelled", Logger::Type::Info);
+            return map.reset();
+        }
+
+        map.finaliseLoad();
+        return true;
+    }
+
+    static bool parseTileset(const JsonValue& node, Tileset& tileset, Map* map)
+    {
+        //copies of the tile set may share its data, so never modify it in place
+        tileset.m_data = std::make_shared<Tileset::Data>();
+        auto& data = *tileset.m_data;
+
+        if (map)
+        {
+            auto source = node["source"].asString();
+            if (!source.empty())
+            {
+                return tileset.parseReference(node["firstgid"].asUInt(), source, map);
+            }
+
+            tileset.m_assetProvider = map->getAssetProvider();
+
+            tileset.m_firstGID = node["firstgid"].asUInt();
+            if (tileset.m_firstGID == 0)
+            {
+                Logger::log("Invalid first GID in tileset. Tileset node skipped.", Logger::Type::Warning);
+                return false;
+            }
+        }
+
+        data.name = node["name"].asString();
+        LOG("found tile set " + data.name, Logger::Type::Info);
+        data.className = node["class"].asString();
+
+        data.tileSize = { node["tilewidth"].asUInt(), node["tileheight"].asUInt() };
+        if (data.tileSize.x == 0 || data.tileSize.y == 0)
+        {
+            Logger::log("Invalid tile size found in tile set node. Node will be skipped.", Logger::Type::Error);
+            return tileset.reset();
+        }
+
+        data.spacing = node["spacing"].asUInt();
+        data.margin = node["margin"].asUInt();
+        data.tileCount = node["tilecount"].asUInt();
+        data.columnCount = node["columns"].asUInt();
+
+        data.tileIndex.reserve(data.tileCount);
+        data.tiles.reserve(data.tileCount);
+
+        static const std::pair<const char*, Tileset::ObjectAlignment> alignments[] =
+        {
+            { "unspecified", Tileset::ObjectAlignment::Unspecified },
+            { "topleft", Tileset::ObjectAlignment::TopLeft },
+            { "top", Tileset::ObjectAlignment::Top },
+            { "topright", Tileset::ObjectAlignment::TopRight },
+            { "left", Tileset::ObjectAlignment::Left },
+            { "center", Tileset::ObjectAlignment::Center },
+            { "right", Tileset::ObjectAlignment::Right },
+            { "bottomleft", Tileset::ObjectAlignment::BottomLeft },
+            { "bottom", Tileset::ObjectAlignment::Bottom },
+            { "bottomright", Tileset::ObjectAlignment::BottomRight }
+        };
+
+        const char* objectAlignment = node["objectalignment"].asCString();
+        for (const auto& alignment : alignments)
+        {
+            if (std::strcmp(objectAlignment, alignment.first) == 0)
+            {
+                data.objectAlignment = alignment.second;
+            }
+        }
+
+        auto image = node["image"].asString();
+        if (!image.empty())
+        {
+            data.imagePath = resolveFilePath(image, tileset.m_workingDir);
+            data.imageSize = { node["imagewidth"].asUInt(), node["imageheight"].asUInt() };
+        }
+
+        auto transparency = node["transparentcolor"].asString();
+        if (!transparency.empty())
+        {
+            data.transparencyColour = colourFromString(transparency);
+            data.hasTransparency = true;
+        }
+
+        const auto offset = node["tileoffset"];
+        data.tileOffset = { offset["x"].asUInt(), offset["y"].asUInt() };
+
+        parseProperties(node["properties"], data.properties);
+
+        for (const auto terrainNode : node["terrains"])
+        {
+            data.terrainTypes.emplace_back();
+            auto& terrain = data.terrainTypes.back();
+            terrain.name = terrainNode["name"].asString();
+            terrain.tileID = terrainNode["tile"].asUInt();
+            parseProperties(terrainNode["properties"], terrain.properties);
+        }
+
+        for (const auto tileNode : node["tiles"])
+        {
+            parseTile(tileNode, tileset.newTile(tileNode["id"].asUInt()), tileset, map);
+        }
+
+        //if the tile set does not declare every tile, we create the missing ones
+        if (data.tiles.size() != data.tileCount)
+        {
+            for (std::uint32_t ID = 0; ID < data.tileCount; ID++)
+            {
+                tileset.createMissingTile(ID);
+            }
+        }
+        return true;
+    }
+
+    static void parseObject(const JsonValue& node, Object& object, Map* map)
+    {
+        object.m_UID = node["id"].asUInt();
+        object.m_name = node["name"].asString();
+        object.m_class = getClass(node);
+
+        object.m_position = { node["x"].asFloat(), node["y"].asFloat() };
+        object.m_AABB = { object.m_position.x, object.m_position.y, node["width"].asFloat(), node["height"].asFloat() };
+        object.m_rotation = node["rotation"].asFloat();
+        object.m_visible = node["visible"].asBool(true);
+
+        static const std::uint32_t mask = 0xf0000000;
+        auto gid = node["gid"].asUInt();
+        object.m_flipFlags = ((gid & mask) >> 28);
+        object.m_tileID = gid & ~mask;
+
+        parseProperties(node["properties"], object.m_properties);
+
+        if (node["ellipse"].asBool())
+        {
+            object.m_shape = Object::Shape::Ellipse;
+        }
+        else if (node["point"].asBool())
+        {
+            object.m_shape = Object::Shape::Point;
+        }
+        else if (node["polygon"])
+        {
+            object.m_shape = Object::Shape::Polygon;
+            parsePoints(node["polygon"], object.m_points);
+        }
+        else if (node["polyline"])
+        {
+            object.m_shape = Object::Shape::Polyline;
+            parsePoints(node["polyline"], object.m_points);
+        }
+        else if (node["text"])
+        {
+            object.m_shape = Object::Shape::Text;
+            parseText(node["text"], object.m_textData);
+        }
+
+        //parse templates last so we know which properties
+        //ought to be overridden
+        auto templateStr = node["template"].asString();
+        if (!templateStr.empty() && map)
+        {
+            object.parseTemplate(templateStr, map);
+        }
+    }
+
+private:
+    static void parseProperties(const JsonValue& node, std::vector<Property>& properties)
+    {
+        for (const auto propertyNode : node)
+        {
+            properties.emplace_back();
+            parseProperty(propertyNode, properties.back());
+        }
+    }
+
+    static void parseProperty(const JsonValue& node, Property& property)
+    {
+        property.m_name = node["name"].asString();
+
+        const auto value = node["value"];
+        std::string type = node["type"].asString("string");
+        if (type == "bool")
+        {
+            property.m_boolValue = value.asBool();
+            property.m_type = Property::Type::Boolean;
+        }
+        else if (type == "int")
+        {
+            property.m_intValue = value.asInt();
+            property.m_type = Property::Type::Int;
+        }
+        else if (type == "float")
+        {
+            property.m_floatValue = value.asFloat();
+            property.m_type = Property::Type::Float;
+        }
+        else if (type == "string")
+        {
+            property.m_stringValue = value.asString();
+            property.m_type = Property::Type::String;
+        }
+        else if (type == "color")
+        {
+            property.m_colourValue = colourFromString(value.asString("#FFFFFFFF"));
+            property.m_type = Property::Type::Colour;
+        }
+        else if (type == "file")
+        {
+            property.m_stringValue = value.asString();
+            property.m_type = Property::Type::File;
+        }
+        else if (type == "object")
+        {
+            property.m_intValue = value.asInt();
+            property.m_type = Property::Type::Object;
+        }
+        else if (type == "class")
+        {
+            property.m_type = Property::Type::Class;
+            property.m_propertyType = node["propertytype"].asString("null");
+            parseClassMembers(value, property.m_classValue);
+        }
+    }
+
+    //members of class properties are stored by name without their
+    //types, so the type is inferred from the value as best it can be
+    static void parseClassMembers(const JsonValue& node, std::vector<Property>& members)
+    {
+        node.forEachMember([&members](const char* name, const JsonValue& value)
+        {
+            Property member;
+            member.m_name = name;
+
+            switch (value.getType())
+            {
+            default: return;
+            case JsonDocument::Type::Boolean:
+                member.m_boolValue = value.asBool();
+                member.m_type = Property::Type::Boolean;
+                break;
+            case JsonDocument::Type::Number:
+            {
+                auto text = value.asString();
+                if (text.find_first_of(".eE") == std::string::npos)
+                {
+                    member.m_intValue = value.asInt();
+                    member.m_type = Property::Type::Int;
+                }
+                else
+                {
+                    member.m_floatValue = value.asFloat();
+                    member.m_type = Property::Type::Float;
+                }
+            }
+                break;
+            case JsonDocument::Type::String:
+                member.m_stringValue = value.asString();
+                member.m_type = Property::Type::String;
+                break;
+            case JsonDocument::Type::Object:
+                member.m_type = Property::Type::Class;
+                parseClassMembers(value, member.m_classValue);
+                break;
+            }
+            members.push_back(std::move(member));
+        });
+    }
+
+    static void parsePoints(const JsonValue& node, std::vector<Vector2f>& points)
+    {
+        for (const auto point : node)
+        {
+            points.emplace_back(point["x"].asFloat(), point["y"].asFloat());
+        }
+
+        if (points.empty())
+        {
+            Logger::log("Points for polygon or polyline object are missing", Logger::Type::Warning);
+        }
+    }
+
+    static void parseText(const JsonValue& node, Text& text)
+    {
+        text.bold = node["bold"].asBool(false);
+        text.colour = colourFromString(node["color"].asString("#FFFFFFFF"));
+        text.fontFamily = node["fontfamily"].asString();
+        text.italic = node["italic"].asBool(false);
+        text.kerning = node["kerning"].asBool(true);
+        text.pixelSize = node["pixelsize"].asUInt(16);
+        text.strikethough = node["strikeout"].asBool(false);
+        text.underline = node["underline"].asBool(false);
+        text.wrap = node["wrap"].asBool(false);
+
+        std::string alignment = node["halign"].asString("left");
+        if (alignment == "left")
+        {
+            text.hAlign = Text::HAlign::Left;
+        }
+        else if (alignment == "center")
+        {
+            text.hAlign = Text::HAlign::Centre;
+        }
+        else if (alignment == "right")
+        {
+            text.hAlign = Text::HAlign::Right;
+        }
+
+        alignment = node["valign"].asString("top");
+        if (alignment == "top")
+        {
+            text.vAlign = Text::VAlign::Top;
+        }
+        else if (alignment == "center")
+        {
+            text.vAlign = Text::VAlign::Centre;
+        }
+        else if (alignment == "bottom")
+        {
+            text.vAlign = Text::VAlign::Bottom;
+        }
+
+        text.content = node["text"].asString();
+    }
+
+    static void parseTile(const JsonValue& node, Tileset::Tile& tile, const Tileset& tileset, Map* map)
+    {
+        const auto& data = *tileset.m_data;
+
+        //terrain is stored as the indices of the four corners, or -1
+        auto terrain = node["terrain"];
+        if (terrain.isNumberArray())
+        {
+            const char* current = terrain.asCString();
+            for (auto& index : tile.terrainIndices)
+            {
+                char* end = nullptr;
+                index = static_cast<std::int32_t>(std::strtol(current, &end, 10));
+                if (end == current)
+                {
+                    break;
+                }
+                current = end;
+                while (*current == ',' || *current == ' ' || *current == '\n' || *current == '\r' || *current == '\t')
+                {
+                    ++current;
+                }
+            }
+        }
+
+        tile.probability = node["probability"].asUInt(100);
+        tile.className = getClass(node);
+
+        //by default we set the tile's values as in an Image tileset
+        tile.imagePath = data.imagePath;
+        tile.imageSize = data.tileSize;
+
+        if (data.columnCount != 0)
+        {
+            std::uint32_t rowIndex = tile.ID % data.columnCount;
+            std::uint32_t columnIndex = tile.ID / data.columnCount;
+            tile.imagePosition.x = data.margin + rowIndex * (data.tileSize.x + data.spacing);
+            tile.imagePosition.y = data.margin + columnIndex * (data.tileSize.y + data.spacing);
+        }
+
+        parseProperties(node["properties"], tile.properties);
+
+        const auto objectGroup = node["objectgroup"];
+        if (objectGroup)
+        {
+            parseObjectGroup(objectGroup, tile.objectGroup, map);
+        }
+
+        auto image = node["image"].asString();
+        if (!image.empty())
+        {
+            tile.imagePath = resolveFilePath(image, tileset.m_workingDir);
+            tile.imagePosition = tmx::Vector2u(0, 0);
+            tile.imageSize.x = node["imagewidth"].asUInt(tile.imageSize.x);
+            tile.imageSize.y = node["imageheight"].asUInt(tile.imageSize.y);
+        }
+
+        for (const auto frameNode : node["animation"])
+        {
+            Tileset::Tile::Animation::Frame frame;
+            frame.duration = frameNode["duration"].asUInt();
+            frame.tileID = frameNode["tileid"].asUInt();
+            tile.animation.frames.push_back(frame);
+        }
+    }
+
+    //properties common to all layers
+    static void parseLayer(const JsonValue& node, Layer& layer)
+    {
+        layer.m_name = node["name"].asString();
+        layer.m_class = node["class"].asString();
+        layer.m_opacity = node["opacity"].asFloat(1.f);
+        layer.m_visible = node["visible"].asBool(true);
+        layer.m_offset = { node["offsetx"].asInt(), node["offsety"].asInt() };
+        layer.m_size = { node["width"].asUInt(), node["height"].asUInt() };
+        layer.m_parallaxFactor = { node["parallaxx"].asFloat(1.f), node["parallaxy"].asFloat(1.f) };
+
+        auto tintColour = node["tintcolor"].asString();
+        if (!tintColour.empty())
+        {
+            layer.m_tintColour = colourFromString(tintColour);
+        }
+    }
+
+    //tile data is either base64 text, or an array of IDs which, having the
+    //same syntax as CSV, is handed straight to the CSV decoder
+    static const char* getLayerData(const JsonValue& node, bool base64)
+    {
+        return base64 ? node.asCString(nullptr) : (node.isNumberArray() ? node.asCString() : nullptr);
+    }
+
+    static void parseTileLayer(const JsonValue& node, TileLayer& layer, Map& map)
+    {
+        parseLayer(node, layer);
+        parseProperties(node["properties"], layer.m_properties);
+
+        std::string encoding = node["encoding"].asString("csv");
+        const bool base64 = (encoding == "base64");
+
+        const char* data = getLayerData(node["data"], base64);
+        if (data && *data == 0)
+        {
+            data = nullptr;
+        }
+
+        std::vector<TileLayer::EncodedChunk> chunks;
+        for (const auto chunkNode : node["chunks"])
+        {
+            const char* chunkData = getLayerData(chunkNode["data"], base64);
+            if (chunkData && *chunkData != 0)
+            {
+                chunks.emplace_back();
+                auto& chunk = chunks.back();
+                chunk.position = { chunkNode["x"].asInt(), chunkNode["y"].asInt() };
+                chunk.size = { chunkNode["width"].asInt(), chunkNode["height"].asInt() };
+                chunk.data = chunkData;
+            }
+        }
+
+        layer.parseEncoded(base64 ? "base64" : "csv", node["compression"].asString(), data, std::move(chunks), &map);
+    }
+
+    static void parseObjectGroup(const JsonValue& node, ObjectGroup& group, Map* map)
+    {
+        parseLayer(node, group);
+
+        auto colour = node["color"].asString();
+        if (!colour.empty())
+        {
+            group.m_colour = colourFromString(colour);
+        }
+
+        if (node["draworder"].asString() == "index")
+        {
+            group.m_drawOrder = ObjectGroup::DrawOrder::Index;
+        }
+
+        parseProperties(node["properties"], group.m_properties);
+
+        const auto objects = node["objects"];
+        group.m_objects.reserve(objects.size());
+        for (const auto objectNode : objects)
+        {
+            group.m_objects.emplace_back();
+            parseObject(objectNode, group.m_objects.back(), map);
+        }
+    }
+
+    static void parseImageLayer(const JsonValue& node, ImageLayer& layer)
+    {
+        parseLayer(node, layer);
+        parseProperties(node["properties"], layer.m_properties);
+
+        layer.m_hasRepeatX = node["repeatx"].asBool(false);
+        layer.m_hasRepeatY = node["repeaty"].asBool(false);
+        layer.m_locked = node["locked"].asBool(false);
+
+        auto image = node["image"].asString();
+        if (!image.empty())
+        {
+            layer.m_filePath = resolveFilePath(image, layer.m_workingDir);
+            layer.m_imageSize = { node["imagewidth"].asUInt(), node["imageheight"].asUInt() };
+
+            auto transparency = node["transparentcolor"].asString();
+            if (!transparency.empty())
+            {
+                layer.m_transparencyColour = colourFromString(transparency);
+                layer.m_hasTransparency = true;
+            }
+        }
+    }
+
+    static void parseLayerGroup(const JsonValue& node, LayerGroup& group, Map& map, const std::string& groupPath)
+    {
+        parseLayer(node, group);
+        parseProperties(node["properties"], group.m_properties);
+
+        //group paths are only needed by the layer filter
+        std::string childPath;
+        if (map.m_layerFilter)
+        {
+            childPath = groupPath.empty() ? group.getName() : groupPath + "/" + group.getName();
+        }
+
+        TaskGroup tasks(map.m_executor);
+        parseLayers(node["layers"], group.m_layers, map, group.m_workingDir, group.m_tileCount, childPath, tasks);
+        tasks.wait();
+    }
+
+    static void parseAnyLayer(const JsonValue& node, Layer& layer, Map& map, const std::string& groupPath)
+    {
+        if (map.isLoadCancelled())
+        {
+            return;
+        }
+
+        switch (layer.getType())
+        {
+        case Layer::Type::Tile:
+            parseTileLayer(node, layer.getLayerAs<TileLayer>(), map);
+            break;
+        case Layer::Type::Object:
+            parseObjectGroup(node, layer.getLayerAs<ObjectGroup>(), &map);
+            break;
+        case Layer::Type::Image:
+            parseImageLayer(node, layer.getLayerAs<ImageLayer>());
+            break;
+        case Layer::Type::Group:
+            parseLayerGroup(node, layer.getLayerAs<LayerGroup>(), map, groupPath);
+            break;
+        }
+
+        if (map.m_loadState)
+        {
+            map.m_loadState->layersLoaded++;
+            map.m_loadState->report();
+        }
+    }
+
+    static void parseLayers(const JsonValue& node, std::vector<Layer::Ptr>& layers, Map& map,
+        const std::string& workingDir, const Vector2u& tileCount, const std::string& groupPath, TaskGroup& tasks)
+    {
+        auto* mapPtr = &map;
+        for (const auto layerNode : node)
+        {
+            if (map.isLoadCancelled())
+            {
+                break;
+            }
+
+            //layers rejected by the filter are skipped before anything is parsed
+            Layer::Type type = Layer::Type::Tile;
+            if (!getLayerType(layerNode["type"].asCString(), type))
+            {
+                LOG("Unidentified layer type " + layerNode["type"].asString() + ": layer skipped", Logger::Type::Warning);
+                continue;
+            }
+
+            if (!acceptLayer(layerNode, type, groupPath, map))
+            {
+                continue;
+            }
+
+            switch (type)
+            {
+            case Layer::Type::Tile:
+                layers.emplace_back(std::make_unique<TileLayer>(tileCount.x * tileCount.y));
+                break;
+            case Layer::Type::Object:
+                layers.emplace_back(std::make_unique<ObjectGroup>());
+                break;
+            case Layer::Type::Image:
+                layers.emplace_back(std::make_unique<ImageLayer>(workingDir));
+                break;
+            case Layer::Type::Group:
+                layers.emplace_back(std::make_unique<LayerGroup>(workingDir, tileCount));
+                break;
+            }
+
+            //image layers are too cheap to be worth a task
+            auto* layer = layers.back().get();
+            if (type == Layer::Type::Image)
+            {
+                parseAnyLayer(layerNode, *layer, map, groupPath);
+            }
+            else
+            {
+                tasks.run([layerNode, layer, mapPtr, groupPath]() { parseAnyLayer(layerNode, *layer, *mapPtr, groupPath); });
+            }
+        }
+    }
+
+    static bool acceptLayer(const JsonValue& node, Layer::Type type, const std::string& groupPath, const Map& map)
+    {
+        if (!map.m_layerFilter)
+        {
+            return true;
+        }
+
+        Map::LayerInfo info;
+        info.name = node["name"].asString();
+        info.className = node["class"].asString();
+        info.type = type;
+        info.groupPath = groupPath;
+        return map.m_layerFilter(info);
+    }
+
+    static std::size_t countLayers(const JsonValue& node, const std::string& groupPath, const Map& map)
+    {
+        std::size_t count = 0;
+        for (const auto layerNode : node)
+        {
+            Layer::Type type = Layer::Type::Tile;
+            if (!getLayerType(layerNode["type"].asCString(), type)
+                || !acceptLayer(layerNode, type, groupPath, map))
+            {
+                continue;
+            }
+
+            count++;
+            if (type == Layer::Type::Group)
+            {
+                std::string childPath;
+                if (map.m_layerFilter)
+                {
+                    auto name = layerNode["name"].asString();
+                    childPath = groupPath.empty() ? name : groupPath + "/" + name;
+                }
+                count += countLayers(layerNode["layers"], childPath, map);
+            }
+        }
+        return count;
+    }
+};
+
+//public
+bool JsonMap::read(Map& map, char* data, std::size_t size, const std::string& workingDir)
+{
+    map.reset();
+
+    JsonDocument document;
+    if (!document.parse(data, size))
+    {
+        return parseFailed("Failed opening map", document);
+    }
+    map.setBytesParsed(size, size);
+
+    //make sure we have consistent path separators
+    map.m_workingDirectory = workingDir;
+    std::replace(map.m_workingDirectory.begin(), map.m_workingDirectory.end(), '\\', '/');
+    if (!map.m_workingDirectory.empty() &&
+        map.m_workingDirectory.back() == '/')
+    {
+        map.m_workingDirectory.pop_back();
+    }
+
+    return Parser::parseMap(JsonValue(document.getRoot()), map);
+}
+
+bool JsonMap::read(Tileset& tileset, char* data, std::size_t size)
+{
+    JsonDocument document;
+    if (!document.parse(data, size))
+    {
+        return parseFailed("Failed to parse tileset JSON", document);
+    }
+
+    JsonValue root(document.getRoot());
+    if (!root.isObject() || root["type"].asString("tileset") != "tileset")
+    {
+        Logger::log("Failed opening tileset: no tileset found", Logger::Type::Error);
+        return tileset.reset();
+    }
+
+    return Parser::parseTileset(root, tileset, nullptr);
+}
+
+bool JsonMap::isJson(const char* data, std::size_t size)
+{
+    const auto* end = data + size;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+    {
+        data += 3;
+    }
+
+    while (data != end && (*data == ' ' || *data == '\n' || *data == '\r' || *data == '\t'))
+    {
+        ++data;
+    }
+    return data != end && *data == '{';
+}
+
+//private
+bool JsonMap::readTemplate(char* data, std::size_t size, const std::string& path, Object& object, std::string& tilesetSource, std::uint32_t& firstGID)
+{
+    JsonDocument document;
+    if (!document.parse(data, size))
+    {
+        return parseFailed("Failed opening template file " + path, document);
+    }
+
+    JsonValue root(document.getRoot());
+    const auto objectNode = root["object"];
+    if (!objectNode.isObject())
+    {
+        Logger::log("Object node missing from template " + path, Logger::Type::Error);
+        return false;
+    }
+
+    const auto tileset = root["tileset"];
+    tilesetSource = tileset["source"].asString();
+    firstGID = tileset["firstgid"].asUInt();
+
+    //parsed without the map so that templates can't contain templates
+    Parser::parseObject(objectNode, object, nullptr);
+    return true;
+}
@@ -34,6 +34,7 @@ source distribution.
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/ObjectGroup.hpp>
 #include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/Map.hpp>
 #include <tmxlite/TileLayer.hpp>
 #include <tmxlite/detail/Log.hpp>
 
@@ -70,9 +71,24 @@ void LayerGroup::parse(const pugi::xml_node& node, Map* map)
         setTintColour(colourFromString(tintColour));
     }
 
+    //child layers are created in document order, and parsed
+    //in parallel if the map has an executor
+    TaskGroup tasks(map->getExecutor());
+    const auto groupPath = map->getLayerFilter() ? Map::getGroupPath(node) : std::string();
+
     // parse children
     for (const auto& child : node.children())
     {
+        if (map->isLoadCancelled())
+        {
+            break;
+        }
+
+        if (!map->acceptLayer(child, groupPath))
+        {
+            continue;
+        }
+
         attribString = child.name();
         if (attribString == "properties")
         {
@@ -84,26 +100,31 @@ void LayerGroup::parse(const pugi::xml_node& node, Map* map)
         else if (attribString == "layer")
         {
             m_layers.emplace_back(std::make_unique<TileLayer>(m_tileCount.x * m_tileCount.y));
-            m_layers.back()->parse(child, map);
+            auto* layer = m_layers.back().get();
+            tasks.run([layer, child, map]() { map->parseLayer(*layer, child); });
         }
         else if (attribString == "objectgroup")
         {
             m_layers.emplace_back(std::make_unique<ObjectGroup>());
-            m_layers.back()->parse(child, map);
+            auto* layer = m_layers.back().get();
+            tasks.run([layer, child, map]() { map->parseLayer(*layer, child); });
         }
         else if (attribString == "imagelayer")
         {
             m_layers.emplace_back(std::make_unique<ImageLayer>(m_workingDir));
-            m_layers.back()->parse(child, map);
+            map->parseLayer(*m_layers.back(), child);
         }
         else if (attribString == "group")
         {
             m_layers.emplace_back(std::make_unique<LayerGroup>(m_workingDir, m_tileCount));
-            m_layers.back()->parse(child, map);
+            auto* layer = m_layers.back().get();
+            tasks.run([layer, child, map]() { map->parseLayer(*layer, child); });
         }
         else
         {
             LOG("Unidentified name " + attribString + ": node skipped", Logger::Type::Warning);
         }
     }
+
+    tasks.wait();
 }
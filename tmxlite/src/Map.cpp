@@ -30,8 +30,10 @@ source distribution.
 #else
 #include "detail/pugixml.hpp"
 #endif
+#include <tmxlite/BinaryMap.hpp>
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/JsonMap.hpp>
 #include <tmxlite/LayerGroup.hpp>
 #include <tmxlite/Map.hpp>
 #include <tmxlite/ObjectGroup.hpp>
@@ -39,17 +41,199 @@ source distribution.
 #include <tmxlite/detail/Android.hpp>
 #include <tmxlite/detail/Log.hpp>
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
 #include <queue>
+#include <random>
 
 using namespace tmx;
 
+namespace
+{
+    //cache entries are the list of dependencies, each with the hash of
+    //its contents when the entry was written, followed by a binary map
+    const char CacheMagic[] = { 'T', 'M', 'X', 'C' };
+    const std::string CacheExtension(".tmxc");
+
+    std::string toHex(std::uint64_t value)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string retVal(16, '0');
+        for (auto i = 15; i >= 0; --i, value >>= 4)
+        {
+            retVal[i] = digits[value & 0xf];
+        }
+        return retVal;
+    }
+
+    //returns 0 if the file can't be read, so that
+    //creating a missing file invalidates the cache
+    std::uint64_t hashFile(AssetProvider& provider, const std::string& path)
+    {
+        AssetBuffer file;
+        if (provider.open(path, file))
+        {
+            return hashData(file.data(), file.size());
+        }
+        return 0;
+    }
+
+    void append32(std::vector<char>& dest, std::uint32_t value)
+    {
+        for (auto i = 0; i < 4; ++i, value >>= 8)
+        {
+            dest.push_back(static_cast<char>(value & 0xff));
+        }
+    }
+
+    void append64(std::vector<char>& dest, std::uint64_t value)
+    {
+        append32(dest, static_cast<std::uint32_t>(value));
+        append32(dest, static_cast<std::uint32_t>(value >> 32));
+    }
+
+    //reads a little endian value of 'byteCount' bytes and advances
+    //'data' past it. Returns false if fewer bytes than that remain
+    bool readValue(const char*& data, const char* end, std::size_t byteCount, std::uint64_t& value)
+    {
+        if (static_cast<std::size_t>(end - data) < byteCount)
+        {
+            return false;
+        }
+
+        value = 0;
+        for (auto i = 0u; i < byteCount; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(*data++)) << (i * 8);
+        }
+        return true;
+    }
+
+    //returns the offset of the binary map in the entry, or 0 if the entry
+    //is malformed or any of its dependencies have changed
+    std::size_t readCacheHeader(AssetProvider& provider, const char* data, std::size_t size, std::vector<std::string>& dependencies)
+    {
+        if (size < sizeof(CacheMagic)
+            || std::memcmp(data, CacheMagic, sizeof(CacheMagic)) != 0)
+        {
+            return 0;
+        }
+
+        const char* current = data + sizeof(CacheMagic);
+        const char* end = data + size;
+
+        std::uint64_t count = 0;
+        if (!readValue(current, end, 4, count))
+        {
+            return 0;
+        }
+
+        for (auto i = 0u; i < count; ++i)
+        {
+            std::uint64_t length = 0;
+            std::uint64_t hash = 0;
+            if (!readValue(current, end, 4, length)
+                || static_cast<std::uint64_t>(end - current) < length)
+            {
+                return 0;
+            }
+
+            std::string path(current, static_cast<std::size_t>(length));
+            current += length;
+            if (!readValue(current, end, 8, hash)
+                || hashFile(provider, path) != hash)
+            {
+                return 0;
+            }
+            dependencies.push_back(std::move(path));
+        }
+        return static_cast<std::size_t>(current - data);
+    }
+
+    void writeCacheEntry(AssetProvider& provider, const std::string& path, const Map& map)
+    {
+        std::vector<char> entry(CacheMagic, CacheMagic + sizeof(CacheMagic));
+        append32(entry, static_cast<std::uint32_t>(map.getDependencies().size()));
+        for (const auto& dependency : map.getDependencies())
+        {
+            append32(entry, static_cast<std::uint32_t>(dependency.size()));
+            entry.insert(entry.end(), dependency.begin(), dependency.end());
+            append64(entry, hashFile(provider, dependency));
+        }
+
+        std::vector<char> binary;
+        BinaryMap::write(map, binary);
+        entry.insert(entry.end(), binary.begin(), binary.end());
+
+        //the entry is written to a uniquely named file and then renamed,
+        //so that other processes never see a partially written entry
+        std::random_device rd;
+        auto tempPath = path + "." + toHex((static_cast<std::uint64_t>(rd()) << 32) | rd()) + ".tmp";
+
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            Logger::log("Failed to create map cache entry " + tempPath, Logger::Type::Warning);
+            return;
+        }
+        file.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+        file.close();
+
+        if (file.fail())
+        {
+            Logger::log("Failed to write map cache entry " + tempPath, Logger::Type::Warning);
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            //rename() won't replace an existing file on Windows, in which
+            //case another process most likely wrote the same entry
+            std::remove(tempPath.c_str());
+        }
+    }
+
+    void decodeLayers(const std::vector<Layer::Ptr>& layers, TaskGroup& tasks, Executor* executor)
+    {
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Tile)
+            {
+                const auto* tileLayer = &layer->getLayerAs<TileLayer>();
+                if (!tileLayer->isDecoded())
+                {
+                    tasks.run([tileLayer, executor]() { tileLayer->decode(executor); });
+                }
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                decodeLayers(layer->getLayerAs<LayerGroup>().getLayers(), tasks, executor);
+            }
+        }
+    }
+}
+
 Map::Map()
     : m_orientation (Orientation::None),
     m_renderOrder   (RenderOrder::None),
     m_infinite      (false),
     m_hexSideLength (0.f),
     m_staggerAxis   (StaggerAxis::None),
-    m_staggerIndex  (StaggerIndex::None)
+    m_staggerIndex  (StaggerIndex::None),
+    m_executor      (nullptr),
+    m_tilesetCache  (nullptr),
+    m_templateCache (nullptr),
+    m_assetProvider (nullptr),
+    m_lazyDecoding  (false)
 {
 
 }
@@ -57,17 +241,37 @@ Map::Map()
 //public
 bool Map::load(const std::string& path)
 {
-    std::string contents;
-    if (!readFileIntoString(path, &contents))
+    //the provider maps files where it can, in which case
+    //the document is parsed in place without being copied
+    AssetBuffer file;
+    if (!getProvider().open(path, file))
     {
         Logger::log("Failed to read file " + path, Logger::Type::Error);
         return reset();
     }
-    return loadFromString(contents, getFilePath(path));
+    setBytesParsed(0, file.size());
+
+    //binary maps are read straight from the buffer
+    if (BinaryMap::isBinaryMap(file.data(), file.size()))
+    {
+        return BinaryMap::read(*this, file.data(), file.size(), getFilePath(path));
+    }
+
+    if (!m_cacheDirectory.empty())
+    {
+        return loadCached(path, file.getMutableData(), file.size());
+    }
+    return loadFromBuffer(file.getMutableData(), file.size(), getFilePath(path));
 }
 
 bool Map::loadFromString(const std::string& data, const std::string& workingDir)
 {
+    //JSON is always parsed in place, so needs a copy
+    if (JsonMap::isJson(data.data(), data.size()))
+    {
+        return loadFromString(std::string(data), workingDir);
+    }
+
     reset();
 
     //open the doc
@@ -80,6 +284,146 @@ bool Map::loadFromString(const std::string& data, const std::string& workingDir)
         return false;
     }
 
+    return parseDocument(doc, workingDir);
+}
+
+bool Map::loadFromString(std::string&& data, const std::string& workingDir)
+{
+    return loadFromBuffer(&data[0], data.size(), workingDir);
+}
+
+bool Map::loadFromBuffer(char* data, std::size_t size, const std::string& workingDir)
+{
+    if (JsonMap::isJson(data, size))
+    {
+        return JsonMap::read(*this, data, size, workingDir);
+    }
+
+    reset();
+
+    pugi::xml_document doc;
+    auto result = doc.load_buffer_inplace(data, size);
+    if (!result)
+    {
+        Logger::log("Failed opening map", Logger::Type::Error);
+        Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+        return false;
+    }
+    setBytesParsed(size, size);
+
+    return parseDocument(doc, workingDir);
+}
+
+AsyncLoad Map::loadAsync(const std::string& path, AsyncLoad::ProgressCallback callback)
+{
+    AsyncLoad handle;
+    handle.m_state = std::make_shared<AsyncLoad::State>(std::move(callback));
+
+    m_loadState = handle.m_state;
+    handle.m_thread = std::thread([this, path]()
+    {
+        auto state = m_loadState;
+        state->result = load(path);
+
+        //binary and cached maps have no layers to report as they load
+        if (state->result && state->bytesParsed != state->totalBytes)
+        {
+            setBytesParsed(state->totalBytes, state->totalBytes);
+        }
+
+        m_loadState.reset();
+        state->finished = true;
+    });
+    return handle;
+}
+
+void Map::setExecutor(Executor* executor)
+{
+    m_executor = executor;
+
+    //a pool created by setThreadCount() is no longer needed
+    if (m_threadPool && m_executor != m_threadPool.get())
+    {
+        m_threadPool.reset();
+    }
+}
+
+void Map::setThreadCount(std::size_t count)
+{
+    //the old pool must stop before any new one is created so
+    //the total number of threads never exceeds the count
+    setExecutor(nullptr);
+
+    if (count != 1)
+    {
+        m_threadPool = std::make_unique<ThreadPool>(count);
+        m_executor = m_threadPool.get();
+    }
+}
+
+void Map::decodeAll() const
+{
+    TaskGroup tasks(m_executor);
+    decodeLayers(m_layers, tasks, m_executor);
+    tasks.wait();
+}
+
+void Map::addTileset(const Tileset& tileset)
+{
+    m_tilesets.push_back(tileset);
+
+    //refresh the animated tiles with those of the new tile set
+    finaliseLoad();
+}
+
+//private
+bool Map::loadCached(const std::string& path, char* data, std::size_t size)
+{
+    //resource paths are stored relative to the working directory so it
+    //forms part of the key, as does the binary format version. This has
+    //to be calculated first as parsing the document modifies the buffer
+    auto workingDir = getFilePath(path);
+    auto seed = hashData(workingDir.data(), workingDir.size(), BinaryMap::FormatVersion);
+    auto entryPath = m_cacheDirectory + "/" + toHex(hashData(data, size, seed)) + CacheExtension;
+
+    //cache entries are always on disk, whichever provider the map uses
+    AssetBuffer entry;
+    FileSystemProvider fileSystem;
+    if (fileSystem.open(entryPath, entry))
+    {
+        std::vector<std::string> dependencies;
+        auto offset = readCacheHeader(getProvider(), entry.data(), entry.size(), dependencies);
+        if (offset != 0
+            && BinaryMap::read(*this, entry.data() + offset, entry.size() - offset, workingDir))
+        {
+            LOG("Loaded " + path + " from " + entryPath, Logger::Type::Info);
+            m_dependencies.swap(dependencies);
+            return true;
+        }
+    }
+
+    if (!loadFromBuffer(data, size, workingDir))
+    {
+        return false;
+    }
+
+    //fails harmlessly if the directory already exists
+#ifdef _WIN32
+    _mkdir(m_cacheDirectory.c_str());
+#else
+    mkdir(m_cacheDirectory.c_str(), 0755);
+#endif
+    //entries always hold the whole map, so maps which
+    //were only partially loaded can't be written
+    if (!m_layerFilter && m_regionsOfInterest.empty())
+    {
+        writeCacheEntry(getProvider(), entryPath, *this);
+    }
+    return true;
+}
+
+bool Map::parseDocument(const pugi::xml_node& doc, const std::string& workingDir)
+{
     //make sure we have consistent path separators
     m_workingDirectory = workingDir;
     std::replace(m_workingDirectory.begin(), m_workingDirectory.end(), '\\', '/');
@@ -101,7 +445,6 @@ bool Map::loadFromString(const std::string& data, const std::string& workingDir)
     return parseMapNode(mapNode);
 }
 
-//private
 bool Map::parseMapNode(const pugi::xml_node& mapNode)
 {
     //parse map attributes
@@ -257,29 +600,58 @@ bool Map::parseMapNode(const pugi::xml_node& mapNode)
 
     //TODO do we need next object ID
 
+    //tilesets and layers are created in document order, but the
+    //expensive parts of parsing them may be run in parallel
+    TaskGroup tasks(m_executor);
+
+    //tasks hold pointers to the tilesets so make sure they never move
+    auto tilesetCount = std::distance(mapNode.children("tileset").begin(), mapNode.children("tileset").end());
+    m_tilesets.reserve(tilesetCount);
+
+    if (m_loadState)
+    {
+        m_loadState->totalLayers = countLayers(mapNode, {});
+        m_loadState->report();
+    }
+
     //parse all child nodes
     for (const auto& node : mapNode.children())
     {
+        if (isLoadCancelled())
+        {
+            break;
+        }
+
+        //layers rejected by the filter are skipped before anything is parsed
+        if (!acceptLayer(node, {}))
+        {
+            continue;
+        }
+
         std::string name = node.name();
         if (name == "tileset")
         {
             m_tilesets.emplace_back(m_workingDirectory);
-            m_tilesets.back().parse(node, this);
+            m_tilesets.back().setExecutor(m_executor);
+            auto* tileset = &m_tilesets.back();
+            tasks.run([this, tileset, node]() { tileset->parse(node, this); });
         }
         else if (name == "layer")
         {
             m_layers.emplace_back(std::make_unique<TileLayer>(m_tileCount.x * m_tileCount.y));
-            m_layers.back()->parse(node);
+            auto* layer = m_layers.back().get();
+            tasks.run([this, layer, node]() { parseLayer(*layer, node); });
         }
         else if (name == "objectgroup")
         {
             m_layers.emplace_back(std::make_unique<ObjectGroup>());
-            m_layers.back()->parse(node, this);
+            auto* layer = m_layers.back().get();
+            tasks.run([this, layer, node]() { parseLayer(*layer, node); });
         }
         else if (name == "imagelayer")
         {
             m_layers.emplace_back(std::make_unique<ImageLayer>(m_workingDirectory));
-            m_layers.back()->parse(node, this);
+            parseLayer(*m_layers.back(), node);
         }
         else if (name == "properties")
         {
@@ -293,26 +665,51 @@ bool Map::parseMapNode(const pugi::xml_node& mapNode)
         else if (name == "group")
         {
             m_layers.emplace_back(std::make_unique<LayerGroup>(m_workingDirectory, m_tileCount));
-            m_layers.back()->parse(node, this);
+            auto* layer = m_layers.back().get();
+            tasks.run([this, layer, node]() { parseLayer(*layer, node); });
         }
         else
         {
             LOG("Unidentified name " + name + ": node skipped", Logger::Type::Warning);
         }
     }
+
+    tasks.wait();
+
+    if (isLoadCancelled())
+    {
+        Logger::log("Map loading cancelled", Logger::Type::Info);
+        return reset();
+    }
+
+    finaliseLoad();
+    return true;
+}
+
+void Map::finaliseLoad()
+{
+    //dependencies are found in whichever order the tasks complete
+    std::sort(m_dependencies.begin(), m_dependencies.end());
+
     // fill animated tiles for easier lookup into map
+    //tile sets may be shared between maps, so frames are stored with
+    //their local ID and made global here using this map's first GID
+    m_animTiles.clear();
     for(const auto& ts : m_tilesets)
     {
         for(const auto& tile : ts.getTiles())
         {
             if (!tile.animation.frames.empty())
             {
-                m_animTiles[tile.ID + ts.getFirstGID()] = tile;
+                auto& animTile = m_animTiles[tile.ID + ts.getFirstGID()];
+                animTile = tile;
+                for (auto& frame : animTile.animation.frames)
+                {
+                    frame.tileID += ts.getFirstGID();
+                }
             }
         }
     }
-
-    return true;
 }
 
 bool Map::reset()
@@ -335,6 +732,141 @@ bool Map::reset()
     m_templateTilesets.clear();
 
     m_animTiles.clear();
+    m_dependencies.clear();
 
     return false;
 }
+
+void Map::setBytesParsed(std::size_t parsed, std::size_t total)
+{
+    if (m_loadState)
+    {
+        m_loadState->bytesParsed = parsed;
+        m_loadState->totalBytes = total;
+        m_loadState->report();
+    }
+}
+
+void Map::parseLayer(Layer& layer, const pugi::xml_node& node)
+{
+    if (!isLoadCancelled())
+    {
+        layer.parse(node, this);
+
+        if (m_loadState)
+        {
+            m_loadState->layersLoaded++;
+            m_loadState->report();
+        }
+    }
+}
+
+std::size_t Map::countLayers(const pugi::xml_node& node, const std::string& groupPath) const
+{
+    std::size_t count = 0;
+    for (const auto& child : node.children())
+    {
+        std::string name = child.name();
+        if (name == "layer" || name == "objectgroup" || name == "imagelayer")
+        {
+            count += acceptLayer(child, groupPath) ? 1 : 0;
+        }
+        else if (name == "group" && acceptLayer(child, groupPath))
+        {
+            count += 1 + countLayers(child, m_layerFilter ? getGroupPath(child) : std::string());
+        }
+    }
+    return count;
+}
+
+bool Map::acceptLayer(const pugi::xml_node& node, const std::string& groupPath) const
+{
+    if (!m_layerFilter)
+    {
+        return true;
+    }
+
+    LayerInfo info;
+    if (!getLayerType(node.name(), info.type))
+    {
+        return true;
+    }
+
+    info.name = node.attribute("name").as_string();
+    info.className = node.attribute("class").as_string();
+    info.groupPath = groupPath;
+    return m_layerFilter(info);
+}
+
+void Map::filterLayers(std::vector<Layer::Ptr>& layers, const std::string& groupPath) const
+{
+    if (!m_layerFilter)
+    {
+        return;
+    }
+
+    layers.erase(std::remove_if(layers.begin(), layers.end(),
+        [&](const Layer::Ptr& layer)
+        {
+            LayerInfo info;
+            info.name = layer->getName();
+            info.className = layer->getClass();
+            info.type = layer->getType();
+            info.groupPath = groupPath;
+            return !m_layerFilter(info);
+        }), layers.end());
+
+    for (auto& layer : layers)
+    {
+        if (layer->getType() == Layer::Type::Group)
+        {
+            const auto& name = layer->getName();
+            filterLayers(layer->getLayerAs<LayerGroup>().m_layers, groupPath.empty() ? name : groupPath + "/" + name);
+        }
+    }
+}
+
+std::string Map::getGroupPath(const pugi::xml_node& group)
+{
+    std::string path;
+    for (auto node = group; std::strcmp(node.name(), "group") == 0; node = node.parent())
+    {
+        std::string name = node.attribute("name").as_string();
+        path = path.empty() ? name : name + "/" + path;
+    }
+    return path;
+}
+
+bool Map::getLayerType(const std::string& nodeName, Layer::Type& type)
+{
+    if (nodeName == "layer")
+    {
+        type = Layer::Type::Tile;
+    }
+    else if (nodeName == "objectgroup")
+    {
+        type = Layer::Type::Object;
+    }
+    else if (nodeName == "imagelayer")
+    {
+        type = Layer::Type::Image;
+    }
+    else if (nodeName == "group")
+    {
+        type = Layer::Type::Group;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void Map::addDependency(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_loadMutex.mutex);
+    if (std::find(m_dependencies.begin(), m_dependencies.end(), path) == m_dependencies.end())
+    {
+        m_dependencies.push_back(path);
+    }
+}
@@ -0,0 +1,251 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#ifdef USE_EXTLIBS
+#include <pugixml.hpp>
+#else
+#include "detail/pugixml.hpp"
+#endif
+
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/MapInfo.hpp>
+#include <tmxlite/detail/Log.hpp>
+#include <tmxlite/detail/XmlStream.hpp>
+
+#include <fstream>
+#include <istream>
+#include <memory>
+
+using namespace tmx;
+
+MapInfo::MapInfo()
+    : m_assetProvider   (nullptr),
+    m_orientation       (Orientation::None),
+    m_renderOrder       (RenderOrder::None),
+    m_infinite          (false)
+{
+
+}
+
+//public
+bool MapInfo::probe(const std::string& path)
+{
+    if (m_assetProvider)
+    {
+        AssetBuffer buffer;
+        if (!m_assetProvider->open(path, buffer))
+        {
+            Logger::log("Failed to open file " + path, Logger::Type::Error);
+            return reset();
+        }
+
+        MemoryStream stream(buffer.data(), buffer.size());
+        return probe(stream, getFilePath(path));
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::log("Failed to open file " + path, Logger::Type::Error);
+        return reset();
+    }
+    return probe(file, getFilePath(path));
+}
+
+bool MapInfo::probe(std::istream& stream, const std::string& workingDir)
+{
+    reset();
+
+    XmlStream xml(stream);
+    if (xml.next() != XmlStream::Token::Start
+        || xml.name() != "map")
+    {
+        Logger::log("Failed opening map: no map node found", Logger::Type::Error);
+        return false;
+    }
+
+    //the map's attributes are parsed from its start
+    //tag in the same way as when reading a map
+    {
+        std::string tag = xml.tag();
+        pugi::xml_document doc;
+        auto result = doc.load_buffer_inplace(&tag[0], tag.size());
+        if (!result)
+        {
+            Logger::log("Failed opening map", Logger::Type::Error);
+            Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+            return false;
+        }
+
+        Map map;
+        if (!map.parseDocument(doc, workingDir))
+        {
+            return false;
+        }
+
+        m_version = map.getVersion();
+        m_orientation = map.getOrientation();
+        m_renderOrder = map.getRenderOrder();
+        m_tileCount = map.getTileCount();
+        m_tileSize = map.getTileSize();
+        m_infinite = map.isInfinite();
+        m_class = map.getClass();
+    }
+
+    if (xml.selfClosing())
+    {
+        return true;
+    }
+
+    //names of the groups which have been started but not yet ended
+    std::vector<std::string> groups;
+    while (true)
+    {
+        auto token = xml.next();
+        if (token == XmlStream::Token::End)
+        {
+            if (groups.empty())
+            {
+                //this is the end of the map node
+                return true;
+            }
+            groups.pop_back();
+            continue;
+        }
+
+        if (token != XmlStream::Token::Start)
+        {
+            if (token == XmlStream::Token::EndOfFile)
+            {
+                Logger::log("Unexpected end of map data", Logger::Type::Error);
+            }
+            return reset();
+        }
+
+        const auto name = xml.name();
+        Layer::Type type;
+        if (Map::getLayerType(name, type))
+        {
+            std::string tag = xml.tag();
+            pugi::xml_document doc;
+            if (!doc.load_buffer_inplace(&tag[0], tag.size()))
+            {
+                Logger::log("Failed parsing " + name + " element", Logger::Type::Error);
+                return reset();
+            }
+
+            auto node = doc.first_child();
+            m_layers.emplace_back();
+            auto& layer = m_layers.back();
+            layer.name = node.attribute("name").as_string();
+            layer.className = node.attribute("class").as_string();
+            layer.type = type;
+            for (const auto& group : groups)
+            {
+                layer.groupPath += (layer.groupPath.empty() ? "" : "/") + group;
+            }
+
+            //the contents of groups are read, whereas
+            //everything in any other layer is skipped
+            if (type == Layer::Type::Group)
+            {
+                if (!xml.selfClosing())
+                {
+                    groups.push_back(layer.name);
+                }
+                continue;
+            }
+        }
+        else if (name == "tileset" && groups.empty())
+        {
+            std::string tag = xml.tag();
+            pugi::xml_document doc;
+            if (!doc.load_buffer_inplace(&tag[0], tag.size()))
+            {
+                Logger::log("Failed parsing tileset element", Logger::Type::Error);
+                return reset();
+            }
+
+            auto node = doc.first_child();
+            m_tilesets.emplace_back();
+            auto& tileset = m_tilesets.back();
+            tileset.firstGID = node.attribute("firstgid").as_uint();
+
+            std::string source = node.attribute("source").as_string();
+            if (!source.empty())
+            {
+                tileset.source = resolveFilePath(source, workingDir);
+            }
+            else
+            {
+                tileset.name = node.attribute("name").as_string();
+            }
+        }
+        else if (name == "properties" && groups.empty())
+        {
+            char* data = nullptr;
+            std::size_t size = 0;
+            pugi::xml_document doc;
+            if (!xml.element(data, size)
+                || !doc.load_buffer_inplace(data, size))
+            {
+                Logger::log("Failed parsing map properties", Logger::Type::Error);
+                return reset();
+            }
+
+            for (const auto& child : doc.first_child().children())
+            {
+                m_properties.emplace_back();
+                m_properties.back().parse(child);
+            }
+            continue;
+        }
+
+        if (!xml.skip())
+        {
+            return reset();
+        }
+    }
+}
+
+//private
+bool MapInfo::reset()
+{
+    m_version = {};
+    m_orientation = Orientation::None;
+    m_renderOrder = RenderOrder::None;
+    m_tileCount = {};
+    m_tileSize = {};
+    m_infinite = false;
+    m_class.clear();
+    m_properties.clear();
+    m_layers.clear();
+    m_tilesets.clear();
+
+    return false;
+}
@@ -0,0 +1,321 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#ifdef USE_EXTLIBS
+#include <pugixml.hpp>
+#else
+#include "detail/pugixml.hpp"
+#endif
+
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/MapReader.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/Tileset.hpp>
+#include <tmxlite/detail/Log.hpp>
+#include <tmxlite/detail/XmlStream.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <memory>
+
+using namespace tmx;
+
+namespace
+{
+    enum class Result
+    {
+        Continue, Stop, Error
+    };
+
+    //parses the contents of the element last read from the stream,
+    //returning the root node of the element
+    pugi::xml_node parseElement(XmlStream& xml, pugi::xml_document& doc)
+    {
+        char* data = nullptr;
+        std::size_t size = 0;
+        if (!xml.element(data, size))
+        {
+            return {};
+        }
+
+        auto result = doc.load_buffer_inplace(data, size);
+        if (!result)
+        {
+            Logger::log("Failed parsing " + xml.name() + " element: " + std::string(result.description()), Logger::Type::Error);
+            return {};
+        }
+        return doc.first_child();
+    }
+
+    //parses the attributes of the start tag last read from the stream
+    pugi::xml_node parseTag(XmlStream& xml, std::string& tag, pugi::xml_document& doc)
+    {
+        tag = xml.tag();
+        auto result = doc.load_buffer_inplace(&tag[0], tag.size());
+        if (!result)
+        {
+            Logger::log("Failed parsing " + xml.name() + " element: " + std::string(result.description()), Logger::Type::Error);
+            return {};
+        }
+        return doc.first_child();
+    }
+
+    Result readTileLayer(const pugi::xml_node& node, Map& map, MapReader::Handler& handler)
+    {
+        TileLayer layer(map.getTileCount().x * map.getTileCount().y);
+        layer.parse(node, &map);
+
+        if (!handler.onLayerBegin(layer))
+        {
+            return Result::Stop;
+        }
+
+        const auto& tiles = layer.getTiles();
+        const std::size_t width = layer.getSize().x;
+        if (width != 0)
+        {
+            //the last row may be short if the layer data was incomplete
+            for (std::size_t start = 0; start < tiles.size(); start += width)
+            {
+                const auto row = static_cast<std::uint32_t>(start / width);
+                if (!handler.onTileRow(layer, row, &tiles[start], std::min(width, tiles.size() - start)))
+                {
+                    return Result::Stop;
+                }
+            }
+        }
+
+        for (const auto& chunk : layer.getChunks())
+        {
+            if (!handler.onChunk(layer, chunk))
+            {
+                return Result::Stop;
+            }
+        }
+
+        return handler.onLayerEnd(layer) ? Result::Continue : Result::Stop;
+    }
+
+    //reads child elements until the end tag of the current element is found
+    Result readChildren(XmlStream& xml, Map& map, MapReader::Handler& handler)
+    {
+        while (true)
+        {
+            auto token = xml.next();
+            if (token == XmlStream::Token::End)
+            {
+                return Result::Continue;
+            }
+
+            if (token != XmlStream::Token::Start)
+            {
+                if (token == XmlStream::Token::EndOfFile)
+                {
+                    Logger::log("Unexpected end of map data", Logger::Type::Error);
+                }
+                return Result::Error;
+            }
+
+            pugi::xml_document doc;
+            const auto name = xml.name();
+
+            //groups may contain any amount of data, so only the
+            //start tag is parsed and the contents are streamed
+            if (name == "group" || name == "objectgroup")
+            {
+                std::string tag;
+                auto node = parseTag(xml, tag, doc);
+                if (!node)
+                {
+                    return Result::Error;
+                }
+
+                std::unique_ptr<Layer> layer;
+                if (name == "group")
+                {
+                    layer = std::make_unique<LayerGroup>(map.getWorkingDirectory(), map.getTileCount());
+                }
+                else
+                {
+                    layer = std::make_unique<ObjectGroup>();
+                }
+                layer->parse(node, &map);
+
+                if (!handler.onLayerBegin(*layer))
+                {
+                    return Result::Stop;
+                }
+
+                if (!xml.selfClosing())
+                {
+                    auto result = readChildren(xml, map, handler);
+                    if (result != Result::Continue)
+                    {
+                        return result;
+                    }
+                }
+
+                if (!handler.onLayerEnd(*layer))
+                {
+                    return Result::Stop;
+                }
+                continue;
+            }
+
+            auto node = parseElement(xml, doc);
+            if (!node)
+            {
+                return Result::Error;
+            }
+
+            if (name == "tileset")
+            {
+                Tileset tileset(map.getWorkingDirectory());
+                if (tileset.parse(node, &map)
+                    && !handler.onTileset(tileset))
+                {
+                    return Result::Stop;
+                }
+            }
+            else if (name == "layer")
+            {
+                auto result = readTileLayer(node, map, handler);
+                if (result != Result::Continue)
+                {
+                    return result;
+                }
+            }
+            else if (name == "imagelayer")
+            {
+                ImageLayer layer(map.getWorkingDirectory());
+                layer.parse(node, &map);
+                if (!handler.onLayerBegin(layer)
+                    || !handler.onLayerEnd(layer))
+                {
+                    return Result::Stop;
+                }
+            }
+            else if (name == "object")
+            {
+                Object object;
+                object.parse(node, &map);
+                if (!handler.onObject(object))
+                {
+                    return Result::Stop;
+                }
+            }
+            else if (name == "properties")
+            {
+                std::vector<Property> properties;
+                for (const auto& child : node.children())
+                {
+                    properties.emplace_back();
+                    properties.back().parse(child);
+                }
+
+                if (!handler.onProperties(properties))
+                {
+                    return Result::Stop;
+                }
+            }
+            else
+            {
+                LOG("Unidentified name " + name + ": node skipped", Logger::Type::Warning);
+            }
+        }
+    }
+}
+
+bool MapReader::read(const std::string& path, Handler& handler)
+{
+    if (m_assetProvider)
+    {
+        AssetBuffer buffer;
+        if (!m_assetProvider->open(path, buffer))
+        {
+            Logger::log("Failed to open file " + path, Logger::Type::Error);
+            return false;
+        }
+
+        MemoryStream stream(buffer.data(), buffer.size());
+        return read(stream, getFilePath(path), handler);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        Logger::log("Failed to open file " + path, Logger::Type::Error);
+        return false;
+    }
+    return read(file, getFilePath(path), handler);
+}
+
+bool MapReader::read(std::istream& stream, const std::string& workingDir, Handler& handler)
+{
+    XmlStream xml(stream);
+    auto token = xml.next();
+    if (token != XmlStream::Token::Start
+        || xml.name() != "map")
+    {
+        Logger::log("Failed opening map: no map node found", Logger::Type::Error);
+        return false;
+    }
+
+    //the map holds the header, and provides the working
+    //directory and template caches used by the contents
+    Map map;
+    map.setAssetProvider(m_assetProvider);
+    {
+        std::string tag = xml.tag();
+        pugi::xml_document doc;
+        auto result = doc.load_buffer_inplace(&tag[0], tag.size());
+        if (!result)
+        {
+            Logger::log("Failed opening map", Logger::Type::Error);
+            Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+            return false;
+        }
+
+        if (!map.parseDocument(doc, workingDir))
+        {
+            return false;
+        }
+    }
+
+    if (!handler.onMap(map)
+        || xml.selfClosing())
+    {
+        return true;
+    }
+
+    return readChildren(xml, map, handler) != Result::Error;
+}
@@ -0,0 +1,1358 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+
+#ifdef USE_EXTLIBS
+#include <zstd.h>
+#include <zlib.h>
+#else
+#include "miniz.h"
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/ImageLayer.hpp>
+#include <tmxlite/LayerGroup.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/ObjectGroup.hpp>
+#include <tmxlite/TileLayer.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+using namespace tmx;
+
+namespace
+{
+    //version of the tmx format written, which uses class attributes
+    const char* const FormatVersion = "1.10";
+
+    std::string colourString(const Colour& colour, bool withAlpha = false)
+    {
+        static const char digits[] = "0123456789abcdef";
+
+        std::string str("#");
+        auto append = [&str](std::uint8_t value)
+        {
+            str += digits[value >> 4];
+            str += digits[value & 0xf];
+        };
+
+        if (withAlpha || colour.a != 255)
+        {
+            append(colour.a);
+        }
+        append(colour.r);
+        append(colour.g);
+        append(colour.b);
+        return str;
+    }
+
+    //the inverse of resolveFilePath(), so that saved files refer
+    //to their resources relative to their own directory
+    std::string relativeFilePath(const std::string& path, const std::string& workingDir)
+    {
+        if (path.empty())
+        {
+            return path;
+        }
+
+        auto target = resolveFilePath(path, "");
+        auto base = resolveFilePath(".", workingDir);
+
+        std::string targetPrefix;
+        std::string basePrefix;
+        if (isAbsoluteFilePath(target, &targetPrefix) != isAbsoluteFilePath(base, &basePrefix)
+            || targetPrefix != basePrefix)
+        {
+            return target;
+        }
+
+        std::vector<std::string> targetParts;
+        std::vector<std::string> baseParts;
+        splitStringInto(target.substr(targetPrefix.size()), '/', &targetParts);
+        splitStringInto(base.substr(basePrefix.size()), '/', &baseParts);
+
+        std::size_t common = 0;
+        while (common < targetParts.size() - 1 && common < baseParts.size()
+            && targetParts[common] == baseParts[common])
+        {
+            ++common;
+        }
+
+        std::vector<std::string> parts;
+        for (auto i = common; i < baseParts.size(); ++i)
+        {
+            //the name of the directory above the working directory isn't known
+            if (baseParts[i] == "..")
+            {
+                return target;
+            }
+            parts.emplace_back("..");
+        }
+        parts.insert(parts.end(), targetParts.begin() + common, targetParts.end());
+
+        std::string result;
+        joinStringInto(parts, '/', &result);
+        return result;
+    }
+
+    //writes the shortest text which reads back as the same value
+    const char* formatFloat(char (&buffer)[32], float value)
+    {
+        for (auto precision = 6; precision < 10; ++precision)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            if (std::strtof(buffer, nullptr) == value)
+            {
+                break;
+            }
+        }
+        return buffer;
+    }
+
+    char* writeUInt(char* dest, std::uint32_t value)
+    {
+        char digits[10];
+        auto count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        while (count != 0)
+        {
+            *dest++ = digits[--count];
+        }
+        return dest;
+    }
+
+    bool compressTiles(std::vector<unsigned char>& data, SaveSettings::Encoding encoding, int level)
+    {
+        std::vector<unsigned char> compressed;
+        if (encoding == SaveSettings::Encoding::Base64Zlib)
+        {
+            uLongf size = compressBound(static_cast<uLong>(data.size()));
+            compressed.resize(size);
+            if (compress2(compressed.data(), &size, data.data(), static_cast<uLong>(data.size()),
+                level == 0 ? Z_DEFAULT_COMPRESSION : level) != Z_OK)
+            {
+                Logger::log("Failed to compress tile data", Logger::Type::Error);
+                return false;
+            }
+            compressed.resize(size);
+        }
+        else
+        {
+#if defined USE_ZSTD || defined USE_EXTLIBS
+            compressed.resize(ZSTD_compressBound(data.size()));
+            auto size = ZSTD_compress(compressed.data(), compressed.size(), data.data(), data.size(), level);
+            if (ZSTD_isError(size))
+            {
+                Logger::log("Failed to compress tile data: " + std::string(ZSTD_getErrorName(size)), Logger::Type::Error);
+                return false;
+            }
+            compressed.resize(size);
+#else
+            return false;
+#endif
+        }
+
+        data.swap(compressed);
+        return true;
+    }
+
+    //writes either the CSV or base64 text of the given tiles
+    bool encodeTiles(const std::vector<TileLayer::Tile>& tiles, std::size_t width, const SaveSettings& settings, std::string& destination)
+    {
+        destination.clear();
+        if (tiles.empty())
+        {
+            return true;
+        }
+
+        if (settings.encoding == SaveSettings::Encoding::CSV)
+        {
+            if (width == 0)
+            {
+                width = tiles.size();
+            }
+
+            //at most 10 digits, a separator and a line break for each tile
+            destination.resize(tiles.size() * 12);
+            auto* dest = &destination[0];
+            for (auto i = 0u; i < tiles.size(); ++i)
+            {
+                dest = writeUInt(dest, tiles[i].getGID());
+                if (i + 1 < tiles.size())
+                {
+                    *dest++ = ',';
+                    if ((i + 1) % width == 0)
+                    {
+                        *dest++ = '\n';
+                    }
+                }
+            }
+            destination.resize(static_cast<std::size_t>(dest - destination.data()));
+            return true;
+        }
+
+        std::vector<unsigned char> data(tiles.size() * 4);
+        auto* dest = data.data();
+        for (const auto& tile : tiles)
+        {
+            auto gid = tile.getGID();
+            dest[0] = static_cast<unsigned char>(gid);
+            dest[1] = static_cast<unsigned char>(gid >> 8);
+            dest[2] = static_cast<unsigned char>(gid >> 16);
+            dest[3] = static_cast<unsigned char>(gid >> 24);
+            dest += 4;
+        }
+
+        if (settings.encoding != SaveSettings::Encoding::Base64
+            && !compressTiles(data, settings.encoding, settings.compressionLevel))
+        {
+            return false;
+        }
+
+        destination.resize(((data.size() + 2) / 3) * 4);
+        base64_encode(data.data(), data.size(), &destination[0]);
+        return true;
+    }
+
+    bool writeFile(const std::string& path, const std::string& data)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            Logger::log("Failed to open " + path + " for writing", Logger::Type::Error);
+            return false;
+        }
+
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (file.fail())
+        {
+            Logger::log("Failed to write " + path, Logger::Type::Error);
+            return false;
+        }
+        return true;
+    }
+
+    //appends an XML document to a string, indenting elements in the
+    //same way as Tiled. Attributes must be written before any children
+    class XmlWriter final
+    {
+    public:
+        explicit XmlWriter(std::string& destination)
+            : m_destination(destination), m_tagOpen(false), m_hasText(false)
+        {
+            m_destination += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        }
+
+        std::size_t depth() const { return m_elements.size(); }
+
+        void open(const char* name)
+        {
+            if (m_tagOpen)
+            {
+                m_destination += ">\n";
+            }
+            m_destination.append(m_elements.size(), ' ');
+            m_destination += '<';
+            m_destination += name;
+
+            m_elements.push_back(name);
+            m_tagOpen = true;
+            m_hasText = false;
+        }
+
+        void close()
+        {
+            if (m_tagOpen)
+            {
+                m_destination += "/>\n";
+            }
+            else
+            {
+                if (!m_hasText)
+                {
+                    m_destination.append(m_elements.size() - 1, ' ');
+                }
+                m_destination += "</";
+                m_destination += m_elements.back();
+                m_destination += ">\n";
+            }
+
+            m_elements.pop_back();
+            m_tagOpen = false;
+            m_hasText = false;
+        }
+
+        void attribute(const char* name, const char* value, std::size_t length)
+        {
+            m_destination += ' ';
+            m_destination += name;
+            m_destination += "=\"";
+            escape(value, length, true);
+            m_destination += '"';
+        }
+
+        void attribute(const char* name, const std::string& value) { attribute(name, value.data(), value.size()); }
+        void attribute(const char* name, const char* value) { attribute(name, value, std::strlen(value)); }
+        void attribute(const char* name, int value) { attribute(name, std::to_string(value)); }
+        void attribute(const char* name, unsigned value) { attribute(name, std::to_string(value)); }
+
+        void attribute(const char* name, float value)
+        {
+            char buffer[32];
+            attribute(name, formatFloat(buffer, value));
+        }
+
+        //escaped text content of the current element
+        void text(const std::string& value)
+        {
+            beginContent();
+            escape(value.data(), value.size(), false);
+        }
+
+        //content which is known not to need escaping, such as tile data
+        void data(const char* value, std::size_t length)
+        {
+            beginContent();
+            m_destination.append(value, length);
+        }
+
+        void data(const std::string& value) { data(value.data(), value.size()); }
+
+        void lineBreak(std::size_t indent)
+        {
+            beginContent();
+            m_destination += '\n';
+            m_destination.append(indent, ' ');
+        }
+
+    private:
+        std::string& m_destination;
+        std::vector<const char*> m_elements;
+        bool m_tagOpen;
+        bool m_hasText;
+
+        void beginContent()
+        {
+            if (m_tagOpen)
+            {
+                m_destination += '>';
+                m_tagOpen = false;
+            }
+            m_hasText = true;
+        }
+
+        void escape(const char* value, std::size_t length, bool inAttribute)
+        {
+            const auto* start = value;
+            const auto* end = value + length;
+            for (const auto* c = value; c != end; ++c)
+            {
+                const char* replacement = nullptr;
+                switch (*c)
+                {
+                default: break;
+                case '&': replacement = "&amp;"; break;
+                case '<': replacement = "&lt;"; break;
+                case '>': replacement = "&gt;"; break;
+                case '\r': replacement = "&#13;"; break;
+                case '"': replacement = inAttribute ? "&quot;" : nullptr; break;
+                case '\n': replacement = inAttribute ? "&#10;" : nullptr; break;
+                case '\t': replacement = inAttribute ? "&#9;" : nullptr; break;
+                }
+
+                if (replacement)
+                {
+                    m_destination.append(start, c);
+                    m_destination += replacement;
+                    start = c + 1;
+                }
+            }
+            m_destination.append(start, end);
+        }
+    };
+
+    void collectTileLayers(const std::vector<Layer::Ptr>& layers, std::vector<const TileLayer*>& tileLayers)
+    {
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Tile)
+            {
+                tileLayers.push_back(&layer->getLayerAs<TileLayer>());
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                collectTileLayers(layer->getLayerAs<LayerGroup>().getLayers(), tileLayers);
+            }
+        }
+    }
+
+    std::uint32_t countLayers(const std::vector<Layer::Ptr>& layers)
+    {
+        std::uint32_t count = 0;
+        for (const auto& layer : layers)
+        {
+            ++count;
+            if (layer->getType() == Layer::Type::Group)
+            {
+                count += countLayers(layer->getLayerAs<LayerGroup>().getLayers());
+            }
+        }
+        return count;
+    }
+
+    std::uint32_t maxObjectID(const std::vector<Layer::Ptr>& layers)
+    {
+        std::uint32_t ID = 0;
+        for (const auto& layer : layers)
+        {
+            if (layer->getType() == Layer::Type::Object)
+            {
+                for (const auto& object : layer->getLayerAs<ObjectGroup>().getObjects())
+                {
+                    ID = std::max(ID, object.getUID());
+                }
+            }
+            else if (layer->getType() == Layer::Type::Group)
+            {
+                ID = std::max(ID, maxObjectID(layer->getLayerAs<LayerGroup>().getLayers()));
+            }
+        }
+        return ID;
+    }
+
+    std::uint32_t nextFirstGID(const Tileset& tileset)
+    {
+        return tileset.getTiles().empty() ? tileset.getFirstGID() : tileset.getLastGID() + 1;
+    }
+}
+
+namespace tmx
+{
+    //writes maps and tile sets as tmx documents. The tile data of every
+    //layer is encoded up front, in parallel, so that writing the document
+    //itself is only a matter of appending text
+    class MapWriter final
+    {
+    public:
+        MapWriter(std::string& destination, const std::string& workingDir)
+            : m_xml(destination),
+            m_destination(destination),
+            m_workingDir(workingDir),
+            m_map(nullptr),
+            m_infinite(false),
+            m_nextLayerID(1),
+            m_nextEncoded(0)
+        {
+
+        }
+
+        bool writeMap(const Map& map, const SaveSettings& settings)
+        {
+    #if !defined USE_ZSTD && !defined USE_EXTLIBS
+            if (settings.encoding == SaveSettings::Encoding::Base64Zstd)
+            {
+                Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
+                return false;
+            }
+    #endif
+
+            m_map = &map;
+            m_infinite = map.isInfinite();
+            m_encoding = settings.encoding;
+            if (!encodeLayers(map, settings))
+            {
+                return false;
+            }
+            addTemplateTilesets(map);
+
+            m_xml.open("map");
+            m_xml.attribute("version", FormatVersion);
+            if (!map.getClass().empty())
+            {
+                m_xml.attribute("class", map.getClass());
+            }
+
+            switch (map.getOrientation())
+            {
+            default:
+            case Orientation::Orthogonal:
+                m_xml.attribute("orientation", "orthogonal");
+                break;
+            case Orientation::Isometric:
+                m_xml.attribute("orientation", "isometric");
+                break;
+            case Orientation::Staggered:
+                m_xml.attribute("orientation", "staggered");
+                break;
+            case Orientation::Hexagonal:
+                m_xml.attribute("orientation", "hexagonal");
+                break;
+            }
+
+            switch (map.getRenderOrder())
+            {
+            default: break;
+            case RenderOrder::RightDown:
+                m_xml.attribute("renderorder", "right-down");
+                break;
+            case RenderOrder::RightUp:
+                m_xml.attribute("renderorder", "right-up");
+                break;
+            case RenderOrder::LeftDown:
+                m_xml.attribute("renderorder", "left-down");
+                break;
+            case RenderOrder::LeftUp:
+                m_xml.attribute("renderorder", "left-up");
+                break;
+            }
+
+            m_xml.attribute("width", map.getTileCount().x);
+            m_xml.attribute("height", map.getTileCount().y);
+            m_xml.attribute("tilewidth", map.getTileSize().x);
+            m_xml.attribute("tileheight", map.getTileSize().y);
+            if (map.getOrientation() == Orientation::Hexagonal)
+            {
+                m_xml.attribute("hexsidelength", map.getHexSideLength());
+            }
+            if (map.getStaggerAxis() != StaggerAxis::None)
+            {
+                m_xml.attribute("staggeraxis", map.getStaggerAxis() == StaggerAxis::X ? "x" : "y");
+            }
+            if (map.getStaggerIndex() != StaggerIndex::None)
+            {
+                m_xml.attribute("staggerindex", map.getStaggerIndex() == StaggerIndex::Odd ? "odd" : "even");
+            }
+            if (map.getParallaxOrigin().x != 0 || map.getParallaxOrigin().y != 0)
+            {
+                m_xml.attribute("parallaxoriginx", map.getParallaxOrigin().x);
+                m_xml.attribute("parallaxoriginy", map.getParallaxOrigin().y);
+            }
+            if (map.getBackgroundColour() != Colour())
+            {
+                m_xml.attribute("backgroundcolor", colourString(map.getBackgroundColour()));
+            }
+            m_xml.attribute("infinite", m_infinite ? "1" : "0");
+            m_xml.attribute("nextlayerid", countLayers(map.getLayers()) + 1);
+            m_xml.attribute("nextobjectid", maxObjectID(map.getLayers()) + 1);
+
+            writeProperties(map.getProperties());
+
+            for (const auto& tileset : map.getTilesets())
+            {
+                writeMapTileset(tileset, tileset.getFirstGID());
+            }
+            for (const auto& tileset : m_templateTilesets)
+            {
+                writeMapTileset(*tileset.second, tileset.first);
+            }
+
+            writeLayers(map.getLayers());
+            m_xml.close();
+            return true;
+        }
+
+        void writeTileset(const Tileset& tileset, std::uint32_t firstGID)
+        {
+            m_xml.open("tileset");
+            if (firstGID != 0)
+            {
+                m_xml.attribute("firstgid", firstGID);
+            }
+            else
+            {
+                m_xml.attribute("version", FormatVersion);
+            }
+            m_xml.attribute("name", tileset.getName());
+            if (!tileset.getClass().empty())
+            {
+                m_xml.attribute("class", tileset.getClass());
+            }
+            m_xml.attribute("tilewidth", tileset.getTileSize().x);
+            m_xml.attribute("tileheight", tileset.getTileSize().y);
+            if (tileset.getSpacing() != 0)
+            {
+                m_xml.attribute("spacing", tileset.getSpacing());
+            }
+            if (tileset.getMargin() != 0)
+            {
+                m_xml.attribute("margin", tileset.getMargin());
+            }
+            m_xml.attribute("tilecount", tileset.getTileCount());
+            m_xml.attribute("columns", tileset.getColumnCount());
+
+            static const char* const alignments[] =
+            {
+                "unspecified", "topleft", "top", "topright", "left",
+                "center", "right", "bottomleft", "bottom", "bottomright"
+            };
+            if (tileset.getObjectAlignment() != Tileset::ObjectAlignment::Unspecified)
+            {
+                m_xml.attribute("objectalignment", alignments[static_cast<std::size_t>(tileset.getObjectAlignment())]);
+            }
+
+            if (tileset.getTileOffset().x != 0 || tileset.getTileOffset().y != 0)
+            {
+                m_xml.open("tileoffset");
+                m_xml.attribute("x", static_cast<int>(tileset.getTileOffset().x));
+                m_xml.attribute("y", static_cast<int>(tileset.getTileOffset().y));
+                m_xml.close();
+            }
+
+            writeProperties(tileset.getProperties());
+
+            const bool hasImage = !tileset.getImagePath().empty();
+            if (hasImage)
+            {
+                writeImage(tileset.getImagePath(), tileset.getImageSize(), tileset.hasTransparency(), tileset.getTransparencyColour());
+            }
+
+            if (!tileset.getTerrainTypes().empty())
+            {
+                m_xml.open("terraintypes");
+                for (const auto& terrain : tileset.getTerrainTypes())
+                {
+                    m_xml.open("terrain");
+                    m_xml.attribute("name", terrain.name);
+                    m_xml.attribute("tile", static_cast<int>(terrain.tileID));
+                    writeProperties(terrain.properties);
+                    m_xml.close();
+                }
+                m_xml.close();
+            }
+
+            //tiles are stored in the order they were found, which
+            //is not necessarily the order of their IDs
+            std::vector<const Tileset::Tile*> tiles;
+            for (const auto& tile : tileset.getTiles())
+            {
+                if (hasTileData(tileset, tile))
+                {
+                    tiles.push_back(&tile);
+                }
+            }
+            std::sort(tiles.begin(), tiles.end(), [](const Tileset::Tile* a, const Tileset::Tile* b) { return a->ID < b->ID; });
+
+            for (const auto* tile : tiles)
+            {
+                writeTile(tileset, *tile, hasImage);
+            }
+
+            m_xml.close();
+        }
+
+    private:
+        struct EncodedLayer final
+        {
+            //one entry for each chunk of an infinite map
+            std::vector<std::string> data;
+            //position and size of each chunk
+            std::vector<std::pair<Vector2i, Vector2i>> chunks;
+            bool failed = false;
+        };
+
+        XmlWriter m_xml;
+        std::string& m_destination;
+        std::string m_workingDir;
+        const Map* m_map;
+        bool m_infinite;
+        SaveSettings::Encoding m_encoding = SaveSettings::Encoding::CSV;
+
+        std::vector<EncodedLayer> m_encodedLayers;
+        std::uint32_t m_nextLayerID;
+        std::size_t m_nextEncoded;
+
+        //tile sets used only by templates, with the first GID they are given
+        std::vector<std::pair<std::uint32_t, const Tileset*>> m_templateTilesets;
+        //added to the tile IDs of objects created from each template tile set
+        std::unordered_map<std::string, std::int64_t> m_templateGIDOffsets;
+
+        bool encodeLayers(const Map& map, const SaveSettings& settings)
+        {
+            std::vector<const TileLayer*> tileLayers;
+            collectTileLayers(map.getLayers(), tileLayers);
+            m_encodedLayers.resize(tileLayers.size());
+
+            const auto width = map.getTileCount().x;
+            const bool infinite = m_infinite;
+            TaskGroup tasks(map.getExecutor());
+            for (auto i = 0u; i < tileLayers.size(); ++i)
+            {
+                const auto* layer = tileLayers[i];
+                auto* encoded = &m_encodedLayers[i];
+                tasks.run([layer, encoded, width, infinite, &settings]()
+                {
+                    if (infinite)
+                    {
+                        //every chunk is written, including any not yet loaded
+                        const auto& chunks = layer->getChunks();
+                        std::vector<TileLayer::Chunk> pendingChunks;
+                        layer->decodePendingChunks(pendingChunks, nullptr);
+
+                        encoded->data.resize(chunks.size() + pendingChunks.size());
+                        for (auto j = 0u; j < encoded->data.size() && !encoded->failed; ++j)
+                        {
+                            const auto& chunk = j < chunks.size() ? chunks[j] : pendingChunks[j - chunks.size()];
+                            encoded->chunks.emplace_back(chunk.position, chunk.size);
+                            encoded->failed = !encodeTiles(chunk.tiles, chunk.size.x, settings, encoded->data[j]);
+                        }
+                    }
+                    else
+                    {
+                        encoded->data.resize(1);
+                        encoded->failed = !encodeTiles(layer->getTiles(), width, settings, encoded->data[0]);
+                    }
+                });
+            }
+            tasks.wait();
+
+            std::size_t size = 0;
+            for (const auto& layer : m_encodedLayers)
+            {
+                if (layer.failed)
+                {
+                    return false;
+                }
+
+                for (const auto& data : layer.data)
+                {
+                    size += data.size();
+                }
+            }
+
+            //tile data is usually most of the document
+            m_destination.reserve(m_destination.size() + size + size / 16 + 4096);
+            return true;
+        }
+
+        //tiles of objects created from templates are numbered from the first GID
+        //of the template's own tile set, which is added to the map if not already used
+        void addTemplateTilesets(const Map& map)
+        {
+            std::vector<const std::pair<const std::string, Tileset>*> templateTilesets;
+            for (const auto& pair : map.getTemplateTilesets())
+            {
+                templateTilesets.push_back(&pair);
+            }
+            std::sort(templateTilesets.begin(), templateTilesets.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+            std::uint32_t nextGID = 1;
+            for (const auto& tileset : map.getTilesets())
+            {
+                nextGID = std::max(nextGID, nextFirstGID(tileset));
+            }
+
+            for (const auto* pair : templateTilesets)
+            {
+                const auto& tileset = pair->second;
+                const auto& source = tileset.getSource();
+                auto existing = std::find_if(map.getTilesets().begin(), map.getTilesets().end(),
+                    [&source](const Tileset& ts) { return !source.empty() && ts.getSource() == source; });
+
+                std::uint32_t firstGID = 0;
+                if (existing != map.getTilesets().end())
+                {
+                    firstGID = existing->getFirstGID();
+                }
+                else
+                {
+                    firstGID = nextGID;
+                    nextGID += nextFirstGID(tileset) - tileset.getFirstGID();
+                    m_templateTilesets.emplace_back(firstGID, &tileset);
+                }
+                m_templateGIDOffsets[pair->first] = static_cast<std::int64_t>(firstGID) - tileset.getFirstGID();
+            }
+        }
+
+        void writeMapTileset(const Tileset& tileset, std::uint32_t firstGID)
+        {
+            if (tileset.getSource().empty())
+            {
+                writeTileset(tileset, firstGID);
+            }
+            else
+            {
+                m_xml.open("tileset");
+                m_xml.attribute("firstgid", firstGID);
+                m_xml.attribute("source", relativeFilePath(tileset.getSource(), m_workingDir));
+                m_xml.close();
+            }
+        }
+
+        static bool hasTileData(const Tileset& tileset, const Tileset::Tile& tile)
+        {
+            return !tile.properties.empty()
+                || !tile.animation.frames.empty()
+                || !tile.objectGroup.getObjects().empty()
+                || !tile.className.empty()
+                || tile.probability != 100
+                || hasTerrain(tileset, tile)
+                || tile.imagePath != tileset.getImagePath();
+        }
+
+        static bool hasTerrain(const Tileset& tileset, const Tileset::Tile& tile)
+        {
+            return !tileset.getTerrainTypes().empty()
+                && std::any_of(tile.terrainIndices.begin(), tile.terrainIndices.end(), [](std::int32_t i) { return i != 0; });
+        }
+
+        void writeTile(const Tileset& tileset, const Tileset::Tile& tile, bool tilesetHasImage)
+        {
+            m_xml.open("tile");
+            m_xml.attribute("id", tile.ID);
+            if (!tile.className.empty())
+            {
+                m_xml.attribute("class", tile.className);
+            }
+            if (tile.probability != 100)
+            {
+                m_xml.attribute("probability", tile.probability);
+            }
+            if (hasTerrain(tileset, tile))
+            {
+                std::string terrain;
+                for (auto i = 0u; i < tile.terrainIndices.size(); ++i)
+                {
+                    if (i != 0)
+                    {
+                        terrain += ',';
+                    }
+                    if (tile.terrainIndices[i] >= 0)
+                    {
+                        terrain += std::to_string(tile.terrainIndices[i]);
+                    }
+                }
+                m_xml.attribute("terrain", terrain);
+            }
+
+            writeProperties(tile.properties);
+
+            if (!tilesetHasImage || tile.imagePath != tileset.getImagePath())
+            {
+                writeImage(tile.imagePath, tile.imageSize, !tilesetHasImage && tileset.hasTransparency(), tileset.getTransparencyColour());
+            }
+
+            if (!tile.objectGroup.getObjects().empty())
+            {
+                m_xml.open("objectgroup");
+                if (tile.objectGroup.getDrawOrder() == ObjectGroup::DrawOrder::Index)
+                {
+                    m_xml.attribute("draworder", "index");
+                }
+                writeObjects(tile.objectGroup.getObjects());
+                m_xml.close();
+            }
+
+            if (!tile.animation.frames.empty())
+            {
+                m_xml.open("animation");
+                for (const auto& frame : tile.animation.frames)
+                {
+                    m_xml.open("frame");
+                    m_xml.attribute("tileid", frame.tileID);
+                    m_xml.attribute("duration", frame.duration);
+                    m_xml.close();
+                }
+                m_xml.close();
+            }
+
+            m_xml.close();
+        }
+
+        void writeImage(const std::string& path, const Vector2u& size, bool hasTransparency, const Colour& transparency)
+        {
+            m_xml.open("image");
+            m_xml.attribute("source", relativeFilePath(path, m_workingDir));
+            if (hasTransparency)
+            {
+                auto colour = transparency;
+                colour.a = 255;
+                m_xml.attribute("trans", colourString(colour).substr(1));
+            }
+            if (size.x != 0 && size.y != 0)
+            {
+                m_xml.attribute("width", size.x);
+                m_xml.attribute("height", size.y);
+            }
+            m_xml.close();
+        }
+
+        void writeProperties(const std::vector<Property>& properties)
+        {
+            if (properties.empty())
+            {
+                return;
+            }
+
+            m_xml.open("properties");
+            for (const auto& property : properties)
+            {
+                writeProperty(property);
+            }
+            m_xml.close();
+        }
+
+        void writeProperty(const Property& property)
+        {
+            if (property.getType() == Property::Type::Undef)
+            {
+                return;
+            }
+
+            m_xml.open("property");
+            m_xml.attribute("name", property.getName());
+
+            switch (property.getType())
+            {
+            default: break;
+            case Property::Type::Boolean:
+                m_xml.attribute("type", "bool");
+                m_xml.attribute("value", property.getBoolValue() ? "true" : "false");
+                break;
+            case Property::Type::Float:
+                m_xml.attribute("type", "float");
+                m_xml.attribute("value", property.getFloatValue());
+                break;
+            case Property::Type::Int:
+                m_xml.attribute("type", "int");
+                m_xml.attribute("value", property.getIntValue());
+                break;
+            case Property::Type::String:
+                //multiline strings are stored as text, as Tiled does
+                if (property.getStringValue().find('\n') == std::string::npos)
+                {
+                    m_xml.attribute("value", property.getStringValue());
+                }
+                else
+                {
+                    m_xml.text(property.getStringValue());
+                }
+                break;
+            case Property::Type::Colour:
+                m_xml.attribute("type", "color");
+                m_xml.attribute("value", colourString(property.getColourValue(), true));
+                break;
+            case Property::Type::File:
+                m_xml.attribute("type", "file");
+                m_xml.attribute("value", property.getFileValue());
+                break;
+            case Property::Type::Object:
+                m_xml.attribute("type", "object");
+                m_xml.attribute("value", property.getObjectValue());
+                break;
+            case Property::Type::Class:
+                m_xml.attribute("type", "class");
+                m_xml.attribute("propertytype", property.getPropertyType());
+                writeProperties(property.getClassValue());
+                break;
+            }
+
+            m_xml.close();
+        }
+
+        void writeLayers(const std::vector<Layer::Ptr>& layers)
+        {
+            for (const auto& layer : layers)
+            {
+                switch (layer->getType())
+                {
+                case Layer::Type::Tile:
+                    writeTileLayer(layer->getLayerAs<TileLayer>());
+                    break;
+                case Layer::Type::Object:
+                    writeObjectGroup(layer->getLayerAs<ObjectGroup>());
+                    break;
+                case Layer::Type::Image:
+                    writeImageLayer(layer->getLayerAs<ImageLayer>());
+                    break;
+                case Layer::Type::Group:
+                {
+                    const auto& group = layer->getLayerAs<LayerGroup>();
+                    openLayer("group", group);
+                    writeLayerAttributes(group);
+                    writeProperties(group.getProperties());
+                    writeLayers(group.getLayers());
+                    m_xml.close();
+                }
+                    break;
+                }
+            }
+        }
+
+        void openLayer(const char* element, const Layer& layer)
+        {
+            m_xml.open(element);
+            m_xml.attribute("id", m_nextLayerID++);
+            m_xml.attribute("name", layer.getName());
+            if (!layer.getClass().empty())
+            {
+                m_xml.attribute("class", layer.getClass());
+            }
+        }
+
+        //attributes common to all layers, written after any which are specific to a layer type
+        void writeLayerAttributes(const Layer& layer)
+        {
+            if (layer.getOpacity() != 1.f)
+            {
+                m_xml.attribute("opacity", layer.getOpacity());
+            }
+            if (!layer.getVisible())
+            {
+                m_xml.attribute("visible", "0");
+            }
+            if (layer.getTintColour() != Colour(255, 255, 255, 255))
+            {
+                m_xml.attribute("tintcolor", colourString(layer.getTintColour()));
+            }
+            if (layer.getOffset().x != 0 || layer.getOffset().y != 0)
+            {
+                m_xml.attribute("offsetx", layer.getOffset().x);
+                m_xml.attribute("offsety", layer.getOffset().y);
+            }
+            if (layer.getParallaxFactor().x != 1.f || layer.getParallaxFactor().y != 1.f)
+            {
+                m_xml.attribute("parallaxx", layer.getParallaxFactor().x);
+                m_xml.attribute("parallaxy", layer.getParallaxFactor().y);
+            }
+        }
+
+        void writeTileLayer(const TileLayer& layer)
+        {
+            auto size = layer.getSize();
+            if (size.x == 0 || size.y == 0)
+            {
+                size = m_map->getTileCount();
+            }
+
+            openLayer("layer", layer);
+            m_xml.attribute("width", size.x);
+            m_xml.attribute("height", size.y);
+            writeLayerAttributes(layer);
+            writeProperties(layer.getProperties());
+
+            const auto& encoded = m_encodedLayers[m_nextEncoded++];
+            const bool csv = m_encoding == SaveSettings::Encoding::CSV;
+
+            m_xml.open("data");
+            m_xml.attribute("encoding", csv ? "csv" : "base64");
+            if (m_encoding == SaveSettings::Encoding::Base64Zlib)
+            {
+                m_xml.attribute("compression", "zlib");
+            }
+            else if (m_encoding == SaveSettings::Encoding::Base64Zstd)
+            {
+                m_xml.attribute("compression", "zstd");
+            }
+
+            if (m_infinite)
+            {
+                for (auto i = 0u; i < encoded.chunks.size(); ++i)
+                {
+                    const auto& chunk = encoded.chunks[i];
+                    m_xml.open("chunk");
+                    m_xml.attribute("x", chunk.first.x);
+                    m_xml.attribute("y", chunk.first.y);
+                    m_xml.attribute("width", chunk.second.x);
+                    m_xml.attribute("height", chunk.second.y);
+                    writeTileData(encoded.data[i], csv, false);
+                    m_xml.close();
+                }
+            }
+            else
+            {
+                writeTileData(encoded.data[0], csv, true);
+            }
+
+            m_xml.close();
+            m_xml.close();
+        }
+
+        void writeImageLayer(const ImageLayer& layer)
+        {
+            openLayer("imagelayer", layer);
+            writeLayerAttributes(layer);
+            if (layer.hasRepeatX())
+            {
+                m_xml.attribute("repeatx", "1");
+            }
+            if (layer.hasRepeatY())
+            {
+                m_xml.attribute("repeaty", "1");
+            }
+            if (layer.locked())
+            {
+                m_xml.attribute("locked", "1");
+            }
+            writeProperties(layer.getProperties());
+            if (!layer.getImagePath().empty())
+            {
+                writeImage(layer.getImagePath(), layer.getImageSize(), layer.hasTransparency(), layer.getTransparencyColour());
+            }
+            m_xml.close();
+        }
+
+        void writeTileData(const std::string& data, bool csv, bool indented)
+        {
+            if (csv)
+            {
+                //rows of CSV data always start at the beginning of a line
+                m_xml.lineBreak(0);
+                m_xml.data(data);
+                m_xml.lineBreak(0);
+            }
+            else if (indented)
+            {
+                m_xml.lineBreak(m_xml.depth());
+                m_xml.data(data);
+                m_xml.lineBreak(m_xml.depth() - 1);
+            }
+            else
+            {
+                m_xml.data(data);
+            }
+        }
+
+        void writeObjectGroup(const ObjectGroup& group)
+        {
+            openLayer("objectgroup", group);
+            if (group.getColour() != Colour(127, 127, 127, 255))
+            {
+                m_xml.attribute("color", colourString(group.getColour()));
+            }
+            writeLayerAttributes(group);
+            if (group.getDrawOrder() == ObjectGroup::DrawOrder::Index)
+            {
+                m_xml.attribute("draworder", "index");
+            }
+            writeProperties(group.getProperties());
+            writeObjects(group.getObjects());
+            m_xml.close();
+        }
+
+        void writeObjects(const std::vector<Object>& objects)
+        {
+            for (const auto& object : objects)
+            {
+                writeObject(object);
+            }
+        }
+
+        void writeObject(const Object& object)
+        {
+            m_xml.open("object");
+            if (object.getUID() != 0)
+            {
+                m_xml.attribute("id", object.getUID());
+            }
+            if (!object.getName().empty())
+            {
+                m_xml.attribute("name", object.getName());
+            }
+            if (!object.getClass().empty())
+            {
+                m_xml.attribute("class", object.getClass());
+            }
+
+            if (object.getTileID() != 0)
+            {
+                auto ID = static_cast<std::int64_t>(object.getTileID());
+                auto offset = m_templateGIDOffsets.find(object.getTilesetName());
+                if (!object.getTilesetName().empty() && offset != m_templateGIDOffsets.end())
+                {
+                    ID += offset->second;
+                }
+                m_xml.attribute("gid", static_cast<std::uint32_t>(ID) | (static_cast<std::uint32_t>(object.getFlipFlags()) << 28));
+            }
+
+            m_xml.attribute("x", object.getPosition().x);
+            m_xml.attribute("y", object.getPosition().y);
+            if (object.getAABB().width != 0 || object.getAABB().height != 0)
+            {
+                m_xml.attribute("width", object.getAABB().width);
+                m_xml.attribute("height", object.getAABB().height);
+            }
+            if (object.getRotation() != 0)
+            {
+                m_xml.attribute("rotation", object.getRotation());
+            }
+            if (!object.visible())
+            {
+                m_xml.attribute("visible", "0");
+            }
+
+            writeProperties(object.getProperties());
+
+            switch (object.getShape())
+            {
+            default: break;
+            case Object::Shape::Ellipse:
+                m_xml.open("ellipse");
+                m_xml.close();
+                break;
+            case Object::Shape::Point:
+                m_xml.open("point");
+                m_xml.close();
+                break;
+            case Object::Shape::Polygon:
+            case Object::Shape::Polyline:
+                m_xml.open(object.getShape() == Object::Shape::Polygon ? "polygon" : "polyline");
+                writePoints(object.getPoints());
+                m_xml.close();
+                break;
+            case Object::Shape::Text:
+                writeText(object.getText());
+                break;
+            }
+
+            m_xml.close();
+        }
+
+        void writePoints(const std::vector<Vector2f>& points)
+        {
+            std::string str;
+            char buffer[32];
+            for (const auto& point : points)
+            {
+                if (!str.empty())
+                {
+                    str += ' ';
+                }
+                str += formatFloat(buffer, point.x);
+                str += ',';
+                str += formatFloat(buffer, point.y);
+            }
+            m_xml.attribute("points", str);
+        }
+
+        void writeText(const Text& text)
+        {
+            m_xml.open("text");
+            if (!text.fontFamily.empty())
+            {
+                m_xml.attribute("fontfamily", text.fontFamily);
+            }
+            if (text.pixelSize != 16)
+            {
+                m_xml.attribute("pixelsize", text.pixelSize);
+            }
+            if (text.wrap)
+            {
+                m_xml.attribute("wrap", "1");
+            }
+            if (text.colour != Colour(255, 255, 255, 255))
+            {
+                m_xml.attribute("color", colourString(text.colour));
+            }
+            if (text.bold)
+            {
+                m_xml.attribute("bold", "1");
+            }
+            if (text.italic)
+            {
+                m_xml.attribute("italic", "1");
+            }
+            if (text.underline)
+            {
+                m_xml.attribute("underline", "1");
+            }
+            if (text.strikethough)
+            {
+                m_xml.attribute("strikeout", "1");
+            }
+            if (!text.kerning)
+            {
+                m_xml.attribute("kerning", "0");
+            }
+            if (text.hAlign != Text::HAlign::Left)
+            {
+                m_xml.attribute("halign", text.hAlign == Text::HAlign::Centre ? "center" : "right");
+            }
+            if (text.vAlign != Text::VAlign::Top)
+            {
+                m_xml.attribute("valign", text.vAlign == Text::VAlign::Centre ? "center" : "bottom");
+            }
+            m_xml.text(text.content);
+            m_xml.close();
+        }
+    };
+}
+
+//Map and Tileset functions
+bool Map::save(const std::string& path, const SaveSettings& settings) const
+{
+    std::string document;
+    if (!saveToString(document, getFilePath(path), settings))
+    {
+        return false;
+    }
+    return writeFile(path, document);
+}
+
+bool Map::saveToString(std::string& destination, const std::string& workingDir, const SaveSettings& settings) const
+{
+    destination.clear();
+
+    MapWriter writer(destination, workingDir);
+    if (!writer.writeMap(*this, settings))
+    {
+        destination.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Tileset::save(const std::string& path) const
+{
+    std::string document;
+    saveToString(document, getFilePath(path));
+    return writeFile(path, document);
+}
+
+void Tileset::saveToString(std::string& destination, const std::string& workingDir) const
+{
+    destination.clear();
+
+    MapWriter writer(destination, workingDir);
+    writer.writeTileset(*this, 0);
+}
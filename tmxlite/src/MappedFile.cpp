@@ -0,0 +1,159 @@
+/*********************************************************************
+Matt Marchant 2016 - 2023
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/MappedFile.hpp>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+using namespace tmx;
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator = (MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+#ifdef _WIN32
+        std::swap(m_mappingHandle, other.m_mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+//public
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    //PAGE_WRITECOPY lets us modify the view without touching the file
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mappingHandle = mapping;
+    m_data = static_cast<char*>(view);
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    //MAP_PRIVATE makes the pages copy-on-write so we can parse in place
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise(view, static_cast<std::size_t>(info.st_size), POSIX_MADV_SEQUENTIAL);
+#endif
+
+    m_data = static_cast<char*>(view);
+    m_size = static_cast<std::size_t>(info.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    m_mappingHandle = nullptr;
+#else
+    munmap(m_data, m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
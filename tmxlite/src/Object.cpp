@@ -33,9 +33,11 @@ source distribution.
 #include <tmxlite/Object.hpp>
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/Map.hpp>
+#include <tmxlite/TemplateCache.hpp>
 #include <tmxlite/Tileset.hpp>
 #include <tmxlite/detail/Log.hpp>
 
+#include <mutex>
 #include <sstream>
 
 using namespace tmx;
@@ -216,57 +218,53 @@ void Object::parseTemplate(const std::string& path, Map* map)
 {
     assert(map);
 
+    //the map's templates are shared by all of its layers, which may be
+    //parsed on different threads. Entries are never removed while loading
+    //so the template remains valid once the lock is released
+    const Object* templateObject = nullptr;
     auto& templateObjects = map->getTemplateObjects();
-    auto& templateTilesets = map->getTemplateTilesets();
-
-    //load the template if not already loaded
-    if (templateObjects.count(path) == 0)
     {
-        auto templatePath = map->getWorkingDirectory() + "/" + path;
-
-        pugi::xml_document doc;
-        if (!doc.load_file(templatePath.c_str()))
+        std::lock_guard<std::mutex> lock(map->m_loadMutex.mutex);
+        auto result = templateObjects.find(path);
+        if (result != templateObjects.end())
         {
-            Logger::log("Failed opening template file " + path, Logger::Type::Error);
-            return;
+            templateObject = &result->second;
         }
+    }
 
-        auto templateNode = doc.child("template");
-        if (!templateNode)
+    //load the template if not already loaded. This is done without holding
+    //the lock, as parsing its tile set may run tasks on the map's executor,
+    //and those tasks may parse templated objects themselves. If two threads
+    //load the same template the first one to finish is kept
+    if (!templateObject)
+    {
+        auto templatePath = resolveFilePath(path, map->getWorkingDirectory());
+
+        auto* cache = map->getTemplateCache();
+        auto loaded = cache ? cache->load(templatePath, map) : TemplateCache::parse(templatePath, map, true);
+        if (!loaded)
         {
-            Logger::log("Template node missing from " + path, Logger::Type::Error);
+            map->addDependency(templatePath);
             return;
         }
 
-        //if the template has a tileset load that (if not already loaded)
-        std::string tilesetName;
-        auto tileset = templateNode.child("tileset");
-        if (tileset)
+        for (const auto& file : loaded->files)
         {
-            tilesetName = tileset.attribute("source").as_string();
-            if (!tilesetName.empty() &&
-                templateTilesets.count(tilesetName) == 0)
-            {
-                templateTilesets.insert(std::make_pair(tilesetName, Tileset(map->getWorkingDirectory())));
-                templateTilesets.at(tilesetName).parse(tileset, map);
-            }
+            map->addDependency(file.path);
         }
 
-        //parse the object - don't pass the map pointer here so there's
-        //no recursion if someone tried to get clever and put a template in a template
-        auto obj = templateNode.child("object");
-        if (obj)
+        std::lock_guard<std::mutex> lock(map->m_loadMutex.mutex);
+        const auto& tilesetName = loaded->object.m_tilesetName;
+        if (!tilesetName.empty())
         {
-            templateObjects.insert(std::make_pair(path, Object()));
-            templateObjects[path].parse(obj, nullptr);
-            templateObjects[path].m_tilesetName = tilesetName;
+            map->getTemplateTilesets().emplace(tilesetName, loaded->tileset);
         }
+        templateObject = &templateObjects.emplace(path, loaded->object).first->second;
     }
 
     //apply any non-overridden object properties from the template
-    if (templateObjects.count(path) != 0)
     {
-        const auto& obj = templateObjects[path];
+        const auto& obj = *templateObject;
         if (m_AABB.width == 0)
         {
             m_AABB.width = obj.m_AABB.width;
@@ -37,13 +37,14 @@ using namespace tmx;
 
 bool ObjectTypes::load(const std::string &path)
 {
-    std::string contents;
-    if (!readFileIntoString(path, &contents))
+    AssetBuffer file;
+    auto& provider = m_assetProvider ? *m_assetProvider : AssetProvider::getDefault();
+    if (!provider.open(path, file))
     {
         Logger::log("Failed to read file " + path, Logger::Type::Error);
         return reset();
     }
-    return loadFromString(contents, getFilePath(path));
+    return loadFromBuffer(file.getMutableData(), file.size(), getFilePath(path));
 }
 
 bool ObjectTypes::loadFromString(const std::string &data, const std::string &workingDir)
@@ -60,6 +61,32 @@ bool ObjectTypes::loadFromString(const std::string &data, const std::string &wor
         return false;
     }
 
+    return parseDocument(doc, workingDir);
+}
+
+bool ObjectTypes::loadFromString(std::string &&data, const std::string &workingDir)
+{
+    return loadFromBuffer(&data[0], data.size(), workingDir);
+}
+
+bool ObjectTypes::loadFromBuffer(char *data, std::size_t size, const std::string &workingDir)
+{
+    reset();
+
+    pugi::xml_document doc;
+    auto result = doc.load_buffer_inplace(data, size);
+    if (!result)
+    {
+        Logger::log("Failed opening object types", Logger::Type::Error);
+        Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+        return false;
+    }
+
+    return parseDocument(doc, workingDir);
+}
+
+bool ObjectTypes::parseDocument(const pugi::xml_node &doc, const std::string &workingDir)
+{
     //make sure we have consistent path separators
     m_workingDirectory = workingDir;
     std::replace(m_workingDirectory.begin(), m_workingDirectory.end(), '\\', '/');
@@ -0,0 +1,178 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#ifdef USE_EXTLIBS
+#include <pugixml.hpp>
+#else
+#include "detail/pugixml.hpp"
+#endif
+#include <tmxlite/TemplateCache.hpp>
+#include <tmxlite/AssetProvider.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/JsonMap.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+
+using namespace tmx;
+
+//public
+void TemplateCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_templates.clear();
+}
+
+std::size_t TemplateCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_templates.size();
+}
+
+//private
+TemplateCache::TemplatePtr TemplateCache::load(const std::string& path, Map* map)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto result = m_templates.find(path);
+        if (result != m_templates.end())
+        {
+            const auto& files = result->second->files;
+            auto& provider = map->getProvider();
+            bool modified = std::any_of(files.begin(), files.end(),
+                [&provider](const FileInfo& file)
+                {
+                    FileInfo current;
+                    return !provider.getFileInfo(file.path, current.modifiedTime, current.fileSize)
+                        || current.modifiedTime != file.modifiedTime
+                        || current.fileSize != file.fileSize;
+                });
+
+            if (!modified)
+            {
+                return result->second;
+            }
+        }
+    }
+
+    //as with the TilesetCache the template is parsed without holding
+    //the lock, as parsing its tile set may run tasks on an executor
+    auto loaded = parse(path, map, false);
+    if (loaded && loaded->cacheable)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_templates[path] = loaded;
+    }
+    return loaded;
+}
+
+TemplateCache::TemplatePtr TemplateCache::parse(const std::string& path, Map* map, bool useMapTilesets)
+{
+    auto retVal = std::make_shared<Template>();
+    auto& provider = map->getProvider();
+
+    retVal->files.emplace_back();
+    retVal->files.back().path = path;
+    retVal->cacheable = provider.getFileInfo(path, retVal->files.back().modifiedTime, retVal->files.back().fileSize);
+
+    AssetBuffer file;
+    if (!provider.open(path, file))
+    {
+        Logger::log("Failed opening template file " + path, Logger::Type::Error);
+        return nullptr;
+    }
+
+    //the object is parsed without the map pointer so there's no recursion
+    //if someone tried to get clever and put a template in a template
+    std::string tilesetName;
+    std::uint32_t firstGID = 0;
+    pugi::xml_document doc;
+    if (JsonMap::isJson(file.data(), file.size()))
+    {
+        if (!JsonMap::readTemplate(file.getMutableData(), file.size(), path, retVal->object, tilesetName, firstGID))
+        {
+            return nullptr;
+        }
+    }
+    else
+    {
+        if (!doc.load_buffer_inplace(file.getMutableData(), file.size()))
+        {
+            Logger::log("Failed opening template file " + path, Logger::Type::Error);
+            return nullptr;
+        }
+
+        auto templateNode = doc.child("template");
+        if (!templateNode)
+        {
+            Logger::log("Template node missing from " + path, Logger::Type::Error);
+            return nullptr;
+        }
+
+        auto tileset = templateNode.child("tileset");
+        if (tileset)
+        {
+            tilesetName = tileset.attribute("source").as_string();
+            firstGID = tileset.attribute("firstgid").as_uint();
+        }
+
+        auto obj = templateNode.child("object");
+        if (!obj)
+        {
+            Logger::log("Object node missing from template " + path, Logger::Type::Error);
+            return nullptr;
+        }
+        retVal->object.parse(obj, nullptr);
+    }
+
+    //the template's tile set is relative to the template file,
+    //which may not be in the same directory as the map
+    if (!tilesetName.empty())
+    {
+        const auto& mapTilesets = map->getTemplateTilesets();
+        auto result = mapTilesets.find(tilesetName);
+        if (useMapTilesets && result != mapTilesets.end())
+        {
+            retVal->tileset = result->second;
+        }
+        else
+        {
+            retVal->tileset = Tileset(getFilePath(path));
+            retVal->tileset.setExecutor(map->getExecutor());
+            retVal->tileset.parseReference(firstGID, tilesetName, map);
+        }
+
+        retVal->files.emplace_back();
+        retVal->files.back().path = resolveFilePath(tilesetName, getFilePath(path));
+        retVal->cacheable = provider.getFileInfo(retVal->files.back().path, retVal->files.back().modifiedTime, retVal->files.back().fileSize)
+            && retVal->cacheable;
+    }
+
+    retVal->object.m_tilesetName = tilesetName;
+    return retVal;
+}
@@ -0,0 +1,194 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/ThreadPool.hpp>
+
+#include <algorithm>
+#include <deque>
+
+using namespace tmx;
+
+namespace
+{
+    //lets submit() and wait() find the queue belonging to the current thread
+    struct WorkerInfo final
+    {
+        const ThreadPool* pool = nullptr;
+        std::size_t queueIndex = 0;
+    };
+    thread_local WorkerInfo currentWorker;
+}
+
+struct ThreadPool::WorkQueue final
+{
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : m_running (true),
+    m_queued    (0),
+    m_waiting   (0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (auto i = 0u; i < threadCount + 1; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    m_threads.reserve(threadCount);
+    for (auto i = 0u; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::threadFunc, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+//public
+void ThreadPool::submit(Task task)
+{
+    auto& queue = *m_queues[getQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    m_queued++;
+
+    //taking the lock makes sure a thread which has just found
+    //nothing to do is waiting before it is notified
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_condition.notify_one();
+}
+
+void ThreadPool::wait(const std::function<bool()>& done)
+{
+    const auto queueIndex = getQueueIndex();
+    while (!done())
+    {
+        if (!runTask(queueIndex))
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiting++;
+            m_condition.wait(lock, [&]() { return done() || m_queued != 0; });
+            m_waiting--;
+        }
+    }
+}
+
+//private
+std::size_t ThreadPool::getQueueIndex() const
+{
+    return currentWorker.pool == this ? currentWorker.queueIndex : m_threads.size();
+}
+
+bool ThreadPool::runTask(std::size_t queueIndex)
+{
+    Task task;
+
+    //newest task from our own queue first, as it's most likely to
+    //share data with whatever just ran, else steal the oldest task
+    //from the next queue which has any
+    {
+        auto& queue = *m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+
+    for (auto i = 1u; i < m_queues.size() && !task; ++i)
+    {
+        auto& queue = *m_queues[(queueIndex + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    m_queued--;
+    task();
+
+    //a thread may be waiting on this task
+    if (m_waiting != 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_condition.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::threadFunc(std::size_t queueIndex)
+{
+    currentWorker.pool = this;
+    currentWorker.queueIndex = queueIndex;
+
+    while (true)
+    {
+        if (runTask(queueIndex))
+        {
+            continue;
+        }
+
+        //queued tasks are finished before the thread exits
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return !m_running || m_queued != 0; });
+        if (!m_running && m_queued == 0)
+        {
+            return;
+        }
+    }
+}
@@ -28,19 +28,25 @@ source distribution.
 #ifdef USE_EXTLIBS
 #include <pugixml.hpp>
 #include <zstd.h>
+#include <zlib.h>
 #else
 #include "detail/pugixml.hpp"
+#include "miniz.h"
 #endif
 
 #ifdef USE_ZSTD
 #include <zstd.h>
 #endif
 
+#include <tmxlite/Executor.hpp>
 #include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/Map.hpp>
 #include <tmxlite/TileLayer.hpp>
 #include <tmxlite/detail/Log.hpp>
 
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 using namespace tmx;
 
@@ -53,16 +59,487 @@ namespace
             Zlib, GZip, Zstd, None
         };
     };
+
+    struct Encoding final
+    {
+        enum
+        {
+            Base64, CSV
+        };
+    };
+
+    //size of the intermediate blocks used when decoding layer data.
+    //Large enough to amortise the per-block overhead while small
+    //enough for both the encoded and inflated blocks to stay in cache
+    constexpr std::size_t BlockSize = 8 * 1024;
+
+    //number of infinite map chunks decoded by a single task
+    constexpr std::size_t ChunkBatchSize = 64;
+
+    //tiles hold the raw GID, so on little endian hosts the decoded
+    //layer data already has the same layout as the tiles
+    bool isLittleEndian()
+    {
+        const std::uint32_t value = 1;
+        return *reinterpret_cast<const unsigned char*>(&value) == 1;
+    }
+
+    //GIDs in native byte order can be copied straight into the tiles
+    void appendTiles(std::vector<TileLayer::Tile>& destination, const void* gids, std::size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const auto offset = destination.size();
+        destination.resize(offset + count);
+        std::memcpy(destination.data() + offset, gids, count * sizeof(TileLayer::Tile));
+    }
+
+    //converts a stream of little endian bytes into tiles as it
+    //arrives, holding on to any GID which straddles two blocks
+    class TileUnpacker final
+    {
+    public:
+        TileUnpacker(std::vector<TileLayer::Tile>& destination, std::size_t tileCount)
+            : m_destination (destination),
+            m_remaining     (tileCount)
+        {
+            m_destination.reserve(m_destination.size() + tileCount);
+        }
+
+        //returns false if there are more bytes than expected tiles
+        bool write(const unsigned char* data, std::size_t size)
+        {
+            while (size != 0)
+            {
+                if (m_remaining == 0)
+                {
+                    return false;
+                }
+
+                if (m_partialSize != 0 || size < 4)
+                {
+                    m_partial[m_partialSize++] = *data++;
+                    size--;
+
+                    if (m_partialSize == 4)
+                    {
+                        push(m_partial.data());
+                        m_partialSize = 0;
+                    }
+                    continue;
+                }
+
+                auto count = std::min(size / 4, m_remaining);
+                if (isLittleEndian())
+                {
+                    appendTiles(m_destination, data, count);
+                    data += count * 4;
+                    m_remaining -= count;
+                }
+                else
+                {
+                    for (auto i = 0u; i < count; ++i, data += 4)
+                    {
+                        push(data);
+                    }
+                }
+                size -= count * 4;
+            }
+            return true;
+        }
+
+        bool complete() const { return m_remaining == 0 && m_partialSize == 0; }
+
+        std::size_t remainingBytes() const { return (m_remaining * 4) - m_partialSize; }
+
+    private:
+        std::vector<TileLayer::Tile>& m_destination;
+        std::size_t m_remaining;
+        std::array<unsigned char, 4> m_partial = {};
+        std::size_t m_partialSize = 0;
+
+        void push(const unsigned char* bytes)
+        {
+            m_destination.push_back(TileLayer::Tile::fromGID(bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<std::uint32_t>(bytes[3]) << 24));
+            m_remaining--;
+        }
+    };
+
+    //decodes base64 (and optionally compressed) layer data straight
+    //into the destination tiles, a block at a time, so that the only
+    //allocation made is the tile storage itself
+    TileLayer::DecodeResult decodeBase64(const char* data, std::int32_t compressionType, std::size_t tileCount, std::vector<TileLayer::Tile>& destination)
+    {
+        const std::size_t length = std::strlen(data);
+        std::size_t position = 0;
+
+        std::array<unsigned char, BlockSize> encoded;
+        TileUnpacker unpacker(destination, tileCount);
+
+        //reads the next block of base64 into the encoded buffer
+        auto nextBlock = [&]()
+        {
+            std::size_t used = 0;
+            auto size = base64_decode(data + position, length - position, encoded.data(), encoded.size(), &used);
+            position += used;
+            return size;
+        };
+
+        switch (compressionType)
+        {
+        default:
+        {
+            //any trailing data is ignored, as it always has been
+            std::size_t size = 0;
+            while (!unpacker.complete() && (size = nextBlock()) != 0)
+            {
+                unpacker.write(encoded.data(), std::min(size, unpacker.remainingBytes()));
+            }
+        }
+            break;
+        case CompressionType::Zstd:
+#if defined USE_ZSTD || defined USE_EXTLIBS
+        {
+            std::array<unsigned char, BlockSize> inflated;
+
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            if (!stream)
+            {
+                Logger::log("Failed to create zstd stream", Logger::Type::Error);
+                return TileLayer::DecodeResult::MemoryError;
+            }
+            ZSTD_initDStream(stream);
+
+            ZSTD_inBuffer input = { encoded.data(), 0, 0 };
+            std::size_t result = 1;
+            bool flushed = true;
+            while (result != 0)
+            {
+                //only refill once any output buffered by the previous call has been drained
+                if (input.pos == input.size && flushed)
+                {
+                    input.size = nextBlock();
+                    input.pos = 0;
+                    if (input.size == 0)
+                    {
+                        break;
+                    }
+                }
+
+                ZSTD_outBuffer output = { inflated.data(), inflated.size(), 0 };
+                result = ZSTD_decompressStream(stream, &output, &input);
+                if (ZSTD_isError(result))
+                {
+                    std::string err = ZSTD_getErrorName(result);
+                    ZSTD_freeDStream(stream);
+                    LOG("Failed to decompress layer data, node skipped.\nError: " + err, Logger::Type::Error);
+                    return TileLayer::DecodeResult::DataError;
+                }
+
+                flushed = (output.pos < output.size);
+                if (!unpacker.write(inflated.data(), output.pos))
+                {
+                    ZSTD_freeDStream(stream);
+                    Logger::log("Decompressed data is larger than the expected " + std::to_string(tileCount * 4) + " bytes", Logger::Type::Error);
+                    return TileLayer::DecodeResult::SizeMismatch;
+                }
+            }
+            ZSTD_freeDStream(stream);
+
+            if (result != 0)
+            {
+                Logger::log("Compressed data is truncated", Logger::Type::Error);
+                return TileLayer::DecodeResult::DataError;
+            }
+        }
+            break;
+#else
+            Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
+            return TileLayer::DecodeResult::DataError;
+#endif
+        case CompressionType::GZip:
+#ifndef USE_EXTLIBS
+            Logger::log("Library must be built with USE_EXTLIBS for GZip compression", Logger::Type::Error);
+            return TileLayer::DecodeResult::DataError;
+#endif
+            //[[fallthrough]];
+        case CompressionType::Zlib:
+        {
+            std::array<unsigned char, BlockSize> inflated;
+
+            z_stream stream;
+            stream.zalloc = Z_NULL;
+            stream.zfree = Z_NULL;
+            stream.opaque = Z_NULL;
+            stream.next_in = Z_NULL;
+            stream.avail_in = 0;
+
+#ifdef USE_EXTLIBS
+            if (inflateInit2(&stream, 15 + 32) != Z_OK)
+#else
+            if (inflateInit(&stream) != Z_OK)
+#endif
+            {
+                LOG("inflate init failed", Logger::Type::Error);
+                return TileLayer::DecodeResult::MemoryError;
+            }
+
+            int result = Z_OK;
+            bool flushed = true;
+            while (result != Z_STREAM_END)
+            {
+                //inflate may still hold output if it filled the block last time
+                if (stream.avail_in == 0 && flushed)
+                {
+                    stream.avail_in = static_cast<unsigned int>(nextBlock());
+                    stream.next_in = encoded.data();
+                    if (stream.avail_in == 0)
+                    {
+                        break;
+                    }
+                }
+
+                stream.next_out = inflated.data();
+                stream.avail_out = static_cast<unsigned int>(inflated.size());
+                result = inflate(&stream, Z_NO_FLUSH);
+                flushed = (stream.avail_out != 0);
+
+                //no progress is possible without more input
+                if (result == Z_BUF_ERROR && stream.avail_in == 0)
+                {
+                    flushed = true;
+                    continue;
+                }
+
+                if (result != Z_OK && result != Z_STREAM_END)
+                {
+                    inflateEnd(&stream);
+                    Logger::log("If using gzip or zstd compression try using zlib instead", Logger::Type::Info);
+                    Logger::log("inflate() returned " + std::to_string(result), Logger::Type::Error);
+                    return result == Z_MEM_ERROR ? TileLayer::DecodeResult::MemoryError : TileLayer::DecodeResult::DataError;
+                }
+
+                if (!unpacker.write(inflated.data(), inflated.size() - stream.avail_out))
+                {
+                    inflateEnd(&stream);
+                    Logger::log("Decompressed data is larger than the expected " + std::to_string(tileCount * 4) + " bytes", Logger::Type::Error);
+                    return TileLayer::DecodeResult::SizeMismatch;
+                }
+            }
+            inflateEnd(&stream);
+
+            if (result != Z_STREAM_END)
+            {
+                Logger::log("Compressed data is truncated", Logger::Type::Error);
+                return TileLayer::DecodeResult::DataError;
+            }
+        }
+            break;
+        }
+
+        if (!unpacker.complete())
+        {
+            Logger::log("Layer data is smaller than the expected " + std::to_string(tileCount * 4) + " bytes", Logger::Type::Error);
+            return TileLayer::DecodeResult::SizeMismatch;
+        }
+        return TileLayer::DecodeResult::Success;
+    }
+
+    //parses CSV layer data directly from the document text a block
+    //of IDs at a time, so that the text is never copied
+    TileLayer::DecodeResult decodeCSV(const char* data, std::size_t tileCount, std::vector<TileLayer::Tile>& destination)
+    {
+        const std::size_t length = std::strlen(data);
+        std::size_t position = 0;
+
+        std::array<std::uint32_t, BlockSize / sizeof(std::uint32_t)> IDs;
+        destination.reserve(destination.size() + tileCount);
+
+        auto remaining = tileCount;
+        while (remaining != 0)
+        {
+            const auto requested = std::min(IDs.size(), remaining);
+
+            std::size_t used = 0;
+            const auto count = csv_decode(data + position, length - position, IDs.data(), requested, &used);
+            position += used;
+
+            appendTiles(destination, IDs.data(), count);
+            remaining -= count;
+
+            if (count < requested)
+            {
+                break;
+            }
+        }
+
+        if (remaining == 0)
+        {
+            //make sure anything left over is only whitespace
+            std::size_t used = 0;
+            csv_decode(data + position, length - position, nullptr, 0, &used);
+            position += used;
+        }
+
+        if (position < length)
+        {
+            if (remaining == 0 && data[position] >= '0' && data[position] <= '9')
+            {
+                Logger::log("Layer data contains more than the expected " + std::to_string(tileCount) + " tiles", Logger::Type::Error);
+                return TileLayer::DecodeResult::SizeMismatch;
+            }
+
+            const auto line = std::count(data, data + position, '\n') + 1;
+            Logger::log("Invalid CSV layer data on line " + std::to_string(line) + " near '" + std::string(data + position, std::min<std::size_t>(length - position, 12)) + "'", Logger::Type::Error);
+            return TileLayer::DecodeResult::DataError;
+        }
+
+        if (remaining != 0)
+        {
+            Logger::log("Layer data contains " + std::to_string(tileCount - remaining) + " tiles, expected " + std::to_string(tileCount), Logger::Type::Error);
+            return TileLayer::DecodeResult::SizeMismatch;
+        }
+        return TileLayer::DecodeResult::Success;
+    }
+
+    bool intersects(const IntRect& region, const Vector2i& position, const Vector2i& size)
+    {
+        //64 bit so that very large regions can't overflow
+        return static_cast<std::int64_t>(position.x) < static_cast<std::int64_t>(region.left) + region.width
+            && static_cast<std::int64_t>(region.left) < static_cast<std::int64_t>(position.x) + size.x
+            && static_cast<std::int64_t>(position.y) < static_cast<std::int64_t>(region.top) + region.height
+            && static_cast<std::int64_t>(region.top) < static_cast<std::int64_t>(position.y) + size.y;
+    }
+
+    TileLayer::DecodeResult decodeText(const char* data, std::int32_t encoding, std::int32_t compressionType, std::size_t tileCount, std::vector<TileLayer::Tile>& destination)
+    {
+        if (encoding == Encoding::CSV)
+        {
+            return decodeCSV(data, tileCount, destination);
+        }
+        return decodeBase64(data, compressionType, tileCount, destination);
+    }
 }
 
+struct TileLayer::EncodedData final
+{
+    std::int32_t encoding = Encoding::Base64;
+    std::int32_t compression = CompressionType::None;
+
+    //layer data, or nullptr if the data is stored in chunks
+    const char* data = nullptr;
+    std::vector<EncodedChunk> chunks;
+
+    //copy of the text pointed to by data and chunks, when
+    //it needs to outlive the document it was parsed from
+    std::vector<char> storage;
+
+    EncodedData() = default;
+    EncodedData(EncodedData&&) = default;
+
+    //the copy gets its own storage for the text
+    EncodedData(const EncodedData& other)
+        : encoding  (other.encoding),
+        compression (other.compression),
+        data        (other.data),
+        chunks      (other.chunks)
+    {
+        store();
+    }
+
+    void store()
+    {
+        std::size_t size = data ? std::strlen(data) + 1 : 0;
+        for (const auto& chunk : chunks)
+        {
+            size += std::strlen(chunk.data) + 1;
+        }
+
+        storage.resize(size);
+        auto* dest = storage.data();
+        const auto copy = [&dest](const char*& text)
+        {
+            const auto length = std::strlen(text) + 1;
+            std::memcpy(dest, text, length);
+            text = dest;
+            dest += length;
+        };
+
+        if (data)
+        {
+            copy(data);
+        }
+
+        for (auto& chunk : chunks)
+        {
+            copy(chunk.data);
+        }
+    }
+};
+
 TileLayer::TileLayer(std::size_t tileCount)
-    : m_tileCount (tileCount)
+    : m_tileCount   (tileCount),
+    m_decodeResult  (DecodeResult::Success),
+    m_decoded       (true)
+{
+
+}
+
+TileLayer::~TileLayer() = default;
+
+TileLayer::TileLayer(const TileLayer& other)
+    : Layer     (other),
+    m_tileCount (other.m_tileCount),
+    m_decoded   (true)
+{
+    std::lock_guard<std::mutex> lock(other.m_decodeMutex);
+    copyData(other);
+}
+
+TileLayer::TileLayer(TileLayer&& other) noexcept
+    : Layer     (std::move(other)),
+    m_tileCount (other.m_tileCount),
+    m_decoded   (true)
 {
-    m_tiles.reserve(tileCount);
+    std::lock_guard<std::mutex> lock(other.m_decodeMutex);
+    moveData(other);
+}
+
+TileLayer& TileLayer::operator = (const TileLayer& other)
+{
+    if (this != &other)
+    {
+        Layer::operator=(other);
+
+        std::lock(m_decodeMutex, other.m_decodeMutex);
+        std::lock_guard<std::mutex> lock(m_decodeMutex, std::adopt_lock);
+        std::lock_guard<std::mutex> otherLock(other.m_decodeMutex, std::adopt_lock);
+        m_tileCount = other.m_tileCount;
+        copyData(other);
+    }
+    return *this;
+}
+
+TileLayer& TileLayer::operator = (TileLayer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Layer::operator=(std::move(other));
+
+        std::lock(m_decodeMutex, other.m_decodeMutex);
+        std::lock_guard<std::mutex> lock(m_decodeMutex, std::adopt_lock);
+        std::lock_guard<std::mutex> otherLock(other.m_decodeMutex, std::adopt_lock);
+        m_tileCount = other.m_tileCount;
+        moveData(other);
+    }
+    return *this;
 }
 
 //public
-void TileLayer::parse(const pugi::xml_node& node, Map*)
+void TileLayer::parse(const pugi::xml_node& node, Map* map)
 {
     std::string attribName = node.name();
     if (attribName != "layer")
@@ -91,13 +568,9 @@ void TileLayer::parse(const pugi::xml_node& node, Map*)
         if (attribName == "data")
         {
             attribName = child.attribute("encoding").as_string();
-            if (attribName == "base64")
+            if (attribName == "base64" || attribName == "csv")
             {
-                parseBase64(child);
-            }
-            else if (attribName == "csv")
-            {
-                parseCSV(child);
+                parseEncoded(child, map);
             }
             else
             {
@@ -115,195 +588,309 @@ void TileLayer::parse(const pugi::xml_node& node, Map*)
 
 }
 
+void TileLayer::setTiles(std::vector<Tile> tiles)
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    m_tiles = std::move(tiles);
+    m_tileCount = m_tiles.size();
+    m_encodedData.reset();
+    m_pendingChunks.reset();
+    m_decodeResult = DecodeResult::Success;
+    m_decoded.store(true, std::memory_order_release);
+}
+
+void TileLayer::setChunks(std::vector<Chunk> chunks)
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    m_chunks = std::move(chunks);
+    m_encodedData.reset();
+    m_pendingChunks.reset();
+    m_decodeResult = DecodeResult::Success;
+    m_decoded.store(true, std::memory_order_release);
+}
+
+std::size_t TileLayer::getPendingChunkCount() const
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    return m_pendingChunks ? m_pendingChunks->chunks.size() : 0;
+}
+
 //private
-void TileLayer::parseBase64(const pugi::xml_node& node)
+void TileLayer::copyData(const TileLayer& other)
 {
-    auto processDataString = [](std::string dataString, std::size_t tileCount, std::int32_t compressionType)->std::vector<std::uint32_t>
-    {
-        std::stringstream ss;
-        ss << dataString;
-        ss >> dataString;
-        dataString = base64_decode(dataString);
+    m_tiles = other.m_tiles;
+    m_chunks = other.m_chunks;
+    m_encodedData = other.m_encodedData ? std::make_unique<EncodedData>(*other.m_encodedData) : nullptr;
+    m_pendingChunks = other.m_pendingChunks ? std::make_unique<EncodedData>(*other.m_pendingChunks) : nullptr;
+    m_decodeResult = other.m_decodeResult;
+    m_decoded.store(other.m_decoded.load(std::memory_order_acquire), std::memory_order_release);
+}
 
-        std::size_t expectedSize = tileCount * 4; //4 bytes per tile
-        std::vector<unsigned char> byteData;
-        byteData.reserve(expectedSize);
+void TileLayer::moveData(TileLayer& other)
+{
+    m_tiles = std::move(other.m_tiles);
+    m_chunks = std::move(other.m_chunks);
+    m_encodedData = std::move(other.m_encodedData);
+    m_pendingChunks = std::move(other.m_pendingChunks);
+    m_decodeResult = other.m_decodeResult;
+    m_decoded.store(other.m_decoded.load(std::memory_order_acquire), std::memory_order_release);
+
+    //the moved from layer is left empty, with nothing to decode
+    other.m_tiles.clear();
+    other.m_chunks.clear();
+    other.m_decoded.store(true, std::memory_order_release);
+}
 
-        switch (compressionType)
+void TileLayer::parseEncoded(const pugi::xml_node& node, Map* map)
+{
+    std::vector<EncodedChunk> chunks;
+
+    const char* data = node.text().get();
+    if (*data == 0)
+    {
+        //check for chunk nodes
+        data = nullptr;
+        for (const auto& childNode : node.children("chunk"))
         {
-        default:
-            byteData.insert(byteData.end(), dataString.begin(), dataString.end());
-            break;
-        case CompressionType::Zstd:
-#if defined USE_ZSTD || defined USE_EXTLIBS
+            const char* dataString = childNode.text().get();
+            if (*dataString != 0)
             {
-                std::size_t dataSize = dataString.length() * sizeof(unsigned char);
-                std::size_t result = ZSTD_decompress(byteData.data(), expectedSize, &dataString[0], dataSize);
-                
-                if (ZSTD_isError(result))
-                {
-                    std::string err = ZSTD_getErrorName(result);
-                    LOG("Failed to decompress layer data, node skipped.\nError: " + err, Logger::Type::Error);
-                }
+                chunks.emplace_back();
+                auto& chunk = chunks.back();
+                chunk.position.x = childNode.attribute("x").as_int();
+                chunk.position.y = childNode.attribute("y").as_int();
+
+                chunk.size.x = childNode.attribute("width").as_int();
+                chunk.size.y = childNode.attribute("height").as_int();
+                chunk.data = dataString;
             }
-#else
-            Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
-            return {};
-#endif
-        case CompressionType::GZip:
-#ifndef USE_EXTLIBS
-            Logger::log("Library must be built with USE_EXTLIBS for GZip compression", Logger::Type::Error);
-            return {};
-#endif
-            //[[fallthrough]];
-        case CompressionType::Zlib:
-        {
-            //unzip
-            std::size_t dataSize = dataString.length() * sizeof(unsigned char);
+        }
+    }
 
-            if (!decompress(dataString.c_str(), byteData, dataSize, expectedSize))
-            {
-                LOG("Failed to decompress layer data, node skipped.", Logger::Type::Error);
-                return {};
-            }
+    parseEncoded(node.attribute("encoding").as_string(), node.attribute("compression").as_string(), data, std::move(chunks), map);
+}
+
+void TileLayer::parseEncoded(const std::string& encoding, const std::string& compression, const char* text, std::vector<EncodedChunk>&& chunks, Map* map)
+{
+    EncodedData data;
+
+    if (encoding == "csv")
+    {
+        data.encoding = Encoding::CSV;
+    }
+    else
+    {
+        if (compression == "gzip")
+        {
+            data.compression = CompressionType::GZip;
         }
-            break;
+        else if (compression == "zlib")
+        {
+            data.compression = CompressionType::Zlib;
+        }
+        else if (compression == "zstd")
+        {
+            data.compression = CompressionType::Zstd;
         }
+    }
+
+    data.data = text;
+    data.chunks = std::move(chunks);
 
-        //data stream is in bytes so we need to OR into 32 bit values
-        std::vector<std::uint32_t> IDs;
-        IDs.reserve(tileCount);
-        for (auto i = 0u; i < expectedSize - 3u; i += 4u)
+    //chunks outside the map's regions of interest are kept
+    //encoded until they're requested with loadRegion()
+    if (map && !map->getRegionsOfInterest().empty() && !data.chunks.empty())
+    {
+        const auto& regions = map->getRegionsOfInterest();
+        auto outside = std::stable_partition(data.chunks.begin(), data.chunks.end(),
+            [&regions](const EncodedChunk& chunk)
+            {
+                return std::any_of(regions.begin(), regions.end(),
+                    [&chunk](const IntRect& region) { return intersects(region, chunk.position, chunk.size); });
+            });
+
+        if (outside != data.chunks.end())
         {
-            std::uint32_t id = byteData[i] | byteData[i + 1] << 8 | byteData[i + 2] << 16 | byteData[i + 3] << 24;
-            IDs.push_back(id);
+            m_pendingChunks = std::make_unique<EncodedData>();
+            m_pendingChunks->encoding = data.encoding;
+            m_pendingChunks->compression = data.compression;
+            m_pendingChunks->chunks.assign(outside, data.chunks.end());
+            m_pendingChunks->store();
+            data.chunks.erase(outside, data.chunks.end());
         }
+    }
 
-        return IDs;
-    };
+    if (map && map->getLazyDecoding())
+    {
+        //the document is gone by the time the tiles are requested
+        //so hang on to a copy of just the encoded text
+        data.store();
+        m_encodedData = std::make_unique<EncodedData>(std::move(data));
+        m_decoded.store(false, std::memory_order_release);
+    }
+    else
+    {
+        //chunks of infinite maps are decoded on the map's executor, if it has one
+        decodeData(data, map ? map->getExecutor() : nullptr, map);
+    }
+}
 
-    std::int32_t compressionType = CompressionType::None;
-    std::string compression = node.attribute("compression").as_string();
-    if (compression == "gzip")
+void TileLayer::decodePending(Executor* executor) const
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    if (m_encodedData)
     {
-        compressionType = CompressionType::GZip;
+        decodeData(*m_encodedData, executor);
+        m_encodedData.reset();
     }
-    else if (compression == "zlib")
+    m_decoded.store(true, std::memory_order_release);
+}
+
+void TileLayer::decodeData(const EncodedData& data, Executor* executor, const Map* map) const
+{
+    if (!data.data)
     {
-        compressionType = CompressionType::Zlib;
+        m_decodeResult = decodeChunks(data, m_chunks, executor, map);
+
+        if (m_chunks.empty() && !m_pendingChunks && !(map && map->isLoadCancelled()))
+        {
+            Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
+        }
     }
-    else if (compression == "zstd")
+    else
     {
-        compressionType = CompressionType::Zstd;
+        m_decodeResult = decodeText(data.data, data.encoding, data.compression, m_tileCount, m_tiles);
+        if (m_decodeResult != DecodeResult::Success)
+        {
+            LOG("Failed to decode layer data, node skipped.", Logger::Type::Error);
+            m_tiles.clear();
+        }
     }
+}
 
-    std::string data = node.text().as_string();
-    if (data.empty())
+TileLayer::DecodeResult TileLayer::decodeChunks(const EncodedData& data, std::vector<Chunk>& destination, Executor* executor, const Map* map) const
+{
+    //each chunk has a slot to decode into so they can be done in any order
+    const auto firstChunk = destination.size();
+    const auto chunkCount = data.chunks.size();
+    destination.resize(firstChunk + chunkCount);
+    std::vector<std::uint8_t> decoded(chunkCount, 0);
+    std::vector<DecodeResult> results(chunkCount, DecodeResult::Success);
+
+    const auto decodeRange = [&](std::size_t start, std::size_t end)
     {
-        //check for chunk nodes
-        auto dataCount = 0;
-        for (const auto& childNode : node.children())
+        for (auto i = start; i < end; ++i)
         {
-            std::string childName = childNode.name();
-            if (childName == "chunk")
+            if (map && map->isLoadCancelled())
             {
-                std::string dataString = childNode.text().as_string();
-                if (!dataString.empty())
-                {
-                    Chunk chunk;
-                    chunk.position.x = childNode.attribute("x").as_int();
-                    chunk.position.y = childNode.attribute("y").as_int();
-
-                    chunk.size.x = childNode.attribute("width").as_int();
-                    chunk.size.y = childNode.attribute("height").as_int();
+                return;
+            }
 
-                    auto IDs = processDataString(dataString, (chunk.size.x * chunk.size.y), compressionType);
+            const auto& encodedChunk = data.chunks[i];
+            auto& chunk = destination[firstChunk + i];
+            chunk.position = encodedChunk.position;
+            chunk.size = encodedChunk.size;
 
-                    if (!IDs.empty())
-                    {
-                        createTiles(IDs, chunk.tiles);
-                        m_chunks.push_back(chunk);
-                        dataCount++;
-                    }                    
-                }
+            results[i] = decodeText(encodedChunk.data, data.encoding, data.compression, (chunk.size.x * chunk.size.y), chunk.tiles);
+            if (results[i] == DecodeResult::Success)
+            {
+                decoded[i] = 1;
+            }
+            else
+            {
+                LOG("Failed to decode chunk data, chunk skipped.", Logger::Type::Error);
             }
         }
+    };
 
-        if (dataCount == 0)
+    //individual chunks are small so they're handed out in batches
+    if (executor && chunkCount > ChunkBatchSize)
+    {
+        TaskGroup tasks(executor);
+        for (std::size_t i = 0; i < chunkCount; i += ChunkBatchSize)
         {
-            Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
-            return;
+            const auto end = std::min(i + ChunkBatchSize, chunkCount);
+            tasks.run([&decodeRange, i, end]() { decodeRange(i, end); });
         }
+        tasks.wait();
     }
     else
     {
-        auto IDs = processDataString(data, m_tileCount, compressionType);
-        createTiles(IDs, m_tiles);
+        decodeRange(0, chunkCount);
     }
-}
 
-void TileLayer::parseCSV(const pugi::xml_node& node)
-{
-    auto processDataString = [](const std::string dataString, std::size_t tileCount)->std::vector<std::uint32_t>
+    //close any gaps left by chunks which failed, keeping document order.
+    //The first failure is the one reported
+    auto result = DecodeResult::Success;
+    auto dataCount = firstChunk;
+    for (std::size_t i = 0; i < chunkCount; ++i)
     {
-        std::vector<std::uint32_t> IDs;
-        IDs.reserve(tileCount);
-
-        const char* ptr = dataString.c_str();
-        while (true)
+        if (result == DecodeResult::Success)
         {
-            char* end;
-            auto res = std::strtoul(ptr, &end, 10);
-            if (end == ptr) break;
-            ptr = end;
-            IDs.push_back(res);
-            if (*ptr == ',') ++ptr;
+            result = results[i];
         }
 
-        return IDs;
-    };
-
-    std::string data = node.text().as_string();
-    if (data.empty())
-    {
-        //check for chunk nodes
-        auto dataCount = 0;
-        for (const auto& childNode : node.children())
+        if (decoded[i])
         {
-            std::string childName = childNode.name();
-            if (childName == "chunk")
+            if (dataCount != firstChunk + i)
             {
-                std::string dataString = childNode.text().as_string();
-                if (!dataString.empty())
-                {
-                    Chunk chunk;
-                    chunk.position.x = childNode.attribute("x").as_int();
-                    chunk.position.y = childNode.attribute("y").as_int();
+                destination[dataCount] = std::move(destination[firstChunk + i]);
+            }
+            dataCount++;
+        }
+    }
+    destination.resize(dataCount);
+    return result;
+}
 
-                    chunk.size.x = childNode.attribute("width").as_int();
-                    chunk.size.y = childNode.attribute("height").as_int();
+std::size_t TileLayer::loadPending(const IntRect* region, Executor* executor)
+{
+    //chunks inside the regions of interest come first
+    decode(executor);
 
-                    auto IDs = processDataString(dataString, chunk.size.x * chunk.size.y);
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    if (!m_pendingChunks)
+    {
+        return 0;
+    }
 
-                    if (!IDs.empty())
-                    {
-                        createTiles(IDs, chunk.tiles);
-                        m_chunks.push_back(chunk);
-                        dataCount++;
-                    }
-                }
-            }
-        }
+    //the selected chunks still point to the pending chunks' copy of the text
+    auto& chunks = m_pendingChunks->chunks;
+    auto selectedEnd = std::stable_partition(chunks.begin(), chunks.end(),
+        [region](const EncodedChunk& chunk)
+        {
+            return !region || intersects(*region, chunk.position, chunk.size);
+        });
+
+    EncodedData selected;
+    selected.encoding = m_pendingChunks->encoding;
+    selected.compression = m_pendingChunks->compression;
+    selected.chunks.assign(chunks.begin(), selectedEnd);
+    chunks.erase(chunks.begin(), selectedEnd);
 
-        if (dataCount == 0)
+    const auto previousCount = m_chunks.size();
+    if (!selected.chunks.empty())
+    {
+        const auto result = decodeChunks(selected, m_chunks, executor, nullptr);
+        if (m_decodeResult == DecodeResult::Success)
         {
-            Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
-            return;
+            m_decodeResult = result;
         }
     }
-    else
+
+    if (chunks.empty())
+    {
+        m_pendingChunks.reset();
+    }
+    return m_chunks.size() - previousCount;
+}
+
+void TileLayer::decodePendingChunks(std::vector<Chunk>& destination, Executor* executor) const
+{
+    std::lock_guard<std::mutex> lock(m_decodeMutex);
+    if (m_pendingChunks)
     {
-        createTiles(processDataString(data, m_tileCount), m_tiles);
+        decodeChunks(*m_pendingChunks, destination, executor, nullptr);
     }
 }
 
@@ -312,6 +899,7 @@ void TileLayer::parseUnencoded(const pugi::xml_node& node)
     std::string attribName;
     std::vector<std::uint32_t> IDs;
     IDs.reserve(m_tileCount);
+    m_tiles.reserve(m_tileCount);
 
     for (const auto& child : node.children())
     {
@@ -330,11 +918,5 @@ void TileLayer::createTiles(const std::vector<std::uint32_t>& IDs, std::vector<T
     //LOG(IDs.size() != m_tileCount, "Layer tile count does not match expected size. Found: "
     //    + std::to_string(IDs.size()) + ", expected: " + std::to_string(m_tileCount));
     
-    static const std::uint32_t mask = 0xf0000000;
-    for (const auto& id : IDs)
-    {
-        destination.emplace_back();
-        destination.back().flipFlags = ((id & mask) >> 28);
-        destination.back().ID = id & ~mask;
-    }
+    appendTiles(destination, IDs.data(), IDs.size());
 }
@@ -32,23 +32,30 @@ source distribution.
 #endif
 #include <tmxlite/Tileset.hpp>
 #include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/JsonMap.hpp>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TilesetCache.hpp>
 #include <tmxlite/detail/Log.hpp>
 
+#include <algorithm>
 #include <ctype.h>
 
 using namespace tmx;
 
+namespace
+{
+    //number of tile nodes parsed by each task when
+    //a tile set is parsed in parallel
+    constexpr std::size_t TileBatchSize = 256;
+}
+
 //public
 Tileset::Tileset(const std::string& workingDir)
-    : m_workingDir          (workingDir),
-    m_firstGID              (0),
-    m_spacing               (0),
-    m_margin                (0),
-    m_tileCount             (0),
-    m_columnCount           (0),
-    m_objectAlignment       (ObjectAlignment::Unspecified),
-    m_transparencyColour    (0, 0, 0, 0),
-    m_hasTransparency       (false)
+    : m_workingDir  (workingDir),
+    m_executor      (nullptr),
+    m_assetProvider (nullptr),
+    m_firstGID      (0),
+    m_data          (std::make_shared<Data>())
 {
 
 }
@@ -56,19 +63,33 @@ Tileset::Tileset(const std::string& workingDir)
 bool Tileset::loadWithoutMap(const std::string& path)
 {
     std::string resolved_path = tmx::resolveFilePath(path, m_workingDir);
-    std::string contents;
-    if (!readFileIntoString(resolved_path, &contents))
+
+    AssetBuffer file;
+    auto& provider = m_assetProvider ? *m_assetProvider : AssetProvider::getDefault();
+    if (!provider.open(resolved_path, file))
     {
         Logger::log("Failed to read file " + resolved_path, Logger::Type::Error);
         return reset();
     }
 
     m_workingDir = getFilePath(resolved_path);
-    return loadWithoutMapFromString(contents);
+    if (!loadWithoutMapFromBuffer(file.getMutableData(), file.size()))
+    {
+        return false;
+    }
+
+    m_data->source = resolved_path;
+    return true;
 }
 
 bool Tileset::loadWithoutMapFromString(const std::string& xmlStr)
 {
+    //JSON is always parsed in place, so needs a copy
+    if (JsonMap::isJson(xmlStr.data(), xmlStr.size()))
+    {
+        return loadWithoutMapFromString(std::string(xmlStr));
+    }
+
     pugi::xml_document doc;
     auto result = doc.load_string(xmlStr.c_str());
     if (!result)
@@ -78,18 +99,38 @@ bool Tileset::loadWithoutMapFromString(const std::string& xmlStr)
         return false;
     }
 
-    auto tilesetNode = doc.child("tileset");
-    if (!tilesetNode)
+    return parseDocument(doc);
+}
+
+bool Tileset::loadWithoutMapFromString(std::string&& xmlStr)
+{
+    return loadWithoutMapFromBuffer(&xmlStr[0], xmlStr.size());
+}
+
+bool Tileset::loadWithoutMapFromBuffer(char* data, std::size_t size)
+{
+    if (JsonMap::isJson(data, size))
     {
-        Logger::log("Failed opening tileset: no tileset node found", Logger::Type::Error);
-        return reset();
+        return JsonMap::read(*this, data, size);
     }
 
-    return parse(tilesetNode, nullptr);
+    pugi::xml_document doc;
+    auto result = doc.load_buffer_inplace(data, size);
+    if (!result)
+    {
+        Logger::log("Failed to parse tileset XML", Logger::Type::Error);
+        Logger::log("Reason: " + std::string(result.description()), Logger::Type::Error);
+        return false;
+    }
+
+    return parseDocument(doc);
 }
 
 bool Tileset::parse(pugi::xml_node node, Map* map)
 {
+    //copies of this tile set may share its data, so never modify it in place
+    m_data = std::make_shared<Data>();
+
     std::string attribString = node.name();
 
     //when parsing as part of a map, we may be looking at an inline node that
@@ -102,85 +143,90 @@ bool Tileset::parse(pugi::xml_node node, Map* map)
             return false;
         }
 
+        if (node.attribute("source"))
+        {
+            return parseReference(node.attribute("firstgid").as_uint(), node.attribute("source").as_string(), map);
+        }
+
+        m_assetProvider = map->getAssetProvider();
+
         m_firstGID = node.attribute("firstgid").as_int();
         if (m_firstGID == 0)
         {
             Logger::log("Invalid first GID in tileset. Tileset node skipped.", Logger::Type::Warning);
             return false;
         }
-
-        if (node.attribute("source"))
-        {
-            std::string path = node.attribute("source").as_string();
-            return loadWithoutMap(path);
-        }
     }
 
-    m_name = node.attribute("name").as_string();
-    LOG("found tile set " + m_name, Logger::Type::Info);
-    m_class = node.attribute("class").as_string();
+    m_data->name = node.attribute("name").as_string();
+    LOG("found tile set " + m_data->name, Logger::Type::Info);
+    m_data->className = node.attribute("class").as_string();
 
-    m_tileSize.x = node.attribute("tilewidth").as_int();
-    m_tileSize.y = node.attribute("tileheight").as_int();
-    if (m_tileSize.x == 0 || m_tileSize.y == 0)
+    m_data->tileSize.x = node.attribute("tilewidth").as_int();
+    m_data->tileSize.y = node.attribute("tileheight").as_int();
+    if (m_data->tileSize.x == 0 || m_data->tileSize.y == 0)
     {
         Logger::log("Invalid tile size found in tile set node. Node will be skipped.", Logger::Type::Error);
         return reset();
     }
 
-    m_spacing = node.attribute("spacing").as_int();
-    m_margin = node.attribute("margin").as_int();
-    m_tileCount = node.attribute("tilecount").as_int();
-    m_columnCount = node.attribute("columns").as_int();
+    m_data->spacing = node.attribute("spacing").as_int();
+    m_data->margin = node.attribute("margin").as_int();
+    m_data->tileCount = node.attribute("tilecount").as_int();
+    m_data->columnCount = node.attribute("columns").as_int();
 
-    m_tileIndex.reserve(m_tileCount);
-    m_tiles.reserve(m_tileCount);
+    m_data->tileIndex.reserve(m_data->tileCount);
+    m_data->tiles.reserve(m_data->tileCount);
 
     std::string objectAlignment = node.attribute("objectalignment").as_string();
     if (!objectAlignment.empty())
     {
         if (objectAlignment == "unspecified")
         {
-            m_objectAlignment = ObjectAlignment::Unspecified;
+            m_data->objectAlignment = ObjectAlignment::Unspecified;
         }
         else if (objectAlignment == "topleft")
         {
-            m_objectAlignment = ObjectAlignment::TopLeft;
+            m_data->objectAlignment = ObjectAlignment::TopLeft;
         }
         else if (objectAlignment == "top")
         {
-            m_objectAlignment = ObjectAlignment::Top;
+            m_data->objectAlignment = ObjectAlignment::Top;
         }
         else if (objectAlignment == "topright")
         {
-            m_objectAlignment = ObjectAlignment::TopRight;
+            m_data->objectAlignment = ObjectAlignment::TopRight;
         }
         else if (objectAlignment == "left")
         {
-            m_objectAlignment = ObjectAlignment::Left;
+            m_data->objectAlignment = ObjectAlignment::Left;
         }
         else if (objectAlignment == "center")
         {
-            m_objectAlignment = ObjectAlignment::Center;
+            m_data->objectAlignment = ObjectAlignment::Center;
         }
         else if (objectAlignment == "right")
         {
-            m_objectAlignment = ObjectAlignment::Right;
+            m_data->objectAlignment = ObjectAlignment::Right;
         }
         else if (objectAlignment == "bottomleft")
         {
-            m_objectAlignment = ObjectAlignment::BottomLeft;
+            m_data->objectAlignment = ObjectAlignment::BottomLeft;
         }
         else if (objectAlignment == "bottom")
         {
-            m_objectAlignment = ObjectAlignment::Bottom;
+            m_data->objectAlignment = ObjectAlignment::Bottom;
         }
         else if (objectAlignment == "bottomright")
         {
-            m_objectAlignment = ObjectAlignment::BottomRight;
+            m_data->objectAlignment = ObjectAlignment::BottomRight;
         }
     }
 
+    //tiles are created in document order, but with an executor
+    //set the contents of their nodes are parsed afterwards
+    std::vector<std::pair<std::size_t, pugi::xml_node>> tileNodes;
+
     const auto& children = node.children();
     for (const auto& childNode : children)
     {
@@ -197,17 +243,17 @@ bool Tileset::parse(pugi::xml_node node, Map* map)
                 Logger::log("Tileset image node has missing source property, tile set not loaded", Logger::Type::Error);
                 return reset();
             }
-            m_imagePath = resolveFilePath(attribString, m_workingDir);
+            m_data->imagePath = resolveFilePath(attribString, m_workingDir);
             if (childNode.attribute("trans"))
             {
                 attribString = childNode.attribute("trans").as_string();
-                m_transparencyColour = colourFromString(attribString);
-                m_hasTransparency = true;
+                m_data->transparencyColour = colourFromString(attribString);
+                m_data->hasTransparency = true;
             }
             if (childNode.attribute("width") && childNode.attribute("height"))
             {
-                m_imageSize.x = childNode.attribute("width").as_int();
-                m_imageSize.y = childNode.attribute("height").as_int();
+                m_data->imageSize.x = childNode.attribute("width").as_int();
+                m_data->imageSize.y = childNode.attribute("height").as_int();
             }
         }
         else if (name == "tileoffset")
@@ -224,12 +270,25 @@ bool Tileset::parse(pugi::xml_node node, Map* map)
         }
         else if (name == "tile")
         {
-            parseTileNode(childNode, map);
+            if (m_executor)
+            {
+                newTile(childNode.attribute("id").as_int());
+                tileNodes.emplace_back(m_data->tiles.size() - 1, childNode);
+            }
+            else
+            {
+                parseTileNode(childNode, map);
+            }
         }
     }
 
+    if (!tileNodes.empty())
+    {
+        parseTileNodes(tileNodes, map);
+    }
+
     //if the tsx file does not declare every tile, we create the missing ones
-    if (m_tiles.size() != getTileCount())
+    if (m_data->tiles.size() != getTileCount())
     {
         for (std::uint32_t ID = 0; ID < getTileCount(); ID++)
         {
@@ -242,8 +301,8 @@ bool Tileset::parse(pugi::xml_node node, Map* map)
 
 std::uint32_t Tileset::getLastGID() const
 {
-    assert(!m_tileIndex.empty());
-    return m_firstGID + static_cast<std::uint32_t>(m_tileIndex.size()) - 1;
+    assert(!m_data->tileIndex.empty());
+    return m_firstGID + static_cast<std::uint32_t>(m_data->tileIndex.size()) - 1;
 }
 
 const Tileset::Tile* Tileset::getTile(std::uint32_t id) const
@@ -255,38 +314,57 @@ const Tileset::Tile* Tileset::getTile(std::uint32_t id) const
 
     //corrects the ID. Indices and IDs are different.
     id -= m_firstGID;
-    id = m_tileIndex[id];
-    return id ? &m_tiles[id - 1] : nullptr;
+    id = m_data->tileIndex[id];
+    return id ? &m_data->tiles[id - 1] : nullptr;
 }
 
 //private
 bool Tileset::reset()
 {
     m_firstGID = 0;
-    m_source = "";
-    m_name = "";
-    m_class = "";
-    m_tileSize = { 0,0 };
-    m_spacing = 0;
-    m_margin = 0;
-    m_tileCount = 0;
-    m_columnCount = 0;
-    m_objectAlignment = ObjectAlignment::Unspecified;
-    m_tileOffset = { 0,0 };
-    m_properties.clear();
-    m_imagePath = "";
-    m_transparencyColour = { 0, 0, 0, 0 };
-    m_hasTransparency = false;
-    m_terrainTypes.clear();
-    m_tileIndex.clear();
-    m_tiles.clear();
+    m_data = std::make_shared<Data>();
     return false;
 }
 
+bool Tileset::parseDocument(const pugi::xml_node& doc)
+{
+    auto tilesetNode = doc.child("tileset");
+    if (!tilesetNode)
+    {
+        Logger::log("Failed opening tileset: no tileset node found", Logger::Type::Error);
+        return reset();
+    }
+
+    return parse(tilesetNode, nullptr);
+}
+
+bool Tileset::parseReference(std::uint32_t firstGID, const std::string& source, Map* map)
+{
+    assert(map);
+    m_assetProvider = map->getAssetProvider();
+
+    m_firstGID = firstGID;
+    if (m_firstGID == 0)
+    {
+        Logger::log("Invalid first GID in tileset. Tileset node skipped.", Logger::Type::Warning);
+        return false;
+    }
+
+    auto resolvedPath = resolveFilePath(source, m_workingDir);
+    map->addDependency(resolvedPath);
+
+    auto* cache = map->getTilesetCache();
+    if (cache)
+    {
+        return cache->load(resolvedPath, *this);
+    }
+    return loadWithoutMap(source);
+}
+
 void Tileset::parseOffsetNode(const pugi::xml_node& node)
 {
-    m_tileOffset.x = node.attribute("x").as_int();
-    m_tileOffset.y = node.attribute("y").as_int();
+    m_data->tileOffset.x = node.attribute("x").as_int();
+    m_data->tileOffset.y = node.attribute("y").as_int();
 }
 
 void Tileset::parsePropertyNode(const pugi::xml_node& node)
@@ -294,8 +372,8 @@ void Tileset::parsePropertyNode(const pugi::xml_node& node)
     const auto& children = node.children();
     for (const auto& child : children)
     {
-        m_properties.emplace_back();
-        m_properties.back().parse(child);
+        m_data->properties.emplace_back();
+        m_data->properties.back().parse(child);
     }
 }
 
@@ -307,8 +385,8 @@ void Tileset::parseTerrainNode(const pugi::xml_node& node)
         std::string name = child.name();
         if (name == "terrain")
         {
-            m_terrainTypes.emplace_back();
-            auto& terrain = m_terrainTypes.back();
+            m_data->terrainTypes.emplace_back();
+            auto& terrain = m_data->terrainTypes.back();
             terrain.name = child.attribute("name").as_string();
             terrain.tileID = child.attribute("tile").as_int();
             auto properties = child.child("properties");
@@ -330,13 +408,13 @@ void Tileset::parseTerrainNode(const pugi::xml_node& node)
 
 Tileset::Tile& Tileset::newTile(std::uint32_t ID)
 {
-    Tile& tile = (m_tiles.emplace_back(), m_tiles.back());
-    if (m_tileIndex.size() <= ID)
+    Tile& tile = (m_data->tiles.emplace_back(), m_data->tiles.back());
+    if (m_data->tileIndex.size() <= ID)
     {
-        m_tileIndex.resize(ID + 1, 0);
+        m_data->tileIndex.resize(ID + 1, 0);
     }
 
-    m_tileIndex[ID] = static_cast<std::uint32_t>(m_tiles.size());
+    m_data->tileIndex[ID] = static_cast<std::uint32_t>(m_data->tiles.size());
     tile.ID = ID;
     return tile;
 }
@@ -344,6 +422,11 @@ Tileset::Tile& Tileset::newTile(std::uint32_t ID)
 void Tileset::parseTileNode(const pugi::xml_node& node, Map* map)
 {
     Tile& tile = newTile(node.attribute("id").as_int());
+    parseTileData(tile, node, map, m_data->transparencyColour, m_data->hasTransparency);
+}
+
+void Tileset::parseTileData(Tile& tile, const pugi::xml_node& node, Map* map, Colour& transparency, bool& hasTransparency) const
+{
     if (node.attribute("terrain"))
     {
         std::string data = node.attribute("terrain").as_string();
@@ -384,15 +467,15 @@ void Tileset::parseTileNode(const pugi::xml_node& node, Map* map)
     }
 
     //by default we set the tile's values as in an Image tileset
-    tile.imagePath = m_imagePath;
-    tile.imageSize = m_tileSize;
+    tile.imagePath = m_data->imagePath;
+    tile.imageSize = m_data->tileSize;
 
-    if (m_columnCount != 0)
+    if (m_data->columnCount != 0)
     {
-        std::uint32_t rowIndex = tile.ID % m_columnCount;
-        std::uint32_t columnIndex = tile.ID / m_columnCount;
-        tile.imagePosition.x = m_margin + rowIndex * (m_tileSize.x + m_spacing);
-        tile.imagePosition.y = m_margin + columnIndex * (m_tileSize.y + m_spacing);
+        std::uint32_t rowIndex = tile.ID % m_data->columnCount;
+        std::uint32_t columnIndex = tile.ID / m_data->columnCount;
+        tile.imagePosition.x = m_data->margin + rowIndex * (m_data->tileSize.x + m_data->spacing);
+        tile.imagePosition.y = m_data->margin + columnIndex * (m_data->tileSize.y + m_data->spacing);
     }
 
     const auto& children = node.children();
@@ -426,8 +509,8 @@ void Tileset::parseTileNode(const pugi::xml_node& node, Map* map)
             if (child.attribute("trans"))
             {
                 attribString = child.attribute("trans").as_string();
-                m_transparencyColour = colourFromString(attribString);
-                m_hasTransparency = true;
+                transparency = colourFromString(attribString);
+                hasTransparency = true;
             }
             if (child.attribute("width"))
             {
@@ -444,27 +527,69 @@ void Tileset::parseTileNode(const pugi::xml_node& node, Map* map)
             {
                 Tile::Animation::Frame frame;
                 frame.duration = frameNode.attribute("duration").as_int();
-                frame.tileID = frameNode.attribute("tileid").as_int() + m_firstGID;
+                frame.tileID = frameNode.attribute("tileid").as_int();
                 tile.animation.frames.push_back(frame);
             }
         }
     }
 }
 
+void Tileset::parseTileNodes(const std::vector<std::pair<std::size_t, pugi::xml_node>>& tileNodes, Map* map)
+{
+    //each batch keeps its own copy of the transparency colour, which
+    //is applied in document order once they have all finished
+    struct Batch final
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        Colour transparency;
+        bool hasTransparency = false;
+    };
+
+    std::vector<Batch> batches((tileNodes.size() + TileBatchSize - 1) / TileBatchSize);
+
+    //small tile sets aren't worth the overhead of a task
+    TaskGroup tasks(batches.size() > 1 ? m_executor : nullptr);
+    for (auto i = 0u; i < batches.size(); ++i)
+    {
+        auto& batch = batches[i];
+        batch.begin = i * TileBatchSize;
+        batch.end = std::min(batch.begin + TileBatchSize, tileNodes.size());
+
+        tasks.run([this, &batch, &tileNodes, map]()
+        {
+            for (auto j = batch.begin; j < batch.end; ++j)
+            {
+                parseTileData(m_data->tiles[tileNodes[j].first], tileNodes[j].second, map, batch.transparency, batch.hasTransparency);
+            }
+        });
+    }
+    tasks.wait();
+
+    for (const auto& batch : batches)
+    {
+        if (batch.hasTransparency)
+        {
+            m_data->transparencyColour = batch.transparency;
+            m_data->hasTransparency = true;
+        }
+    }
+}
+
 void Tileset::createMissingTile(std::uint32_t ID)
 {
     //first, we check if the tile does not yet exist
-    if (m_tileIndex.size() > ID && m_tileIndex[ID])
+    if (m_data->tileIndex.size() > ID && m_data->tileIndex[ID])
     {
         return;
     }
 
     Tile& tile = newTile(ID);
-    tile.imagePath = m_imagePath;
-    tile.imageSize = m_tileSize;
+    tile.imagePath = m_data->imagePath;
+    tile.imageSize = m_data->tileSize;
 
-    std::uint32_t rowIndex = ID % m_columnCount;
-    std::uint32_t columnIndex = ID / m_columnCount;
-    tile.imagePosition.x = m_margin + rowIndex * (m_tileSize.x + m_spacing);
-    tile.imagePosition.y = m_margin + columnIndex * (m_tileSize.y + m_spacing);
+    std::uint32_t rowIndex = ID % m_data->columnCount;
+    std::uint32_t columnIndex = ID / m_data->columnCount;
+    tile.imagePosition.x = m_data->margin + rowIndex * (m_data->tileSize.x + m_data->spacing);
+    tile.imagePosition.y = m_data->margin + columnIndex * (m_data->tileSize.y + m_data->spacing);
 }
@@ -0,0 +1,90 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include <tmxlite/TilesetCache.hpp>
+
+using namespace tmx;
+
+//public
+bool TilesetCache::load(const std::string& path, Tileset& tileset)
+{
+    std::int64_t modifiedTime = 0;
+    std::int64_t fileSize = 0;
+    auto* provider = tileset.getAssetProvider();
+    bool hasInfo = (provider ? *provider : AssetProvider::getDefault()).getFileInfo(path, modifiedTime, fileSize);
+
+    if (hasInfo)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto result = m_entries.find(path);
+        if (result != m_entries.end()
+            && result->second.modifiedTime == modifiedTime
+            && result->second.fileSize == fileSize)
+        {
+            tileset.m_workingDir = result->second.tileset.m_workingDir;
+            tileset.m_data = result->second.tileset.m_data;
+            return true;
+        }
+    }
+
+    //the file is parsed without holding the lock. Parsing may run tasks on
+    //the executor, which could themselves be waiting to load a tile set
+    //from this cache. The cost is that two threads which miss the cache at
+    //the same time both parse the file, and the last one to finish wins.
+    Tileset loaded("");
+    loaded.setExecutor(tileset.getExecutor());
+    loaded.setAssetProvider(provider);
+    if (!loaded.loadWithoutMap(path))
+    {
+        return tileset.reset();
+    }
+
+    tileset.m_workingDir = loaded.m_workingDir;
+    tileset.m_data = loaded.m_data;
+
+    if (hasInfo)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = m_entries[path];
+        entry.modifiedTime = modifiedTime;
+        entry.fileSize = fileSize;
+        entry.tileset = std::move(loaded);
+    }
+    return true;
+}
+
+void TilesetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+std::size_t TilesetCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,404 @@
+/*********************************************************************
+Matt Marchant (and contributors) 2016 - 2026
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#ifndef USE_EXTLIBS
+#include "miniz.h"
+#else
+#include <zlib.h>
+#endif
+#include <tmxlite/ZipArchiveProvider.hpp>
+#include <tmxlite/FreeFuncs.hpp>
+#include <tmxlite/detail/Log.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using namespace tmx;
+
+namespace
+{
+    const std::uint32_t LocalHeaderSignature = 0x04034b50;
+    const std::uint32_t CentralHeaderSignature = 0x02014b50;
+    const std::uint32_t EndSignature = 0x06054b50;
+    const std::uint32_t Zip64EndSignature = 0x06064b50;
+    const std::uint32_t Zip64LocatorSignature = 0x07064b50;
+
+    const std::size_t LocalHeaderSize = 30;
+    const std::size_t CentralHeaderSize = 46;
+    const std::size_t EndSize = 22;
+    const std::size_t Zip64EndSize = 56;
+    const std::size_t Zip64LocatorSize = 20;
+    const std::size_t MaxCommentSize = 0xffff;
+
+    const std::uint16_t MethodStored = 0;
+    const std::uint16_t MethodDeflated = 8;
+    const std::uint16_t FlagEncrypted = 0x1;
+    const std::uint16_t Zip64ExtraID = 0x0001;
+
+    //all values in a zip archive are little endian
+    std::uint64_t readValue(const char* data, std::size_t byteCount)
+    {
+        std::uint64_t value = 0;
+        for (auto i = 0u; i < byteCount; ++i)
+        {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+        }
+        return value;
+    }
+
+    std::uint16_t read16(const char* data) { return static_cast<std::uint16_t>(readValue(data, 2)); }
+    std::uint32_t read32(const char* data) { return static_cast<std::uint32_t>(readValue(data, 4)); }
+    std::uint64_t read64(const char* data) { return readValue(data, 8); }
+
+    //paths in the archive never start with a slash, nor contain . or ..
+    std::string normalisePath(const std::string& path)
+    {
+        auto retVal = resolveFilePath(path, "");
+        auto start = retVal.find_first_not_of('/');
+        return start == std::string::npos ? std::string() : retVal.substr(start);
+    }
+
+    bool inflateEntry(const char* source, std::uint64_t sourceSize, char* dest, std::uint64_t destSize)
+    {
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = Z_NULL;
+        stream.avail_in = 0;
+
+        //zip entries are raw deflate streams, with no zlib header
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        {
+            Logger::log("inflate init failed", Logger::Type::Error);
+            return false;
+        }
+
+        //the sizes passed to inflate() are only 32 bit, so
+        //large entries are streamed through in blocks
+        const std::uint64_t MaxBlock = std::numeric_limits<unsigned int>::max();
+        std::uint64_t sourceRemaining = sourceSize;
+        std::uint64_t destRemaining = destSize;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(source));
+        stream.next_out = reinterpret_cast<Bytef*>(dest);
+
+        int result = Z_OK;
+        while (result == Z_OK)
+        {
+            if (stream.avail_in == 0)
+            {
+                stream.avail_in = static_cast<unsigned int>(std::min(sourceRemaining, MaxBlock));
+                sourceRemaining -= stream.avail_in;
+            }
+
+            if (stream.avail_out == 0)
+            {
+                stream.avail_out = static_cast<unsigned int>(std::min(destRemaining, MaxBlock));
+                destRemaining -= stream.avail_out;
+            }
+
+            //no progress is only an error if there's nothing left to refill
+            result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_BUF_ERROR
+                && ((stream.avail_in == 0 && sourceRemaining != 0)
+                    || (stream.avail_out == 0 && destRemaining != 0)))
+            {
+                result = Z_OK;
+            }
+        }
+
+        auto written = static_cast<std::uint64_t>(reinterpret_cast<char*>(stream.next_out) - dest);
+        inflateEnd(&stream);
+        return result == Z_STREAM_END && written == destSize;
+    }
+}
+
+//public
+bool ZipArchiveProvider::openArchive(const std::string& path, AssetProvider* provider)
+{
+    closeArchive();
+
+    auto archive = std::make_shared<AssetBuffer>();
+    if (!(provider ? *provider : AssetProvider::getDefault()).open(path, *archive))
+    {
+        Logger::log("Failed to open archive " + path, Logger::Type::Error);
+        return false;
+    }
+
+    m_archive = std::move(archive);
+    if (!readDirectory())
+    {
+        Logger::log("Failed to read the directory of archive " + path, Logger::Type::Error);
+        closeArchive();
+        return false;
+    }
+    return true;
+}
+
+bool ZipArchiveProvider::openArchive(const char* data, std::size_t size)
+{
+    closeArchive();
+
+    m_archive = std::make_shared<AssetBuffer>();
+    m_archive->setBorrowed(data, size);
+    if (!readDirectory())
+    {
+        Logger::log("Failed to read the directory of archive", Logger::Type::Error);
+        closeArchive();
+        return false;
+    }
+    return true;
+}
+
+void ZipArchiveProvider::closeArchive()
+{
+    m_archive.reset();
+    m_entries.clear();
+}
+
+bool ZipArchiveProvider::contains(const std::string& path) const
+{
+    return find(path) != nullptr;
+}
+
+bool ZipArchiveProvider::open(const std::string& path, AssetBuffer& buffer)
+{
+    const auto* entry = find(path);
+    if (!entry)
+    {
+        return false;
+    }
+
+    //the local header is only needed to find the start of the data, as
+    //its name and extra field may differ in length from the central one
+    const char* archive = m_archive->data();
+    const std::uint64_t archiveSize = m_archive->size();
+    if (entry->headerOffset + LocalHeaderSize > archiveSize
+        || read32(archive + entry->headerOffset) != LocalHeaderSignature)
+    {
+        Logger::log("Invalid local header for " + path + " in archive", Logger::Type::Error);
+        return false;
+    }
+
+    const char* header = archive + entry->headerOffset;
+    auto dataOffset = entry->headerOffset + LocalHeaderSize + read16(header + 26) + read16(header + 28);
+    if (dataOffset > archiveSize
+        || entry->compressedSize > archiveSize - dataOffset)
+    {
+        Logger::log("Data for " + path + " extends past the end of the archive", Logger::Type::Error);
+        return false;
+    }
+    const char* data = archive + dataOffset;
+
+    if (entry->method == MethodStored)
+    {
+        if (entry->size > entry->compressedSize)
+        {
+            Logger::log("Invalid size for " + path + " in archive", Logger::Type::Error);
+            return false;
+        }
+        buffer.setBorrowed(data, static_cast<std::size_t>(entry->size), m_archive);
+        return true;
+    }
+
+    if (entry->size > std::numeric_limits<std::size_t>::max())
+    {
+        Logger::log(path + " is too large to extract", Logger::Type::Error);
+        return false;
+    }
+
+    std::string contents(static_cast<std::size_t>(entry->size), '\0');
+    if (!contents.empty()
+        && !inflateEntry(data, entry->compressedSize, &contents[0], entry->size))
+    {
+        Logger::log("Failed to inflate " + path + " from archive", Logger::Type::Error);
+        return false;
+    }
+    buffer.setString(std::move(contents));
+    return true;
+}
+
+bool ZipArchiveProvider::getFileInfo(const std::string& path, std::int64_t& modifiedTime, std::int64_t& fileSize)
+{
+    const auto* entry = find(path);
+    if (!entry)
+    {
+        return false;
+    }
+
+    modifiedTime = entry->crc;
+    fileSize = static_cast<std::int64_t>(entry->size);
+    return true;
+}
+
+//private
+bool ZipArchiveProvider::readDirectory()
+{
+    const char* archive = m_archive->data();
+    const std::uint64_t size = m_archive->size();
+    if (size < EndSize)
+    {
+        return false;
+    }
+
+    //the end of central directory record is followed only by the
+    //archive comment, so search backwards from the end of the file
+    std::uint64_t endOffset = size - EndSize;
+    const std::uint64_t searchEnd = size > EndSize + MaxCommentSize ? size - EndSize - MaxCommentSize : 0;
+    while (read32(archive + endOffset) != EndSignature)
+    {
+        if (endOffset == searchEnd)
+        {
+            return false;
+        }
+        endOffset--;
+    }
+
+    const char* end = archive + endOffset;
+    std::uint64_t entryCount = read16(end + 10);
+    std::uint64_t directorySize = read32(end + 12);
+    std::uint64_t directoryOffset = read32(end + 16);
+
+    //zip64 archives mark the values which don't fit and store
+    //them in a second record, found through a locator
+    if (entryCount == 0xffff || directorySize == 0xffffffff || directoryOffset == 0xffffffff)
+    {
+        if (endOffset < Zip64LocatorSize
+            || read32(end - Zip64LocatorSize) != Zip64LocatorSignature)
+        {
+            return false;
+        }
+
+        auto zip64Offset = read64(end - Zip64LocatorSize + 8);
+        if (size < Zip64EndSize
+            || zip64Offset > size - Zip64EndSize
+            || read32(archive + zip64Offset) != Zip64EndSignature)
+        {
+            return false;
+        }
+
+        const char* zip64End = archive + zip64Offset;
+        entryCount = read64(zip64End + 32);
+        directorySize = read64(zip64End + 40);
+        directoryOffset = read64(zip64End + 48);
+    }
+
+    if (directoryOffset > size
+        || directorySize > size - directoryOffset)
+    {
+        return false;
+    }
+
+    m_entries.reserve(static_cast<std::size_t>(std::min(entryCount, directorySize / CentralHeaderSize)));
+
+    const char* current = archive + directoryOffset;
+    const char* directoryEnd = current + directorySize;
+    for (auto i = 0u; i < entryCount; ++i)
+    {
+        if (static_cast<std::uint64_t>(directoryEnd - current) < CentralHeaderSize
+            || read32(current) != CentralHeaderSignature)
+        {
+            return false;
+        }
+
+        const auto flags = read16(current + 8);
+        const auto nameLength = read16(current + 28);
+        const auto extraLength = read16(current + 30);
+        const auto commentLength = read16(current + 32);
+        const auto headerSize = CentralHeaderSize + nameLength + extraLength + commentLength;
+        if (static_cast<std::uint64_t>(directoryEnd - current) < headerSize)
+        {
+            return false;
+        }
+
+        Entry entry;
+        entry.method = read16(current + 10);
+        entry.crc = read32(current + 16);
+        entry.compressedSize = read32(current + 20);
+        entry.size = read32(current + 24);
+        entry.headerOffset = read32(current + 42);
+
+        //the zip64 extra field holds, in order, only
+        //the values which were too large for the header
+        const char* extra = current + CentralHeaderSize + nameLength;
+        const char* extraEnd = extra + extraLength;
+        while (extraEnd - extra >= 4)
+        {
+            const auto id = read16(extra);
+            const auto length = read16(extra + 2);
+            const char* field = extra + 4;
+            extra = field + length;
+            if (extra > extraEnd)
+            {
+                break;
+            }
+
+            if (id == Zip64ExtraID)
+            {
+                const char* fieldEnd = extra;
+                for (auto* value : { &entry.size, &entry.compressedSize, &entry.headerOffset })
+                {
+                    if (*value == 0xffffffff && fieldEnd - field >= 8)
+                    {
+                        *value = read64(field);
+                        field += 8;
+                    }
+                }
+            }
+        }
+
+        std::string name(current + CentralHeaderSize, nameLength);
+        current += headerSize;
+
+        //directories have no contents of their own
+        if (name.empty() || name.back() == '/')
+        {
+            continue;
+        }
+
+        if (flags & FlagEncrypted)
+        {
+            LOG("Skipping encrypted file " + name + " in archive", Logger::Type::Warning);
+            continue;
+        }
+
+        if (entry.method != MethodStored && entry.method != MethodDeflated)
+        {
+            LOG("Skipping " + name + " in archive: unsupported compression method " + std::to_string(entry.method), Logger::Type::Warning);
+            continue;
+        }
+
+        m_entries[normalisePath(name)] = entry;
+    }
+    return true;
+}
+
+const ZipArchiveProvider::Entry* ZipArchiveProvider::find(const std::string& path) const
+{
+    auto result = m_entries.find(normalisePath(path));
+    return result == m_entries.end() ? nullptr : &result->second;
+}